@@ -156,10 +156,12 @@ namespace Analysis {
   /*-----------------------------------------------
     Helper function for formatting output
     - folds lines after width elements
+    - v may be any sequential collection with size()
+      and integer indexer, e.g., vector or array
     - used only in Point<T,N>::show()
   */
-  template<typename T>
-  std::string fold(std::vector<T>& v, size_t left, size_t width) {
+  template<typename C>
+  std::string fold(const C& v, size_t left, size_t width) {
     std::stringstream out("\n");
     out << indent(left);
     for(size_t i=0; i<v.size(); ++i) {
@@ -169,6 +169,12 @@ int main() {
     // #define TEST
     #ifdef TEST
       testFormats();
+      testStats();
+    #endif
+
+    // #define BENCH
+    #ifdef BENCH
+      benchStats();
     #endif
 
     print("\n  That's all Folks!\n\n");
@@ -2,12 +2,22 @@
   PointsGen.h defines point classe Point<T, N>
   - Point<T, N> represents points with N coordinates of
     unspecified type T and a Time t.
+  - coordinates are held inline by default, or in a heap
+    vector with Point<T, N, HeapCoords>
+  - the timestamp is a full Time by default, a raw epoch count
+    with Point<T, N, S, EpochStamp>, or absent with NoStamp
 */
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
+#include <algorithm>
 #include <initializer_list>
 #include <concepts>
+#include <chrono>
+#include <span>
+#include <cassert>
+#include <cstdint>
 #include "AnalysisGen.h"
 #include "Time.h"
 
@@ -16,14 +26,97 @@ namespace Points {
   //using namespace Analysis;
   
   /*-------------------------------------------------------------------
-    Point<T, N> class represents a point in an N-Dimensional hyperspace.
-    It uses a template parameter to support a variety of coordinate 
-    types, and uses a vector to hold any finite number of 
-    coordinates, specified by N.
+    Coordinate storage modes for Point<T, N, S>
+    - InlineCoords holds the N coordinates in a std::array inside
+      the point, so constructing or copying a point never touches
+      the heap and indexing needs no pointer indirection.
+    - HeapCoords holds them in a std::vector, the original layout.
+    CoordStorage<T, N, S> maps a mode tag S to its container type
+    and makes a zero-filled container with N elements.
+  */
+  struct InlineCoords {};
+  struct HeapCoords {};
+
+  template<typename T, size_t N, typename S>
+  struct CoordStorage;
+
+  template<typename T, size_t N>
+  struct CoordStorage<T, N, InlineCoords> {
+    using type = std::array<T, N>;
+    static type make() { return type{}; }
+  };
+  template<typename T, size_t N>
+  struct CoordStorage<T, N, HeapCoords> {
+    using type = std::vector<T>;
+    static type make() { return type(N, T{0}); }  // one allocation
+  };
+
+  /*-------------------------------------------------------------------
+    Timestamp policies for Point<T, N, S, P>
+    - TimeStamp holds a full Time. Construction reads the clock
+      once, the calendar breakdown waits until it is asked for.
+    - EpochStamp holds nanoseconds since the system_clock epoch in
+      an int64_t. Construction leaves it zero, meaning unstamped,
+      and stampAll sets a whole batch from a single clock read.
+    - NoStamp holds nothing, so a point is just its coordinates.
+    StampStorage<P> maps a policy tag P to its stored type and
+    converts between that type and a system_clock time_point.
+  */
+  struct TimeStamp {};
+  struct EpochStamp {};
+  struct NoStamp {};
 
-    It also carries a Time t instance which conceptually is the time
-    at which something was at that point in space. Time is a class
-    defined for this demonstration in Time.h.
+  template<typename P>
+  struct StampStorage;
+
+  template<>
+  struct StampStorage<TimeStamp> {
+    using type = Time;
+    static type make() { return Time(); }
+    static void set(type& s, std::chrono::time_point<std::chrono::system_clock> tp) {
+      s = Time(tp);
+    }
+    static std::chrono::time_point<std::chrono::system_clock> get(const type& s) {
+      return s.timePoint();
+    }
+  };
+  template<>
+  struct StampStorage<EpochStamp> {
+    using type = std::int64_t;
+    static type make() { return 0; }
+    static void set(type& s, std::chrono::time_point<std::chrono::system_clock> tp) {
+      s = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        tp.time_since_epoch()
+      ).count();
+    }
+    static std::chrono::time_point<std::chrono::system_clock> get(const type& s) {
+      return std::chrono::time_point<std::chrono::system_clock>(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds(s)
+        )
+      );
+    }
+  };
+  template<>
+  struct StampStorage<NoStamp> {
+    struct type {};
+    static type make() { return type{}; }
+    static void set(type&, std::chrono::time_point<std::chrono::system_clock>) {}
+    static std::chrono::time_point<std::chrono::system_clock> get(const type&) {
+      return std::chrono::time_point<std::chrono::system_clock>{};
+    }
+  };
+
+  /*-------------------------------------------------------------------
+    Point<T, N, S> class represents a point in an N-Dimensional 
+    hyperspace. It uses a template parameter to support a variety of 
+    coordinate types, and holds N coordinates, specified at compile
+    time, in storage selected by mode S, InlineCoords by default.
+
+    It also carries a timestamp which conceptually is the time at
+    which something was at that point in space. Policy P selects how
+    it is held, a Time by default. Time is a class defined for this
+    demonstration in Time.h.
 
     All its special members, ctors, assignment, ... with the exception 
     of constructor Point(), are declared default to indicate to a maintainer 
@@ -32,9 +125,15 @@ namespace Points {
     It does not provide an iterator nor begin() and end() members.
     Those will added in the iteration bit.
   */
-  template<typename T, const size_t N>
+  template<
+    typename T, const size_t N,
+    typename S = InlineCoords, typename P = TimeStamp
+  >
   class Point {
   public:
+    using coord_type = typename CoordStorage<T, N, S>::type;
+    using stamp_type = typename StampStorage<P>::type;
+
     Point();                                      // default ctor
     Point(std::initializer_list<T> il);           // construct from list
     Point(const Point& pt) = default;             // copy ctor
@@ -47,89 +146,109 @@ namespace Points {
 
     std::string timeToString();
     void updateTime();
-    Time& time();
+    void stamp(std::chrono::time_point<std::chrono::system_clock> tp);
+    std::chrono::time_point<std::chrono::system_clock> timePoint() const;
+    Time& time() requires std::same_as<P, TimeStamp>;
     const size_t size() const;
-    T& operator[](size_t index);                  // index oper
-    const T operator[](size_t index) const;       // const index oper
+    T& at(size_t index);                          // checked index
+    const T& at(size_t index) const;
+    T& operator[](size_t index);                  // unchecked index oper
+    const T& operator[](size_t index) const;      // const index oper
+
+    std::span<T, N> span();                       // view of coordinates
+    std::span<const T, N> span() const;
     
-    std::vector<T>& coords() { return coord; }    // accessor
+    coord_type& coords() { return coord; }        // accessor
 
     void show(const std::string& name);           // display contents
     size_t& left() { return _left; }              // display indent
     size_t& width() { return _width; }            // display width
   private:
-    std::vector<T> coord;
-    Time tm;
+    coord_type coord;
+    [[no_unique_address]] stamp_type tm;
     size_t _left = 2;   // default display indent
     size_t _width = 7;  // default display row width
   };
   /*-----------------------------------------------
-    Point<T, N> constructor with size Template
+    Point<T, N, S, P> constructor with size Template
     parameter
+    - coordinates are zero-filled by CoordStorage
+    - timestamp is made by StampStorage
   */
-  template<typename T, size_t N>
-  Point<T, N>::Point() 
-    : tm(Time()) {
-    for(size_t i=0; i<N; i++) {
-      coord.push_back(T{0});
-    }
-  }
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point() 
+    : coord(CoordStorage<T, N, S>::make()), tm(StampStorage<P>::make()) {}
   /*-----------------------------------------------
     Fill coor with elements from initializer list li
     - if li is smaller than N then fill remainder with 
       default values of T
     - if li is larger use first N elements of li
   */
-  template<typename T, size_t N>
-  Point<T, N>::Point(std::initializer_list<T> il) 
-    : tm(Time()) {
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point(std::initializer_list<T> il) 
+    : coord(CoordStorage<T, N, S>::make()), tm(StampStorage<P>::make()) {
     size_t sz = std::min(N, il.size());
-    size_t i = 0;
-    for(auto item : il) {
-      coord.push_back(item);
-      if(++i == sz) {
-        break;
-      }
-    }
-    for(size_t i = il.size(); i<N; i++) {
-      coord.push_back(T{0});
-    }
+    std::copy_n(il.begin(), sz, coord.begin());
   }
   /*---------------------------------------------
     Always returns N
   */
-  template<typename T, size_t N>
-  const size_t Point<T, N>::size() const {
+  template<typename T, size_t N, typename S, typename P>
+  const size_t Point<T, N, S, P>::size() const {
     return coord.size();
   }
   /*---------------------------------------------
-    index returns mutable value
+    at() checks index and throws if out of range
   */
-  template<typename T, size_t N>
-  T& Point<T, N>::operator[](size_t index) {
-    if (index < 0 || coord.size() <= index) {
+  template<typename T, size_t N, typename S, typename P>
+  T& Point<T, N, S, P>::at(size_t index) {
+    if (N <= index) {
       throw "Point<T, N> indexing error";
     }
     return coord[index];
   }
-  /*---------------------------------------------
-    index returns immutable value
-  */
-  template<typename T, size_t N>
-  const T Point<T, N>::operator[](size_t index) const {
-    if (index < 0 || coord.len() <= index) {
+  template<typename T, size_t N, typename S, typename P>
+  const T& Point<T, N, S, P>::at(size_t index) const {
+    if (N <= index) {
       throw "Point<T, N> indexing error";
     }
     return coord[index];
   }
+  /*---------------------------------------------
+    operator[] does not check, as for std::array,
+    so hot loops pay nothing per access
+    - debug builds assert on the index
+  */
+  template<typename T, size_t N, typename S, typename P>
+  T& Point<T, N, S, P>::operator[](size_t index) {
+    assert(index < N);
+    return coord[index];
+  }
+  template<typename T, size_t N, typename S, typename P>
+  const T& Point<T, N, S, P>::operator[](size_t index) const {
+    assert(index < N);
+    return coord[index];
+  }
+  /*---------------------------------------------
+    Fixed extent view of the N coordinates, which
+    are contiguous in every storage mode
+  */
+  template<typename T, size_t N, typename S, typename P>
+  std::span<T, N> Point<T, N, S, P>::span() {
+    return std::span<T, N>(coord.data(), N);
+  }
+  template<typename T, size_t N, typename S, typename P>
+  std::span<const T, N> Point<T, N, S, P>::span() const {
+    return std::span<const T, N>(coord.data(), N);
+  }
   /*-----------------------------------------------
     Fill coor with elements from vector v
     - if v is smaller fill remainder with default
       values of T
     - if v is larger use first N elements of v
   */
-  template<typename T, size_t N>
-  void Point<T, N>::init(const std::vector<T>& v) {
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::init(const std::vector<T>& v) {
     size_t sz = std::min(N, v.size());
     for(size_t i=0; i<sz; i++) {
       coord[i] = v[i];
@@ -141,49 +260,85 @@ namespace Points {
   /*---------------------------------------------
     returns string datetime
   */
-  template<typename T, size_t N>
-  std::string Point<T, N>::timeToString() {
-    std::string ts = tm.toString();
-    return ts;
+  template<typename T, size_t N, typename S, typename P>
+  std::string Point<T, N, S, P>::timeToString() {
+    if constexpr(std::same_as<P, TimeStamp>) {
+      return tm.toString();
+    }
+    else if constexpr(std::same_as<P, EpochStamp>) {
+      return Time(timePoint()).toString();
+    }
+    else {
+      return "no timestamp";
+    }
   }
   /*---------------------------------------------
     set time to current time
   */
-  template<typename T, size_t N>
-  void Point<T, N>::updateTime() {
-    tm = std::time(0);
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::updateTime() {
+    StampStorage<P>::set(tm, std::chrono::system_clock::now());
   }
   /*---------------------------------------------
-    returns current number of seconds in clock's 
-    epoch
+    set time to tp, e.g., one clock read shared
+    by a batch of points
   */
-  template<typename T, size_t N>
-  Time& Point<T, N>::time() {
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::stamp(
+    std::chrono::time_point<std::chrono::system_clock> tp
+  ) {
+    StampStorage<P>::set(tm, tp);
+  }
+  template<typename T, size_t N, typename S, typename P>
+  std::chrono::time_point<std::chrono::system_clock> 
+  Point<T, N, S, P>::timePoint() const {
+    return StampStorage<P>::get(tm);
+  }
+  /*---------------------------------------------
+    returns Time instance, only for TimeStamp
+    policy
+  */
+  template<typename T, size_t N, typename S, typename P>
+  Time& Point<T, N, S, P>::time() requires std::same_as<P, TimeStamp> {
     return tm;
   }
   /*-----------------------------------------------
     PointtN<T> display function 
   */
-  template<typename T, size_t N>
-  void Point<T, N>::show(const std::string& name) {
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::show(const std::string& name) {
     std::cout << "\n" << indent(_left) << name << ": " << "Point<T, N>";
     std::cout << " {\n";
     std::cout << fold(coord, _left + 2, _width);
     std::cout << indent(_left) << "}";
-    std::cout << "\n" << indent(_left) << tm.toString() << std::endl;
+    std::cout << "\n" << indent(_left) << timeToString() << std::endl;
   }
   /*-----------------------------------------------
     Overload operator<< required for 
     showType(Point<T, N> t, const std::string& nm) 
   */
-  template<typename T, size_t N>
-  std::ostream& operator<<(std::ostream& out, Point<T, N>& t2) {
+  template<typename T, size_t N, typename S, typename P>
+  std::ostream& operator<<(std::ostream& out, Point<T, N, S, P>& t2) {
     out << "\n" << indent(t2.left()) << "Point<T, N>";
     out << " {\n";
     out << fold(t2.coords(), t2.left() + 2, t2.width());
     out << indent(t2.left()) << "}";
     return out;
   }
+  /*-----------------------------------------------
+    Stamp every point in pts with one clock read
+    - pts is any range of Point<T, N, S, P>
+  */
+  template<typename R>
+  void stampAll(
+    R& pts,
+    std::chrono::time_point<std::chrono::system_clock> tp 
+      = std::chrono::system_clock::now()
+  ) {
+    for(auto& pt : pts) {
+      pt.stamp(tp);
+    }
+  }
 }
 /*-- demonstrate use of Point type --*/
 
@@ -3,6 +3,8 @@
   - Stats<T> holds a std::vector<T> and provides methods for
     computing max, min, average of this collection
     of unspecified type T
+  - summary() computes all of them in one pass; the single value
+    methods each make that pass over the current contents
   - Code builds as a template definition
   - Will fail to build instantiation if T is not a numeric type
 */
@@ -10,6 +12,9 @@
 #include <vector>
 #include <exception>
 #include <concepts>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
 #include "AnalysisGen.h"
 using namespace Analysis;
 
@@ -23,6 +28,19 @@ using namespace Analysis;
 template <typename T>
   concept Number = std::integral<T> || std::floating_point<T>;
 
+/*-------------------------------------------------------------------
+  Summary<T> holds the results of one pass over a Stats<T> vector
+*/
+template <typename T>
+  requires Number<T>
+struct Summary {
+    size_t count;
+    T min;
+    T max;
+    T sum;
+    double mean;
+};
+
 template <typename T>
   requires Number<T>
 class Stats {
@@ -36,6 +54,7 @@ public:
     T min();
     T sum();
     double avg();
+    Summary<T> summary();
     void show(const std::string& name="");
 private:
     bool check();
@@ -68,21 +87,56 @@ size_t Stats<T>::size() {
     return items.size();
 }
 /*-------------------------------------------------------------------
-  returns largest value (not necessarily largerst magnitude)
+  computes count, min, max, sum, and mean in one pass
+  - lanes keep independent minimums, maximums, and sums, so the
+    loop body has no branches and compiles to vector instructions
+  - floating point sums are added in a different order than a
+    simple loop, so may differ in the last bits
+  - reads the vector as it is now; callers wanting several values
+    keep the returned Summary instead of calling each accessor
 */
 template<typename T>
   requires Number<T>
-T Stats<T>::max() {
+Summary<T> Stats<T>::summary() {
     if(!check()) {
         throw "Stats is empty";
     }
-    auto max = items[0];
-    for( auto item : items) {
-        if (item > max) {
-            max = item;
+    constexpr size_t lanes = 8;
+    const T* data = items.data();
+    const size_t n = items.size();
+    T lo[lanes], hi[lanes], acc[lanes];
+    for(size_t j = 0; j < lanes; ++j) {
+        lo[j] = hi[j] = data[0];
+        acc[j] = T{0};
+    }
+    size_t i = 0;
+    for(; i + lanes <= n; i += lanes) {
+        for(size_t j = 0; j < lanes; ++j) {
+            T item = data[i + j];
+            lo[j] = item < lo[j] ? item : lo[j];
+            hi[j] = item > hi[j] ? item : hi[j];
+            acc[j] += item;
         }
     }
-    return max;
+    for(; i < n; ++i) {
+        lo[0] = data[i] < lo[0] ? data[i] : lo[0];
+        hi[0] = data[i] > hi[0] ? data[i] : hi[0];
+        acc[0] += data[i];
+    }
+    for(size_t j = 1; j < lanes; ++j) {
+        lo[0] = lo[j] < lo[0] ? lo[j] : lo[0];
+        hi[0] = hi[j] > hi[0] ? hi[j] : hi[0];
+        acc[0] += acc[j];
+    }
+    return { n, lo[0], hi[0], acc[0], double(acc[0])/double(n) };
+}
+/*-------------------------------------------------------------------
+  returns largest value (not necessarily largerst magnitude)
+*/
+template<typename T>
+  requires Number<T>
+T Stats<T>::max() {
+    return summary().max;
 }
 /*-------------------------------------------------------------------
   returns smallest value (not necessarily smallest magnitude)
@@ -90,16 +144,7 @@ T Stats<T>::max() {
 template<typename T>
   requires Number<T>
 T Stats<T>::min() {
-    if(!check()) {
-        throw "Stats is empty";
-    }
-    auto min = items[0];
-    for( auto item : items) {
-        if (item < min) {
-            min = item;
-        }
-    }
-    return min;
+    return summary().min;
 }
 /*-------------------------------------------------------------------
   returns sum of data values
@@ -107,14 +152,7 @@ T Stats<T>::min() {
 template<typename T>
   requires Number<T>
 T Stats<T>::sum() {
-    if(!check()) {
-        throw "Stats is empty";
-    }
-    auto sum = T{0};
-    for( auto item : items) {
-        sum += item;
-    }
-    return sum;
+    return summary().sum;
 }
 /*-------------------------------------------------------------------
   returns average of data values
@@ -122,14 +160,7 @@ T Stats<T>::sum() {
 template<typename T>
   requires Number<T>
 double Stats<T>::avg() {
-    if(!check()) {
-        throw "Stats is empty";
-    }
-    auto sum = T{0};
-    for( auto item : items) {
-        sum += item;
-    }
-    return double(sum)/double(items.size());
+    return summary().mean;
 }
 /*-------------------------------------------------------------------
   displays current contents
@@ -180,6 +211,14 @@ void demo_custom_type_Stats() {
   std::cout << ", sum: " << s3.sum();
   std::cout << ", avg: " << s3.avg() << std::endl;
 
+  showOp("s.summary(), one pass", nl);
+  Summary<double> sm = s.summary();
+  std::cout << "  count: " << sm.count;
+  std::cout << ", min: " << sm.min;
+  std::cout << ", max: " << sm.max;
+  std::cout << ", sum: " << sm.sum;
+  std::cout << ", mean: " << sm.mean << std::endl;
+
   /*--------------------------------------------------
     This works without the Number concept, with the
     exception of average. With concept the stats
@@ -203,3 +242,87 @@ void demo_custom_type_Stats() {
 
   println();
 }
+/*-- testStats checks that results follow changes to the vector --*/
+bool testStats() {
+
+  println();
+  showNote("Test Stats<T> after vector changes", 40);
+
+  std::vector<int> v { 1, 2, 3 };
+  Stats<int> s(v);
+  bool ok = s.max() == 3 && s.sum() == 6;
+
+  v[0] = 100;                       // changed in place
+  ok = ok && s.max() == 100 && s.min() == 2 && s.sum() == 105 && s.avg() == 35.0;
+
+  v.clear();                        // refilled to the same size
+  v.insert(v.end(), { 4, 5, 6 });
+  ok = ok && s.max() == 6 && s.min() == 4 && s.sum() == 15;
+
+  v.push_back(-7);                  // grown
+  Summary<int> sm = s.summary();
+  ok = ok && sm.count == 4 && sm.min == -7 && sm.max == 6 && sm.sum == 8 && sm.mean == 2.0;
+
+  v.clear();
+  bool threw = false;
+  try {
+    s.max();
+  }
+  catch(const char*) {
+    threw = true;
+  }
+  ok = ok && threw;
+
+  std::cout << "  Stats results follow vector changes: " << (ok ? "passed" : "FAILED") << std::endl;
+  return ok;
+}
+/*-- compare four separate passes with one summary() pass --*/
+template<typename T>
+  requires Number<T>
+void benchStatsType(const std::string& name, size_t count, int reps) {
+  using clock = std::chrono::high_resolution_clock;
+
+  std::vector<T> v(count);
+  for(size_t i = 0; i < count; ++i) {
+    v[i] = T((i * 2654435761u) % 100);     // int sums stay in range
+  }
+  const double gb = double(count * sizeof(T)) / 1e9;
+  auto ms = [](auto start) {
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  };
+  double check = 0.0;
+
+  /* what max(), min(), sum(), and avg() each did: a full pass apiece */
+  auto start = clock::now();
+  for(int r = 0; r < reps; ++r) {
+    T mx = *std::max_element(v.begin(), v.end());
+    T mn = *std::min_element(v.begin(), v.end());
+    T sm = std::accumulate(v.begin(), v.end(), T{0});
+    double avg = double(std::accumulate(v.begin(), v.end(), T{0}))/double(v.size());
+    check += double(mx) + double(mn) + double(sm) + avg;
+  }
+  double four = ms(start) / reps;
+
+  start = clock::now();
+  for(int r = 0; r < reps; ++r) {
+    Stats<T> st(v);
+    Summary<T> sm = st.summary();
+    check += double(sm.max) + double(sm.min) + double(sm.sum) + sm.mean;
+  }
+  double one = ms(start) / reps;
+
+  std::cout << "\n  " << name << ", " << count << " items, " << 1000.0 * gb << " MB";
+  std::cout << "\n    four passes:     " << four << " ms, " << 4000.0 * gb << " MB read, "
+            << 4000.0 * gb / four << " GB/s";
+  std::cout << "\n    summary(), one:  " << one << " ms, " << 1000.0 * gb << " MB read, "
+            << 1000.0 * gb / one << " GB/s";
+  std::cout << "\n    speedup " << four / one << "  (check " << check << ")";
+}
+void benchStats() {
+  println();
+  showNote("benchmark Stats<T>: four passes vs summary()", 50);
+  benchStatsType<double>("Stats<double>", 1 << 16, 200);
+  benchStatsType<double>("Stats<double>", 1 << 24, 5);
+  benchStatsType<int>("Stats<int>", 1 << 24, 5);
+  println();
+}
@@ -19,7 +19,9 @@ namespace Points {
   class Time {
     public:
       Time();
+      explicit Time(std::chrono::time_point<std::chrono::system_clock> stamp);
       time_t getTime();
+      std::chrono::time_point<std::chrono::system_clock> timePoint() const;
       tm getLocalTime();
       tm getGMTTime();
       std::string getTimeZone();
@@ -34,6 +36,8 @@ namespace Points {
       std::chrono::time_point<std::chrono::system_clock> tp;
       std::tm calTime;
       std::string dateTimeSuffix;
+      bool hasCalTime = false;  // calTime filled on first use
+      void ensureCalTime();
   };
   /*-----------------------------------------------
     Construct instance holding time_point for
@@ -43,11 +47,19 @@ namespace Points {
       system_clock, high_resolution_clock
     - time_point is a structure holding chrono::duration
       for the clock's epoch
+    - the local calendar breakdown is deferred until a
+      component or string is first requested, so making
+      a Time costs one clock read
   */
-  Time::Time() {
+  Time::Time() : calTime{} {
     tp = std::chrono::system_clock::now();
-    calTime = getLocalTime();
   }
+  /*-----------------------------------------------
+    Construct instance for an existing time_point,
+    e.g., one clock read shared by a batch of points
+  */
+  Time::Time(std::chrono::time_point<std::chrono::system_clock> stamp)
+    : tp(stamp), calTime{} {}
   /*-----------------------------------------------
     time_t is an integral type holding number of
     seconds in the current time_point
@@ -55,11 +67,18 @@ namespace Points {
   std::time_t Time::getTime() {
     return std::chrono::system_clock::to_time_t(tp); 
   }
+  /*-----------------------------------------------
+    time_point held by this instance
+  */
+  std::chrono::time_point<std::chrono::system_clock> Time::timePoint() const {
+    return tp;
+  }
   /*-----------------------------------------------
     returns datetime string
     - Wed Feb 21 10:18:12 2024 local_time_zone
   */
   std::string Time::toString() {
+    ensureCalTime();
     struct tm time;
     time_t tt = getTime();
     /* compute for GMT zone */
@@ -85,6 +104,7 @@ namespace Points {
     time_t tt = getTime();
     localtime_s(&calTime, &tt);  // save in calTime
     dateTimeSuffix = "local time zone";
+    hasCalTime = true;
     return calTime;
   }
   /*-----------------------------------------------
@@ -97,35 +117,52 @@ namespace Points {
     time_t tt = getTime();
     gmtime_s(&calTime, &tt);  // save in calTime
     dateTimeSuffix = "GMT";
+    hasCalTime = true;
     return calTime;
   }
+  /*-----------------------------------------------
+    compute local calendar time if neither
+    getLocalTime nor getGMTTime has been called
+  */
+  void Time::ensureCalTime() {
+    if(!hasCalTime) {
+      getLocalTime();
+    }
+  }
   /*---------------------------------------------
     methods to retrieve dateTime components
   */
   std::string Time::getTimeZone() {
+    ensureCalTime();
     return dateTimeSuffix;
   }
   size_t Time::year() {
+    ensureCalTime();
     auto yr = calTime.tm_year + 1900;
     return yr;
   }
   size_t Time::month() {
+    ensureCalTime();
     auto mn = calTime.tm_mon + 1;
     return mn;
   }
   size_t Time::day() {
+    ensureCalTime();
     auto d = calTime.tm_mday;
     return d;
   }
   size_t Time::hour() {
+    ensureCalTime();
     auto hr = calTime.tm_hour;
     return hr;
   }
   size_t Time::minutes() {
+    ensureCalTime();
     auto min = calTime.tm_min;
     return min;
   }
   size_t Time::seconds() {
+    ensureCalTime();
     double sec = calTime.tm_sec;
     return sec;
   }
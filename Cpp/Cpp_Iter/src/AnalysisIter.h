@@ -31,8 +31,8 @@ namespace Analysis {
   void println(const std::string& txt = "");
   std::string truncate(size_t N, const char* pStr);
   std::string indent(size_t n);
-  template<typename T>
-  std::string fold(std::vector<T>& v, size_t left, size_t width);
+  template<typename C>
+  std::string fold(const C& v, size_t left, size_t width);
   template<typename T>
   std::string formatColl(
     const T& t, const std::string& nm,
@@ -135,9 +135,11 @@ namespace Analysis {
   /*-----------------------------------------------
     Helper function for formatting output
     - folds lines after width elements
+    - v may be any sequential collection with size()
+      and integer indexer, e.g., vector or array
   */
-  template<typename T>
-  std::string fold(std::vector<T>& v, size_t left, size_t width) {
+  template<typename C>
+  std::string fold(const C& v, size_t left, size_t width) {
     std::stringstream out("\n");
     out << indent(left);
     for(size_t i=0; i<v.size(); ++i) {
@@ -16,8 +16,24 @@
 #include <set>              // set<T> class
 #include <concepts>         // supports C++20 concepts
 #include <algorithm>        // STL algorithms
+#include <numeric>          // std::iota
 #include "AnalysisIter.h"   // Analysis functions
 #include "PointsIter.h"     // PointN<T> class declaration
+#include "PointCloud.h"     // PointCloud<T, N> columnar container
+#include "PointsSimd.h"     // vectorized Point<T, N> arithmetic
+#include "PointsExpr.h"     // fused Point<T, N> arithmetic operators
+#include "PointsConstexpr.h"  // StaticPoint<T, N> and compile-time tables
+#include "Distance.h"       // DistanceEngine<T, N> pairwise distances
+#include "KdTree.h"         // KdTree<T, N> spatial index
+#include "SpatialHash.h"    // SpatialHash<T> uniform grid index
+#include "SpaceCurve.h"     // Morton and Hilbert point ordering
+#include "TimeIndex.h"      // TimeIndex<T, N> temporal index
+#include "PointFile.h"      // binary point files and mapped views
+#include "PointParse.h"     // multi-threaded text ingestion
+#include "PointsPmr.h"      // arena and pool allocation for points
+#include "Parallel.h"       // parallel forEachOp and transform-reduce
+#include "Bounds.h"         // bounding box, centroid, and sphere reductions
+#include "PointsQuant.h"    // QuantizedCloud<Q, N> fixed-point storage
 
 using namespace Points;
 /*-----------------------------------------------
@@ -138,11 +154,13 @@ void executeForLoopVec() {
 /*-----------------------------------------------
   forLoopPoint 
   - accepts Point<T, N> instances by constant reference.
+  - also accepts PointCloud rows, PointRef<T, N>
   - uses range-for to display Point coordinates
   - creates comma separated list
 */
-template<typename T, const size_t N>
-void forLoopPoint(const Point<T, N>& p) {
+template<typename P>
+  requires PointLike<P>
+void forLoopPoint(const P& p) {
   auto s = std::stringstream();
   s << "\n  ";
   for(auto const &item : p) {
@@ -163,11 +181,13 @@ void executeForLoopPoint() {
 /*-----------------------------------------------
   whilerPoint 
   - accepts Point<T, N> instances by constant reference.
+  - also accepts PointCloud rows, PointRef<T, N>
   - explicit use of iterator to display PointN coordinates
   - creates comma separated list
 */
-template<typename T, const size_t N>
-void whilerPoint(const Point<T, N>& p) {
+template<typename P>
+  requires PointLike<P>
+void whilerPoint(const P& p) {
   auto itr = p.begin();
   std::cout << "\n  " << *itr++;
   while (itr < p.end()) {
@@ -211,6 +231,52 @@ void executeDemoWhiler() {
   auto p = Point<double, 5> { 1.0, 2.0, 3.0, 2.0, 1.0 };
   demoWhiler(p);
 }
+/*-----------------------------------------------
+  executePointCloud
+  - PointCloud<T, N> stores points as columns
+  - its rows are PointRef proxies that the Point
+    templates above accept
+*/
+void executePointCloud() {
+  std::cout << "\nexecute forLoopPoint(p) with PointCloud rows";
+  auto pc = PointCloud<double, 3>();
+  pc.push_back({ 1.0, 2.0, 3.0 });
+  pc.push_back({ 1.5, 2.5, 3.5 });
+  pc.push_back(Point<double, 3> { -1.0, -2.0, -3.0 });
+  for(auto p : pc) {
+    forLoopPoint(p);
+  }
+  std::cout << "\nexecute whilerPoint(p) with PointCloud row";
+  pc[1][0] = 42.0;  /* proxy writes through to column */
+  whilerPoint(pc[1]);
+  std::cout << "\nexecute demoWhiler(c) with PointCloud";
+  demoWhiler(pc);
+  std::cout << "\nexecute demoWhiler(c) with PointCloud column 0";
+  demoWhiler(pc.column(0));
+}
+/*-----------------------------------------------
+  executePointFile
+  - PointFileView<T, N> maps a binary point file
+  - its rows are std::span<const T, N> views into
+    the mapping, which the Point templates accept
+*/
+void executePointFile() {
+  std::cout << "\nexecute forLoopPoint(p) with PointFileView rows";
+  std::vector<Point<double, 3>> pts {
+    { 1.0, 2.0, 3.0 }, { 1.5, 2.5, 3.5 }
+  };
+  auto path = (std::filesystem::temp_directory_path() / "bits_iter_points.bin").string();
+  writePointFile(path, pts);
+  {
+    PointFileView<double, 3> view(path);
+    for(auto p : view) {
+      forLoopPoint(p);
+    }
+    std::cout << "\nexecute whilerPoint(p) with PointFileView row";
+    whilerPoint(view[1]);
+  }
+  std::filesystem::remove(path);
+}
 /*-----------------------------------------------
   whiler_guarded is flexible function that accepts 
   any container
@@ -361,6 +427,35 @@ void executeForEachAlgorithm() {
   std::cout << "\nsum = " << sumer(0) << " - using supplied lambda";
   std::cout << "\nsum = " << result(0) << " - using returned lambda";
 }
+/*-----------------------------------------------
+  executeParallelForEachOp()
+  - same operations on the work-stealing pool
+  - sumer's static accumulator would race across
+    threads, so the sum is a transform-reduce
+*/
+void executeParallelForEachOp() {
+  auto v = std::vector<int>(100000);
+  std::iota(v.begin(), v.end(), 1);
+  auto plus_one_mod = [](int& item) {
+    item += 1;
+  };
+  parallelForEachOp(v, plus_one_mod, 4096);
+  std::cout << "\nparallelForEachOp(v, plus_one_mod) on " << v.size() << " items:";
+  showCSL(std::vector<int>(v.begin(), v.begin() + 5));
+
+  auto sum = parallelTransformReduce(
+    v, 0LL, std::plus<long long>(), [](int item) { return (long long)item; }, 4096
+  );
+  std::cout << "\nsum = " << sum << " - using parallelTransformReduce";
+
+  auto p = Point<int, 5> { 1, 2, 3, 4, 5 };
+  parallelForEachOp(p, plus_one_mod);
+  std::cout << "\nmodified point";
+  showCSL(p);
+  std::cout << "\nsum = " << parallelTransformReduce(
+    p, 0, std::plus<int>(), [](int item) { return item; }
+  ) << " - point runs inline, below grain size\n";
+}
 /*-------------------------------------------------------------------
   Demonstration starts here 
 */
@@ -384,6 +479,8 @@ int main() {
 
     showOp("accepts any iterable collection", nl);
     executeDemoWhiler();
+    executePointCloud();
+    executePointFile();
     print();
 
     showOp("detects non-iterable input at compile-time", nl);
@@ -397,13 +494,51 @@ int main() {
     showOp("using std::for_each algorithm to modify items", nl);
     executeForEachAlgorithm();
 
+    showOp("using parallelForEachOp on work-stealing pool", nl);
+    executeParallelForEachOp();
+
     demo_custom_type_Point_iteration();
+    demo_Point_arithmetic();
+    demo_PointExpr();
+    demo_StaticPoint();
+    demo_DistanceEngine();
+    demo_KdTree();
+    demo_SpatialHash();
+    demo_SpaceCurve();
+    demo_TimeIndex();
+    demo_PointFile();
+    demo_PointParse();
+    demo_PointPmr();
+    demo_Bounds();
+    demo_QuantizedCloud();
     
     // #define TEST
     #ifdef TEST
     testFormat();
     #endif
 
+    // #define BENCH
+    #ifdef BENCH
+    benchPointStorage();
+    benchPointStamp();
+    benchPointIndexing();
+    benchPointCloud();
+    benchPointArithmetic();
+    benchPointExpr();
+    benchStaticPoint();
+    benchDistanceEngine();
+    benchKdTree();
+    benchSpatialHash();
+    benchSpaceCurve();
+    benchTimeIndex();
+    benchPointFile();
+    benchPointParse();
+    benchPointPmr();
+    benchParallel();
+    benchBounds();
+    benchQuantized();
+    #endif
+
     print("\n  That's all Folks!\n\n");
 }
 /*-----------------------------------------------
@@ -0,0 +1,363 @@
+/*-------------------------------------------------------------------
+  Bounds.h defines bounding box, centroid, and bounding sphere
+  reductions over large point sets
+  - bounds() finds min and max per dimension and the mean in a
+    single pass, boundingSphere() adds one pass for the radius
+  - both accept std::vector<Point<T, N, S, P>>, array of structs,
+    and PointCloud<T, N>, columnar
+  - rows are split into chunks run on the work-stealing pool of
+    Parallel.h; chunk size comes from the row count alone, never
+    the pool, and partials combine in chunk order, so results do
+    not depend on thread count
+  - inner loops run the dispatched Simd::minMaxSum kernel over
+    contiguous columns; array of structs input is transposed one
+    small tile at a time to get those columns
+*/
+#ifndef BoundsHeader
+#define BoundsHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "PointCloud.h"
+#include "PointsSimd.h"
+#include "Parallel.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    Bounds<T, N> holds box corners lo and hi, and centroid mean
+    - mean is accumulated in double for every T
+  */
+  template<typename T, size_t N>
+  struct Bounds {
+    std::array<T, N> lo;
+    std::array<T, N> hi;
+    std::array<double, N> mean;
+    size_t count = 0;
+
+    std::array<double, N> center() const {
+      std::array<double, N> c;
+      for(size_t d = 0; d < N; ++d) {
+        c[d] = 0.5 * (double(lo[d]) + double(hi[d]));
+      }
+      return c;
+    }
+  };
+  /*-----------------------------------------------
+    Sphere centered on the box center with the
+    smallest radius holding every point; at most
+    sqrt(N) times the radius of the minimal sphere
+  */
+  template<size_t N>
+  struct Sphere {
+    std::array<double, N> center;
+    double radius = 0.0;
+  };
+
+  namespace BoundsDetail {
+
+    /* rows per transposed tile, about 16 KB, so tiles stay in L1 */
+    template<typename T, size_t N>
+    constexpr size_t tileRows = std::max<size_t>(64, 16384 / (N * sizeof(T)));
+
+    template<typename T, size_t N>
+    struct Partial {
+      std::array<T, N> lo;
+      std::array<T, N> hi;
+      std::array<double, N> sum;
+      Partial() {
+        lo.fill(std::numeric_limits<T>::max());
+        hi.fill(std::numeric_limits<T>::lowest());
+        sum.fill(0.0);
+      }
+    };
+    template<typename T, size_t N>
+    Bounds<T, N> finish(const std::vector<Partial<T, N>>& parts, size_t count) {
+      if(count == 0) {
+        throw "bounds of empty point set";
+      }
+      Partial<T, N> all;
+      for(const auto& part : parts) {
+        for(size_t d = 0; d < N; ++d) {
+          all.lo[d] = std::min(all.lo[d], part.lo[d]);
+          all.hi[d] = std::max(all.hi[d], part.hi[d]);
+          all.sum[d] += part.sum[d];
+        }
+      }
+      Bounds<T, N> b;
+      b.lo = all.lo;
+      b.hi = all.hi;
+      for(size_t d = 0; d < N; ++d) {
+        b.mean[d] = all.sum[d] / double(count);
+      }
+      b.count = count;
+      return b;
+    }
+    /*-----------------------------------------------
+      Squared distance of each row from c into d2,
+      columns are contiguous, so the loop vectorizes
+    */
+    template<typename T, size_t N>
+    void distances2(
+      const std::array<const T*, N>& cols, size_t n,
+      const std::array<double, N>& c, double* d2
+    ) {
+      std::fill(d2, d2 + n, 0.0);
+      for(size_t d = 0; d < N; ++d) {
+        const T* col = cols[d];
+        const double cd = c[d];
+        for(size_t i = 0; i < n; ++i) {
+          double v = double(col[i]) - cd;
+          d2[i] += v * v;
+        }
+      }
+    }
+    /*-----------------------------------------------
+      Copy rows [b, e) of pts into N columns of tile,
+      so AoS input reaches the column kernels
+    */
+    template<typename T, size_t N, typename S, typename P>
+    std::array<const T*, N> transpose(
+      const std::vector<Point<T, N, S, P>>& pts, size_t b, size_t e, std::vector<T>& tile
+    ) {
+      const size_t rows = e - b;
+      std::array<const T*, N> cols;
+      for(size_t d = 0; d < N; ++d) {
+        cols[d] = tile.data() + d * rows;
+      }
+      for(size_t i = 0; i < rows; ++i) {
+        const auto& pt = pts[b + i];
+        for(size_t d = 0; d < N; ++d) {
+          tile[d * rows + i] = pt[d];
+        }
+      }
+      return cols;
+    }
+  }  // namespace BoundsDetail
+
+  /*-------------------------------------------------------------------
+    Box and centroid of a point set in one pass
+    - grain is rows per chunk, 0 picks one from the row count
+    - throws for an empty set
+  */
+  template<typename T, size_t N, typename S, typename P>
+  Bounds<T, N> bounds(
+    const std::vector<Point<T, N, S, P>>& pts,
+    size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    using namespace BoundsDetail;
+    const size_t n = pts.size();
+    grain = chunkGrain(n, grain);
+    std::vector<Partial<T, N>> parts((n + grain - 1) / grain);
+    const auto& k = Simd::kernels<T>();
+    parallelChunks(n, grain, [&](size_t chunk, size_t b, size_t e) {
+      Partial<T, N>& part = parts[chunk];
+      std::vector<T> tile(N * tileRows<T, N>);
+      for(size_t t = b; t < e; t += tileRows<T, N>) {
+        const size_t te = std::min(e, t + tileRows<T, N>);
+        auto cols = transpose(pts, t, te, tile);
+        for(size_t d = 0; d < N; ++d) {
+          k.minMaxSum(cols[d], te - t, part.lo[d], part.hi[d], part.sum[d]);
+        }
+      }
+    }, pool);
+    return finish(parts, n);
+  }
+  template<typename T, size_t N>
+  Bounds<T, N> bounds(
+    const PointCloud<T, N>& pc, size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    using namespace BoundsDetail;
+    const size_t n = pc.size();
+    grain = chunkGrain(n, grain);
+    std::vector<Partial<T, N>> parts((n + grain - 1) / grain);
+    const auto& k = Simd::kernels<T>();
+    parallelChunks(n, grain, [&](size_t chunk, size_t b, size_t e) {
+      Partial<T, N>& part = parts[chunk];
+      for(size_t d = 0; d < N; ++d) {
+        k.minMaxSum(pc.column(d).data() + b, e - b, part.lo[d], part.hi[d], part.sum[d]);
+      }
+    }, pool);
+    return finish(parts, n);
+  }
+
+  /*-------------------------------------------------------------------
+    Bounding sphere about the center of box, one pass over the
+    points for the radius
+    - pass the result of bounds() to reuse its box
+  */
+  template<typename T, size_t N, typename S, typename P>
+  Sphere<N> boundingSphere(
+    const std::vector<Point<T, N, S, P>>& pts, const Bounds<T, N>& box,
+    size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    using namespace BoundsDetail;
+    Sphere<N> s;
+    s.center = box.center();
+    const size_t n = pts.size();
+    if(n == 0) {
+      throw "bounding sphere of empty point set";
+    }
+    grain = chunkGrain(n, grain);
+    std::vector<double> partMax((n + grain - 1) / grain, 0.0);
+    const auto& k = Simd::kernels<double>();
+    parallelChunks(n, grain, [&](size_t chunk, size_t b, size_t e) {
+      std::vector<T> tile(N * tileRows<T, N>);
+      std::vector<double> d2(tileRows<T, N>);
+      double lo = 0.0, sum = 0.0;
+      for(size_t t = b; t < e; t += tileRows<T, N>) {
+        const size_t te = std::min(e, t + tileRows<T, N>);
+        distances2<T, N>(transpose(pts, t, te, tile), te - t, s.center, d2.data());
+        k.minMaxSum(d2.data(), te - t, lo, partMax[chunk], sum);
+      }
+    }, pool);
+    s.radius = std::sqrt(*std::max_element(partMax.begin(), partMax.end()));
+    return s;
+  }
+  template<typename T, size_t N>
+  Sphere<N> boundingSphere(
+    const PointCloud<T, N>& pc, const Bounds<T, N>& box,
+    size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    using namespace BoundsDetail;
+    Sphere<N> s;
+    s.center = box.center();
+    const size_t n = pc.size();
+    if(n == 0) {
+      throw "bounding sphere of empty point set";
+    }
+    grain = chunkGrain(n, grain);
+    std::vector<double> partMax((n + grain - 1) / grain, 0.0);
+    const auto& k = Simd::kernels<double>();
+    parallelChunks(n, grain, [&](size_t chunk, size_t b, size_t e) {
+      std::vector<double> d2(tileRows<T, N>);
+      double lo = 0.0, sum = 0.0;
+      for(size_t t = b; t < e; t += tileRows<T, N>) {
+        const size_t te = std::min(e, t + tileRows<T, N>);
+        std::array<const T*, N> cols;
+        for(size_t d = 0; d < N; ++d) {
+          cols[d] = pc.column(d).data() + t;
+        }
+        distances2<T, N>(cols, te - t, s.center, d2.data());
+        k.minMaxSum(d2.data(), te - t, lo, partMax[chunk], sum);
+      }
+    }, pool);
+    s.radius = std::sqrt(*std::max_element(partMax.begin(), partMax.end()));
+    return s;
+  }
+  template<typename C>
+  auto boundingSphere(const C& pts) {
+    return boundingSphere(pts, bounds(pts));
+  }
+}
+/*-- demonstrate bounds of a small point set --*/
+
+void demo_Bounds() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("bounding box, centroid, and sphere", 45, "\n");
+  std::vector<Point<double, 3>> pts {
+    { 0.0, 0.0, 0.0 }, { 2.0, 0.0, 1.0 }, { 1.0, 4.0, -1.0 }, { -1.0, 2.0, 0.0 }
+  };
+  PointCloud<double, 3> pc(pts);
+  auto showArr = [](const std::string& nm, const auto& a) {
+    std::cout << "\n  " << nm << " = { ";
+    for(auto item : a) {
+      std::cout << item << " ";
+    }
+    std::cout << "}";
+  };
+  Bounds<double, 3> b = bounds(pts);
+  showArr("lo", b.lo);
+  showArr("hi", b.hi);
+  showArr("mean", b.mean);
+  Sphere<3> s = boundingSphere(pts, b);
+  showArr("sphere center", s.center);
+  std::cout << "\n  sphere radius = " << s.radius;
+  Bounds<double, 3> bc = bounds(pc);
+  std::cout << "\n  PointCloud gives same box and mean: "
+            << (bc.lo == b.lo && bc.hi == b.hi && bc.mean == b.mean ? "yes" : "no") << "\n";
+}
+
+/*-- compare per-statistic loops with single pass reductions --*/
+
+void benchBounds() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark bounds reductions", 45, "\n");
+  const size_t count = 1 << 22;
+  std::mt19937 gen(11);
+  std::normal_distribution<double> coord(0.0, 100.0);
+  std::vector<Point<double, 3>> pts(count);
+  for(auto& pt : pts) {
+    pt = { coord(gen), coord(gen), coord(gen) };
+  }
+  PointCloud<double, 3> pc(pts);
+  std::cout << "  " << count << " Point<double, 3>, dispatch level "
+            << Simd::levelName(Simd::kernels<double>().level)
+            << ", pool " << defaultPool().size() << " threads";
+
+  /* separate loop per statistic, checked indexing */
+  Timer tmr;
+  tmr.start();
+  std::array<double, 3> lo, hi, mean;
+  for(size_t d = 0; d < 3; ++d) {
+    lo[d] = pts[0].at(d);
+    for(const auto& pt : pts) {
+      lo[d] = std::min(lo[d], pt.at(d));
+    }
+  }
+  for(size_t d = 0; d < 3; ++d) {
+    hi[d] = pts[0].at(d);
+    for(const auto& pt : pts) {
+      hi[d] = std::max(hi[d], pt.at(d));
+    }
+  }
+  for(size_t d = 0; d < 3; ++d) {
+    double sum = 0.0;
+    for(const auto& pt : pts) {
+      sum += pt.at(d);
+    }
+    mean[d] = sum / double(count);
+  }
+  tmr.stop();
+  std::cout << "\n  separate loops, at():        " << tmr.elapsedMicroSec() << " us";
+
+  tmr.start();
+  Bounds<double, 3> aos = bounds(pts);
+  tmr.stop();
+  std::cout << "\n  bounds, array of structs:    " << tmr.elapsedMicroSec() << " us";
+  tmr.start();
+  Bounds<double, 3> soa = bounds(pc);
+  tmr.stop();
+  std::cout << "\n  bounds, PointCloud columns:  " << tmr.elapsedMicroSec() << " us";
+
+  tmr.start();
+  Sphere<3> sAos = boundingSphere(pts, aos);
+  tmr.stop();
+  std::cout << "\n  sphere radius pass, AoS:     " << tmr.elapsedMicroSec() << " us";
+  tmr.start();
+  Sphere<3> sSoa = boundingSphere(pc, soa);
+  tmr.stop();
+  std::cout << "\n  sphere radius pass, columns: " << tmr.elapsedMicroSec() << " us";
+
+  double err = 0.0;
+  for(size_t d = 0; d < 3; ++d) {
+    err = std::max(err, std::abs(aos.mean[d] - mean[d]));
+  }
+  std::cout << "\n  boxes match loops: " << (aos.lo == lo && aos.hi == hi && soa.lo == lo && soa.hi == hi ? "yes" : "NO")
+            << ", mean error " << err
+            << ", radius " << sAos.radius << (sAos.radius == sSoa.radius ? " both" : " DIFFERS") << "\n";
+}
+#endif
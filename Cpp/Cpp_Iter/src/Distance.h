@@ -0,0 +1,454 @@
+/*-------------------------------------------------------------------
+  Distance.h defines DistanceEngine<T, N>
+  - computes distances between a set of query points and a set of
+    reference points, as a full matrix or as k nearest per query
+  - metrics: Euclidean, squared Euclidean, Manhattan, and cosine
+  - reference points are packed into dimension columns and walked
+    in tiles that stay in cache while a block of queries uses them
+  - query blocks are spread across threads
+*/
+#ifndef DistanceHeader
+#define DistanceHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <concepts>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+namespace Points {
+
+  enum class Metric { Euclidean, SquaredEuclidean, Manhattan, Cosine };
+
+  inline std::string metricName(Metric m) {
+    switch(m) {
+      case Metric::Euclidean:        return "Euclidean";
+      case Metric::SquaredEuclidean: return "SquaredEuclidean";
+      case Metric::Manhattan:        return "Manhattan";
+      default:                       return "Cosine";
+    }
+  }
+  /*-----------------------------------------------
+    index of a reference point and its distance
+    from a query point
+  */
+  template<typename T>
+  struct Neighbor {
+    size_t index;
+    T distance;
+  };
+  /*-----------------------------------------------
+    row-major matrix of distances, one row per query
+  */
+  template<typename T>
+  struct DistanceMatrix {
+    size_t rows = 0;
+    size_t cols = 0;
+    std::vector<T> data;
+    T& operator()(size_t i, size_t j) { return data[i * cols + j]; }
+    const T& operator()(size_t i, size_t j) const { return data[i * cols + j]; }
+  };
+  /*-----------------------------------------------
+    Run fn(block) for blocks 0..nBlocks-1, blocks
+    dealt round-robin to threads
+    - threads == 0 uses hardware concurrency
+  */
+  template<typename F>
+  void forEachBlock(size_t nBlocks, size_t threads, F fn) {
+    if(threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, nBlocks);
+    if(threads <= 1) {
+      for(size_t b = 0; b < nBlocks; ++b) {
+        fn(b);
+      }
+      return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for(size_t t = 0; t < threads; ++t) {
+      pool.emplace_back([=]() {
+        for(size_t b = t; b < nBlocks; b += threads) {
+          fn(b);
+        }
+      });
+    }
+    for(auto& th : pool) {
+      th.join();
+    }
+  }
+
+  /*-------------------------------------------------------------------
+    DistanceEngine<T, N> holds a packed copy of the reference points
+    - refCols[d] holds dimension d of every reference point, so the
+      inner loop over a tile of references is a contiguous stream
+      that the compiler vectorizes
+    - refNorms holds reference lengths, used by cosine metric
+    - queryBlock and refTile set the tiling, at least 1 each,
+      refTile * N * sizeof(T) should fit in L1 or L2 cache
+  */
+  template<typename T, const size_t N>
+    requires std::floating_point<T>
+  class DistanceEngine {
+  public:
+    template<typename S, typename P>
+    explicit DistanceEngine(
+      const std::vector<Point<T, N, S, P>>& refs,
+      Metric m = Metric::Euclidean, size_t threads = 0
+    );
+    DistanceEngine(const DistanceEngine& de) = default;
+    DistanceEngine(DistanceEngine&& de) = default;
+    DistanceEngine& operator=(const DistanceEngine& de) = default;
+    DistanceEngine& operator=(DistanceEngine&& de) = default;
+    ~DistanceEngine() = default;
+
+    template<typename S, typename P>
+    DistanceMatrix<T> matrix(const std::vector<Point<T, N, S, P>>& queries) const;
+    template<typename S, typename P>
+    std::vector<std::vector<Neighbor<T>>>
+      nearest(const std::vector<Point<T, N, S, P>>& queries, size_t k) const;
+
+    size_t size() const { return nRefs; }
+    Metric& metric() { return _metric; }
+    size_t& threads() { return _threads; }
+    size_t queryBlock() const { return _queryBlock; }
+    size_t refTile() const { return _refTile; }
+    void queryBlock(size_t n) { _queryBlock = std::max<size_t>(1, n); }   // 0 would stall the tiling
+    void refTile(size_t n) { _refTile = std::max<size_t>(1, n); }
+  private:
+    template<typename S, typename P>
+    static std::vector<T> pack(const std::vector<Point<T, N, S, P>>& pts);
+    void tileDistances(const T* q, T qNorm, size_t j0, size_t j1, T* acc) const;
+    T finish(T raw) const;
+
+    std::array<std::vector<T>, N> refCols;
+    std::vector<T> refNorms;
+    size_t nRefs = 0;
+    Metric _metric;
+    size_t _threads;
+    size_t _queryBlock = 64;
+    size_t _refTile = 512;
+  };
+  /*-----------------------------------------------
+    Pack reference coordinates into columns using
+    Point iteration
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  template<typename S, typename P>
+  DistanceEngine<T, N>::DistanceEngine(
+    const std::vector<Point<T, N, S, P>>& refs, Metric m, size_t threads
+  ) : nRefs(refs.size()), _metric(m), _threads(threads) {
+    for(auto& col : refCols) {
+      col.resize(nRefs);
+    }
+    refNorms.resize(nRefs);
+    for(size_t j = 0; j < nRefs; ++j) {
+      size_t d = 0;
+      T sq = T{0};
+      for(auto item : refs[j]) {
+        refCols[d++][j] = item;
+        sq += item * item;
+      }
+      refNorms[j] = std::sqrt(sq);
+    }
+  }
+  /*-----------------------------------------------
+    Pack query points row-major, N values per point
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  template<typename S, typename P>
+  std::vector<T> DistanceEngine<T, N>::pack(const std::vector<Point<T, N, S, P>>& pts) {
+    std::vector<T> rows(pts.size() * N);
+    T* out = rows.data();
+    for(const auto& pt : pts) {
+      for(auto item : pt) {
+        *out++ = item;
+      }
+    }
+    return rows;
+  }
+  /*-----------------------------------------------
+    Raw metric values of query q against references
+    j0..j1-1, written to acc[0..j1-j0-1]
+    - Euclidean accumulates squared distance, finish()
+      takes the root
+    - Cosine accumulates dot product and converts it
+      here, since it needs the reference norm
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  void DistanceEngine<T, N>::tileDistances(
+    const T* q, T qNorm, size_t j0, size_t j1, T* acc
+  ) const {
+    const size_t len = j1 - j0;
+    std::fill(acc, acc + len, T{0});
+    for(size_t d = 0; d < N; ++d) {
+      const T qd = q[d];
+      const T* col = refCols[d].data() + j0;
+      switch(_metric) {
+        case Metric::Manhattan:
+          for(size_t j = 0; j < len; ++j) {
+            acc[j] += std::abs(qd - col[j]);
+          }
+          break;
+        case Metric::Cosine:
+          for(size_t j = 0; j < len; ++j) {
+            acc[j] += qd * col[j];
+          }
+          break;
+        default:
+          for(size_t j = 0; j < len; ++j) {
+            T diff = qd - col[j];
+            acc[j] += diff * diff;
+          }
+      }
+    }
+    if(_metric == Metric::Cosine) {
+      const T* norms = refNorms.data() + j0;
+      for(size_t j = 0; j < len; ++j) {
+        T denom = qNorm * norms[j];
+        acc[j] = denom > T{0} ? T{1} - acc[j] / denom : T{1};
+      }
+    }
+  }
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  T DistanceEngine<T, N>::finish(T raw) const {
+    return _metric == Metric::Euclidean ? std::sqrt(raw) : raw;
+  }
+  /*-----------------------------------------------
+    Full distance matrix, rows are queries
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  template<typename S, typename P>
+  DistanceMatrix<T> DistanceEngine<T, N>::matrix(
+    const std::vector<Point<T, N, S, P>>& queries
+  ) const {
+    DistanceMatrix<T> dm;
+    dm.rows = queries.size();
+    dm.cols = nRefs;
+    dm.data.resize(dm.rows * dm.cols);
+    std::vector<T> qRows = pack(queries);
+    size_t nBlocks = (dm.rows + _queryBlock - 1) / _queryBlock;
+
+    forEachBlock(nBlocks, _threads, [&](size_t b) {
+      size_t i0 = b * _queryBlock;
+      size_t i1 = std::min(i0 + _queryBlock, dm.rows);
+      std::vector<T> qNorms(i1 - i0);
+      for(size_t i = i0; i < i1; ++i) {
+        T sq = T{0};
+        for(size_t d = 0; d < N; ++d) {
+          sq += qRows[i * N + d] * qRows[i * N + d];
+        }
+        qNorms[i - i0] = std::sqrt(sq);
+      }
+      /* each reference tile is reused by every query in block */
+      for(size_t j0 = 0; j0 < nRefs; j0 += _refTile) {
+        size_t j1 = std::min(j0 + _refTile, nRefs);
+        for(size_t i = i0; i < i1; ++i) {
+          T* row = &dm.data[i * dm.cols + j0];
+          tileDistances(&qRows[i * N], qNorms[i - i0], j0, j1, row);
+          if(_metric == Metric::Euclidean) {
+            for(size_t j = 0; j < j1 - j0; ++j) {
+              row[j] = std::sqrt(row[j]);
+            }
+          }
+        }
+      }
+    });
+    return dm;
+  }
+  /*-----------------------------------------------
+    k nearest references for each query, nearest first
+    - keeps a bounded max-heap per query across tiles
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  template<typename S, typename P>
+  std::vector<std::vector<Neighbor<T>>> DistanceEngine<T, N>::nearest(
+    const std::vector<Point<T, N, S, P>>& queries, size_t k
+  ) const {
+    const size_t nq = queries.size();
+    k = std::min(k, nRefs);
+    std::vector<std::vector<Neighbor<T>>> result(nq);
+    std::vector<T> qRows = pack(queries);
+    size_t nBlocks = (nq + _queryBlock - 1) / _queryBlock;
+    auto farther = [](const Neighbor<T>& a, const Neighbor<T>& b) {
+      return a.distance < b.distance;
+    };
+
+    forEachBlock(nBlocks, _threads, [&](size_t b) {
+      size_t i0 = b * _queryBlock;
+      size_t i1 = std::min(i0 + _queryBlock, nq);
+      std::vector<T> acc(_refTile);
+      std::vector<T> qNorms(i1 - i0);
+      for(size_t i = i0; i < i1; ++i) {
+        T sq = T{0};
+        for(size_t d = 0; d < N; ++d) {
+          sq += qRows[i * N + d] * qRows[i * N + d];
+        }
+        qNorms[i - i0] = std::sqrt(sq);
+        result[i].reserve(k);
+      }
+      for(size_t j0 = 0; j0 < nRefs; j0 += _refTile) {
+        size_t j1 = std::min(j0 + _refTile, nRefs);
+        for(size_t i = i0; i < i1; ++i) {
+          tileDistances(&qRows[i * N], qNorms[i - i0], j0, j1, acc.data());
+          auto& heap = result[i];
+          for(size_t j = j0; j < j1; ++j) {
+            T dist = acc[j - j0];
+            if(heap.size() < k) {
+              heap.push_back({ j, dist });
+              std::push_heap(heap.begin(), heap.end(), farther);
+            }
+            else if(k > 0 && dist < heap.front().distance) {
+              std::pop_heap(heap.begin(), heap.end(), farther);
+              heap.back() = { j, dist };
+              std::push_heap(heap.begin(), heap.end(), farther);
+            }
+          }
+        }
+      }
+      for(size_t i = i0; i < i1; ++i) {
+        std::sort_heap(result[i].begin(), result[i].end(), farther);
+        for(auto& nb : result[i]) {
+          nb.distance = finish(nb.distance);
+        }
+      }
+    });
+    return result;
+  }
+}
+/*-- demonstrate distance engine --*/
+
+void demo_DistanceEngine() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("distances between point sets", 45, "\n");
+  std::vector<Point<double, 2>> refs {
+    { 0.0, 0.0 }, { 1.0, 0.0 }, { 0.0, 2.0 }, { 3.0, 4.0 }
+  };
+  std::vector<Point<double, 2>> queries { { 1.0, 1.0 }, { 3.0, 3.0 } };
+
+  for(auto m : { Metric::Euclidean, Metric::Manhattan, Metric::Cosine }) {
+    DistanceEngine<double, 2> de(refs, m);
+    auto dm = de.matrix(queries);
+    std::cout << "  " << metricName(m) << " matrix:";
+    for(size_t i = 0; i < dm.rows; ++i) {
+      std::cout << "\n    ";
+      for(size_t j = 0; j < dm.cols; ++j) {
+        std::cout << dm(i, j) << " ";
+      }
+    }
+    std::cout << "\n";
+  }
+  DistanceEngine<double, 2> de(refs);
+  auto knn = de.nearest(queries, 2);
+  for(size_t i = 0; i < knn.size(); ++i) {
+    std::cout << "  2 nearest to query " << i << ":";
+    for(auto& nb : knn[i]) {
+      std::cout << " [" << nb.index << "] " << nb.distance;
+    }
+    std::cout << "\n";
+  }
+}
+
+/*-- compare engine with nested loops over vector<Point> --*/
+
+void benchDistanceEngine() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark pairwise distances", 45, "\n");
+  const size_t nq = 1000, nr = 20000, k = 5;
+  std::vector<Point<double, 3>> queries(nq), refs(nr);
+  for(size_t i = 0; i < nq; ++i) {
+    queries[i][0] = double(i % 97); queries[i][1] = double(i % 13); queries[i][2] = 0.5;
+  }
+  for(size_t j = 0; j < nr; ++j) {
+    refs[j][0] = double(j % 89); refs[j][1] = double(j % 17); refs[j][2] = double(j % 5);
+  }
+  std::cout << "  " << nq << " queries x " << nr << " references, Point<double, 3>";
+  auto naiveDist = [&](size_t i, size_t j) {
+    double sq = 0.0;
+    for(size_t d = 0; d < 3; ++d) {
+      double diff = queries[i][d] - refs[j][d];
+      sq += diff * diff;
+    }
+    return std::sqrt(sq);
+  };
+
+  Timer tmr;
+  tmr.start();
+  std::vector<double> naive(nq * nr);
+  for(size_t i = 0; i < nq; ++i) {
+    for(size_t j = 0; j < nr; ++j) {
+      naive[i * nr + j] = naiveDist(i, j);
+    }
+  }
+  tmr.stop();
+  std::cout << "\n  matrix, nested loops:         " << tmr.elapsedMilliSec() << " ms";
+
+  DistanceEngine<double, 3> de1(refs, Metric::Euclidean, 1);
+  tmr.start();
+  auto dm1 = de1.matrix(queries);
+  tmr.stop();
+  std::cout << "\n  matrix, engine 1 thread:      " << tmr.elapsedMilliSec() << " ms";
+
+  DistanceEngine<double, 3> de(refs);
+  tmr.start();
+  auto dm = de.matrix(queries);
+  tmr.stop();
+  std::cout << "\n  matrix, engine all threads:   " << tmr.elapsedMilliSec() << " ms";
+
+  double maxErr = 0.0;
+  for(size_t n = 0; n < naive.size(); ++n) {
+    maxErr = std::max(maxErr, std::abs(naive[n] - dm.data[n]) + std::abs(naive[n] - dm1.data[n]));
+  }
+  std::cout << "  (max difference " << maxErr << ")";
+
+  tmr.start();
+  std::vector<std::vector<Neighbor<double>>> naiveKnn(nq);
+  std::vector<Neighbor<double>> all(nr);
+  for(size_t i = 0; i < nq; ++i) {
+    for(size_t j = 0; j < nr; ++j) {
+      all[j] = { j, naiveDist(i, j) };
+    }
+    std::partial_sort(all.begin(), all.begin() + k, all.end(),
+      [](const auto& a, const auto& b) { return a.distance < b.distance; });
+    naiveKnn[i].assign(all.begin(), all.begin() + k);
+  }
+  tmr.stop();
+  std::cout << "\n  " << k << " nearest, nested loops:      " << tmr.elapsedMilliSec() << " ms";
+
+  tmr.start();
+  auto knn1 = de1.nearest(queries, k);
+  tmr.stop();
+  std::cout << "\n  " << k << " nearest, engine 1 thread:   " << tmr.elapsedMilliSec() << " ms";
+
+  tmr.start();
+  auto knn = de.nearest(queries, k);
+  tmr.stop();
+  std::cout << "\n  " << k << " nearest, engine all threads: " << tmr.elapsedMilliSec() << " ms";
+
+  maxErr = 0.0;
+  for(size_t i = 0; i < nq; ++i) {
+    for(size_t n = 0; n < k; ++n) {
+      maxErr = std::max(maxErr, std::abs(naiveKnn[i][n].distance - knn[i][n].distance));
+    }
+  }
+  std::cout << "  (max difference " << maxErr << ")\n";
+}
+#endif
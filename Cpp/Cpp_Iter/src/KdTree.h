@@ -0,0 +1,478 @@
+/*-------------------------------------------------------------------
+  KdTree.h defines spatial index KdTree<T, N>
+  - answers k nearest, radius, and box queries over N-dimensional
+    points in logarithmic expected time
+  - nodes live in one flat vector, indexed rather than linked, and
+    point coordinates are copied into tree order so each leaf is a
+    contiguous run of memory
+  - the top levels of the tree are built on separate threads
+*/
+#ifndef KdTreeHeader
+#define KdTreeHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <random>
+#include <concepts>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Distance.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    KdTree<T, N> indexes a fixed set of points
+    - leaves hold up to leafSize points
+    - an interior node splits its range at the median of the
+      dimension with largest spread; left child holds values <= split
+    - node ranges are fixed by point count alone, so every subtree's
+      slot in the node vector is known before it is built, and
+      threads can fill disjoint slots without locking
+    - results report indexes into the original input order
+  */
+  template<typename T, const size_t N>
+    requires std::floating_point<T>
+  class KdTree {
+  public:
+    struct Node {
+      size_t begin;   // first point in tree order
+      size_t end;     // one past last point
+      size_t right;   // right child, left child is this + 1
+      size_t dim;     // split dimension, N marks a leaf
+      T split;
+    };
+
+    template<typename S, typename P>
+    explicit KdTree(
+      const std::vector<Point<T, N, S, P>>& pts,
+      size_t threads = 0, size_t leafSize = 16
+    );
+    KdTree(const T* coords, size_t count, size_t threads = 0, size_t leafSize = 16);
+    KdTree(const KdTree& kt) = default;
+    KdTree(KdTree&& kt) = default;
+    KdTree& operator=(const KdTree& kt) = default;
+    KdTree& operator=(KdTree&& kt) = default;
+    ~KdTree() = default;
+
+    std::vector<Neighbor<T>> nearest(const T* q, size_t k) const;
+    std::vector<Neighbor<T>> radius(const T* q, T r) const;
+    std::vector<size_t> box(const T* lo, const T* hi) const;
+
+    /* coordinates are copied through q[d], point types need not store them contiguously */
+    template<typename P>
+      requires PointLike<P>
+    std::vector<Neighbor<T>> nearest(const P& q, size_t k) const {
+      return nearest(coordsOf(q).data(), k);
+    }
+    template<typename P>
+      requires PointLike<P>
+    std::vector<Neighbor<T>> radius(const P& q, T r) const {
+      return radius(coordsOf(q).data(), r);
+    }
+    template<typename P>
+      requires PointLike<P>
+    std::vector<size_t> box(const P& lo, const P& hi) const {
+      return box(coordsOf(lo).data(), coordsOf(hi).data());
+    }
+
+    size_t size() const { return ids.size(); }
+    size_t nodeCount() const { return nodes.size(); }
+  private:
+    void build(size_t threads);
+    size_t countNodes(size_t n) const;
+    void buildNode(size_t node, size_t begin, size_t end, size_t threads);
+    const T* point(size_t i) const { return &coords[i * N]; }
+    template<typename P>
+    static std::array<T, N> coordsOf(const P& q) {
+      if(q.size() != N) {
+        throw "KdTree query point has wrong dimension";
+      }
+      std::array<T, N> c;
+      for(size_t d = 0; d < N; ++d) {
+        c[d] = T(q[d]);
+      }
+      return c;
+    }
+    T sqDist(const T* a, const T* b) const;
+    void nearestNode(size_t node, const T* q, size_t k, std::vector<Neighbor<T>>& heap) const;
+    void radiusNode(size_t node, const T* q, T r2, std::vector<Neighbor<T>>& out) const;
+    void boxNode(size_t node, const T* lo, const T* hi, std::vector<size_t>& out) const;
+
+    std::vector<T> coords;      // N values per point, tree order
+    std::vector<size_t> ids;    // original index of each point
+    std::vector<Node> nodes;    // preorder, root at 0
+    size_t leafSize;
+  };
+  /*-----------------------------------------------
+    Build from points, copying coordinates with
+    Point iteration
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  template<typename S, typename P>
+  KdTree<T, N>::KdTree(
+    const std::vector<Point<T, N, S, P>>& pts, size_t threads, size_t leafSize
+  ) : leafSize(std::max<size_t>(1, leafSize)) {
+    coords.reserve(pts.size() * N);
+    for(const auto& pt : pts) {
+      for(auto item : pt) {
+        coords.push_back(item);
+      }
+    }
+    build(threads);
+  }
+  /*-----------------------------------------------
+    Build from contiguous buffer, N values per point
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  KdTree<T, N>::KdTree(
+    const T* buf, size_t count, size_t threads, size_t leafSize
+  ) : coords(buf, buf + count * N), leafSize(std::max<size_t>(1, leafSize)) {
+    build(threads);
+  }
+  /*-----------------------------------------------
+    Nodes in a subtree of n points
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  size_t KdTree<T, N>::countNodes(size_t n) const {
+    if(n <= leafSize) {
+      return 1;
+    }
+    size_t mid = n / 2;
+    return 1 + countNodes(mid) + countNodes(n - mid);
+  }
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  void KdTree<T, N>::build(size_t threads) {
+    size_t n = coords.size() / N;
+    ids.resize(n);
+    std::iota(ids.begin(), ids.end(), size_t{0});
+    if(n == 0) {
+      return;
+    }
+    nodes.resize(countNodes(n));
+    if(threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    /* ids is permuted in place, then coords follow it */
+    buildNode(0, 0, n, threads);
+    std::vector<T> ordered(coords.size());
+    for(size_t i = 0; i < n; ++i) {
+      std::copy_n(&coords[ids[i] * N], N, &ordered[i * N]);
+    }
+    coords.swap(ordered);
+  }
+  /*-----------------------------------------------
+    Build subtree for ids[begin..end) in slot node
+    - coords is still in input order here
+    - left half goes to another thread while more
+      than one thread remains for this subtree
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  void KdTree<T, N>::buildNode(size_t node, size_t begin, size_t end, size_t threads) {
+    Node& nd = nodes[node];
+    nd.begin = begin;
+    nd.end = end;
+    size_t n = end - begin;
+    if(n <= leafSize) {
+      nd.dim = N;
+      nd.right = 0;
+      nd.split = T{0};
+      return;
+    }
+    /* split on dimension with largest spread */
+    std::array<T, N> lo, hi;
+    lo.fill(std::numeric_limits<T>::max());
+    hi.fill(std::numeric_limits<T>::lowest());
+    for(size_t i = begin; i < end; ++i) {
+      const T* p = &coords[ids[i] * N];
+      for(size_t d = 0; d < N; ++d) {
+        lo[d] = std::min(lo[d], p[d]);
+        hi[d] = std::max(hi[d], p[d]);
+      }
+    }
+    size_t dim = 0;
+    for(size_t d = 1; d < N; ++d) {
+      if(hi[d] - lo[d] > hi[dim] - lo[dim]) {
+        dim = d;
+      }
+    }
+    size_t mid = begin + n / 2;
+    std::nth_element(
+      ids.begin() + begin, ids.begin() + mid, ids.begin() + end,
+      [&](size_t a, size_t b) { return coords[a * N + dim] < coords[b * N + dim]; }
+    );
+    nd.dim = dim;
+    nd.split = coords[ids[mid] * N + dim];
+    size_t left = node + 1;
+    nd.right = left + countNodes(mid - begin);
+
+    if(threads > 1) {
+      size_t half = threads / 2;
+      std::thread th([=, this]() { buildNode(left, begin, mid, half); });
+      buildNode(nd.right, mid, end, threads - half);
+      th.join();
+    }
+    else {
+      buildNode(left, begin, mid, 1);
+      buildNode(nd.right, mid, end, 1);
+    }
+  }
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  T KdTree<T, N>::sqDist(const T* a, const T* b) const {
+    T sum = T{0};
+    for(size_t d = 0; d < N; ++d) {
+      T diff = a[d] - b[d];
+      sum += diff * diff;
+    }
+    return sum;
+  }
+  /*-----------------------------------------------
+    k nearest points, nearest first, Euclidean
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  std::vector<Neighbor<T>> KdTree<T, N>::nearest(const T* q, size_t k) const {
+    std::vector<Neighbor<T>> heap;
+    k = std::min(k, size());
+    if(k == 0) {
+      return heap;
+    }
+    heap.reserve(k);
+    nearestNode(0, q, k, heap);
+    auto closer = [](const Neighbor<T>& a, const Neighbor<T>& b) {
+      return a.distance < b.distance;
+    };
+    std::sort_heap(heap.begin(), heap.end(), closer);
+    for(auto& nb : heap) {
+      nb.index = ids[nb.index];
+      nb.distance = std::sqrt(nb.distance);
+    }
+    return heap;
+  }
+  /*-----------------------------------------------
+    heap holds squared distances and tree-order
+    indexes until nearest() converts them
+    - near child first, far child only if the split
+      plane is closer than current kth neighbor
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  void KdTree<T, N>::nearestNode(
+    size_t node, const T* q, size_t k, std::vector<Neighbor<T>>& heap
+  ) const {
+    auto closer = [](const Neighbor<T>& a, const Neighbor<T>& b) {
+      return a.distance < b.distance;
+    };
+    const Node& nd = nodes[node];
+    if(nd.dim == N) {
+      for(size_t i = nd.begin; i < nd.end; ++i) {
+        T d2 = sqDist(q, point(i));
+        if(heap.size() < k) {
+          heap.push_back({ i, d2 });
+          std::push_heap(heap.begin(), heap.end(), closer);
+        }
+        else if(d2 < heap.front().distance) {
+          std::pop_heap(heap.begin(), heap.end(), closer);
+          heap.back() = { i, d2 };
+          std::push_heap(heap.begin(), heap.end(), closer);
+        }
+      }
+      return;
+    }
+    T diff = q[nd.dim] - nd.split;
+    size_t nearChild = diff <= T{0} ? node + 1 : nd.right;
+    size_t farChild = diff <= T{0} ? nd.right : node + 1;
+    nearestNode(nearChild, q, k, heap);
+    if(heap.size() < k || diff * diff < heap.front().distance) {
+      nearestNode(farChild, q, k, heap);
+    }
+  }
+  /*-----------------------------------------------
+    all points within distance r, nearest first
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  std::vector<Neighbor<T>> KdTree<T, N>::radius(const T* q, T r) const {
+    std::vector<Neighbor<T>> out;
+    if(size() == 0) {
+      return out;
+    }
+    radiusNode(0, q, r * r, out);
+    std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+      return a.distance < b.distance;
+    });
+    for(auto& nb : out) {
+      nb.index = ids[nb.index];
+      nb.distance = std::sqrt(nb.distance);
+    }
+    return out;
+  }
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  void KdTree<T, N>::radiusNode(
+    size_t node, const T* q, T r2, std::vector<Neighbor<T>>& out
+  ) const {
+    const Node& nd = nodes[node];
+    if(nd.dim == N) {
+      for(size_t i = nd.begin; i < nd.end; ++i) {
+        T d2 = sqDist(q, point(i));
+        if(d2 <= r2) {
+          out.push_back({ i, d2 });
+        }
+      }
+      return;
+    }
+    T diff = q[nd.dim] - nd.split;
+    if(diff <= T{0} || diff * diff <= r2) {
+      radiusNode(node + 1, q, r2, out);
+    }
+    if(diff >= T{0} || diff * diff <= r2) {
+      radiusNode(nd.right, q, r2, out);
+    }
+  }
+  /*-----------------------------------------------
+    indexes of points with lo[d] <= p[d] <= hi[d]
+    for every dimension d
+  */
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  std::vector<size_t> KdTree<T, N>::box(const T* lo, const T* hi) const {
+    std::vector<size_t> out;
+    if(size() > 0) {
+      boxNode(0, lo, hi, out);
+    }
+    return out;
+  }
+  template<typename T, size_t N>
+    requires std::floating_point<T>
+  void KdTree<T, N>::boxNode(
+    size_t node, const T* lo, const T* hi, std::vector<size_t>& out
+  ) const {
+    const Node& nd = nodes[node];
+    if(nd.dim == N) {
+      for(size_t i = nd.begin; i < nd.end; ++i) {
+        const T* p = point(i);
+        bool inside = true;
+        for(size_t d = 0; d < N; ++d) {
+          inside = inside && lo[d] <= p[d] && p[d] <= hi[d];
+        }
+        if(inside) {
+          out.push_back(ids[i]);
+        }
+      }
+      return;
+    }
+    if(lo[nd.dim] <= nd.split) {
+      boxNode(node + 1, lo, hi, out);
+    }
+    if(hi[nd.dim] >= nd.split) {
+      boxNode(nd.right, lo, hi, out);
+    }
+  }
+}
+/*-- demonstrate KdTree queries --*/
+
+void demo_KdTree() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("k-d tree spatial index", 45, "\n");
+  std::vector<Point<double, 2>> pts;
+  for(size_t i = 0; i < 10; ++i) {
+    for(size_t j = 0; j < 10; ++j) {
+      pts.push_back(Point<double, 2> { double(i), double(j) });
+    }
+  }
+  KdTree<double, 2> kt(pts, 0, 4);
+  std::cout << "  " << kt.size() << " grid points, " << kt.nodeCount() << " nodes";
+
+  Point<double, 2> q { 4.2, 5.9 };
+  std::cout << "\n  3 nearest to { 4.2, 5.9 }:";
+  for(auto& nb : kt.nearest(q, 3)) {
+    std::cout << " [" << nb.index << "] " << nb.distance;
+  }
+  std::cout << "\n  within 1.0 of { 4.2, 5.9 }:";
+  for(auto& nb : kt.radius(q, 1.0)) {
+    std::cout << " [" << nb.index << "]";
+  }
+  Point<double, 2> lo { 2.0, 2.0 }, hi { 3.0, 4.0 };
+  auto inBox = kt.box(lo, hi);
+  std::sort(inBox.begin(), inBox.end());
+  std::cout << "\n  in box { 2, 2 } - { 3, 4 }:";
+  for(auto i : inBox) {
+    std::cout << " [" << i << "]";
+  }
+  std::cout << "\n";
+}
+
+/*-- compare k-d tree queries with brute force as data grows --*/
+
+void benchKdTree() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark k-d tree vs brute force", 45, "\n");
+  const size_t nQueries = 200, k = 8;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> coord(0.0, 1000.0);
+  std::vector<double> queries(nQueries * 3);
+  for(auto& c : queries) {
+    c = coord(gen);
+  }
+  std::cout << "  Point<double, 3>, " << nQueries << " queries, k = " << k;
+
+  for(size_t n : { 1000, 10000, 100000, 1000000 }) {
+    std::vector<double> buf(n * 3);
+    for(auto& c : buf) {
+      c = coord(gen);
+    }
+    Timer tmr;
+    tmr.start();
+    KdTree<double, 3> kt(buf.data(), n);
+    tmr.stop();
+    size_t buildUs = tmr.elapsedMicroSec();
+
+    tmr.start();
+    double treeCheck = 0.0;
+    for(size_t i = 0; i < nQueries; ++i) {
+      treeCheck += kt.nearest(&queries[i * 3], k).back().distance;
+    }
+    tmr.stop();
+    double treeUs = double(tmr.elapsedNanoSec()) / 1000.0 / nQueries;
+
+    tmr.start();
+    double bruteCheck = 0.0;
+    std::vector<double> d2(n);
+    for(size_t i = 0; i < nQueries; ++i) {
+      const double* q = &queries[i * 3];
+      for(size_t j = 0; j < n; ++j) {
+        const double* p = &buf[j * 3];
+        double dx = q[0] - p[0], dy = q[1] - p[1], dz = q[2] - p[2];
+        d2[j] = dx * dx + dy * dy + dz * dz;
+      }
+      std::nth_element(d2.begin(), d2.begin() + (k - 1), d2.end());
+      bruteCheck += std::sqrt(d2[k - 1]);
+    }
+    tmr.stop();
+    double bruteUs = double(tmr.elapsedNanoSec()) / 1000.0 / nQueries;
+
+    std::cout << "\n  n = " << n << ": build " << buildUs << " us"
+              << ", query " << treeUs << " us, brute force " << bruteUs << " us"
+              << "  (check " << treeCheck - bruteCheck << ")";
+  }
+  std::cout << "\n";
+}
+#endif
@@ -0,0 +1,372 @@
+/*-------------------------------------------------------------------
+  Parallel.h defines parallel forEachOp, transform, and
+  transform-reduce over random-access collections
+  - work runs on a work-stealing pool: each worker owns a deque,
+    takes its own newest task first, and steals the oldest task of
+    another worker when its deque is empty
+  - a range of n items is cut into chunks of grain items, chunk
+    boundaries depend only on n and grain
+  - reductions combine one partial per chunk in chunk order, so a
+    result is the same for any thread count and any schedule
+  - the calling thread runs chunks too while it waits, so calls
+    may nest inside pool tasks
+*/
+#ifndef ParallelHeader
+#define ParallelHeader
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include <cmath>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    WorkStealingPool runs submitted tasks on a fixed set of workers
+    - threads == 0 uses hardware concurrency
+    - tasks submitted from a worker go to that worker's deque,
+      others are dealt round-robin
+  */
+  class WorkStealingPool {
+  public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t threads = 0);
+    WorkStealingPool(const WorkStealingPool& wp) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool& wp) = delete;
+    ~WorkStealingPool();
+
+    size_t size() const { return workers.size(); }
+    void submit(Task task);
+    bool runOne();            // run one queued task on this thread
+  private:
+    struct Queue {
+      std::mutex mtx;
+      std::deque<Task> tasks;
+    };
+    static constexpr size_t notWorker = size_t(-1);
+    bool take(size_t self, Task& task);
+    void work(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMtx;
+    std::condition_variable wake;
+    std::atomic<size_t> pending { 0 };
+    std::atomic<size_t> next { 0 };
+    std::atomic<bool> stopping { false };
+
+    inline static thread_local WorkStealingPool* currentPool = nullptr;
+    inline static thread_local size_t currentIndex = notWorker;
+  };
+
+  inline WorkStealingPool::WorkStealingPool(size_t threads) {
+    if(threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for(size_t t = 0; t < threads; ++t) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    workers.reserve(threads);
+    for(size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([this, t]() { work(t); });
+    }
+  }
+  inline WorkStealingPool::~WorkStealingPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMtx);
+      stopping = true;
+    }
+    wake.notify_all();
+    for(auto& th : workers) {
+      th.join();
+    }
+  }
+  inline void WorkStealingPool::submit(Task task) {
+    size_t q = (currentPool == this)
+      ? currentIndex
+      : next.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+      /* counted with the push, under the lock take() pops with, so
+         pending never shows a task that cannot be taken yet */
+      std::lock_guard<std::mutex> lock(queues[q]->mtx);
+      queues[q]->tasks.push_back(std::move(task));
+      ++pending;
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleepMtx);   // a worker is either past its check or waiting
+    }
+    wake.notify_one();
+  }
+  /*-----------------------------------------------
+    Own deque newest first, then steal oldest from
+    the others, starting with the next worker
+  */
+  inline bool WorkStealingPool::take(size_t self, Task& task) {
+    const size_t n = queues.size();
+    if(self != notWorker) {
+      Queue& own = *queues[self];
+      std::lock_guard<std::mutex> lock(own.mtx);
+      if(!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        --pending;
+        return true;
+      }
+    }
+    size_t start = self == notWorker ? 0 : self + 1;
+    for(size_t i = 0; i < n; ++i) {
+      Queue& victim = *queues[(start + i) % n];
+      std::lock_guard<std::mutex> lock(victim.mtx);
+      if(!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        --pending;
+        return true;
+      }
+    }
+    return false;
+  }
+  inline bool WorkStealingPool::runOne() {
+    Task task;
+    if(!take(currentPool == this ? currentIndex : notWorker, task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+  inline void WorkStealingPool::work(size_t self) {
+    currentPool = this;
+    currentIndex = self;
+    Task task;
+    while(true) {
+      if(take(self, task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMtx);
+      wake.wait(lock, [this]() { return stopping || pending > 0; });
+      if(stopping && pending == 0) {
+        return;
+      }
+    }
+  }
+  /*-----------------------------------------------
+    Process-wide pool, made on first use
+  */
+  inline WorkStealingPool& defaultPool() {
+    static WorkStealingPool pool;
+    return pool;
+  }
+
+  /*-------------------------------------------------------------------
+    Chunked range execution
+    - fn(chunk, begin, end) is called once per chunk
+    - grain == 0 picks up to 64 chunks, at least 1024 items each,
+      from n alone, so chunk boundaries never depend on the pool;
+      small collections such as a Point run inline
+    - the first exception thrown by any chunk is rethrown here
+      after every chunk has finished
+  */
+  inline size_t chunkGrain(size_t n, size_t grain) {
+    if(grain == 0) {
+      grain = std::max<size_t>(1024, (n + 63) / 64);
+    }
+    return grain;
+  }
+  template<typename F>
+  void parallelChunks(size_t n, size_t grain, F fn, WorkStealingPool& pool) {
+    if(n == 0) {
+      return;
+    }
+    const size_t chunks = (n + grain - 1) / grain;
+    auto run = [&](size_t c) {
+      fn(c, c * grain, std::min(n, (c + 1) * grain));
+    };
+    if(chunks == 1) {
+      run(0);
+      return;
+    }
+    std::atomic<size_t> remaining { chunks };
+    std::exception_ptr error;
+    std::mutex errorMtx;
+    auto guarded = [&](size_t c) {
+      try {
+        run(c);
+      }
+      catch(...) {
+        std::lock_guard<std::mutex> lock(errorMtx);
+        if(!error) {
+          error = std::current_exception();
+        }
+      }
+      remaining.fetch_sub(1, std::memory_order_acq_rel);
+    };
+    for(size_t c = 1; c < chunks; ++c) {
+      pool.submit([&guarded, c]() { guarded(c); });
+    }
+    guarded(0);
+    while(remaining.load(std::memory_order_acquire) > 0) {
+      if(!pool.runOne()) {
+        std::this_thread::yield();
+      }
+    }
+    if(error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  template<typename C>
+  concept RandomAccessColl = std::random_access_iterator<decltype(std::begin(std::declval<C&>()))>;
+
+  /*-----------------------------------------------
+    Apply f to every item of c, items may be
+    modified, f must not depend on item order
+  */
+  template<typename C, typename F>
+    requires RandomAccessColl<C>
+  void parallelForEachOp(
+    C& c, F f, size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    auto first = std::begin(c);
+    const size_t n = size_t(std::distance(first, std::end(c)));
+    parallelChunks(n, chunkGrain(n, grain), [&](size_t, size_t b, size_t e) {
+      for(auto itr = first + b; itr != first + e; ++itr) {
+        f(*itr);
+      }
+    }, pool);
+  }
+  /*-----------------------------------------------
+    out[i] = f(in[i]), out must hold as many items
+    as in
+  */
+  template<typename CI, typename CO, typename F>
+    requires RandomAccessColl<const CI> && RandomAccessColl<CO>
+  void parallelTransform(
+    const CI& in, CO& out, F f, size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    auto src = std::begin(in);
+    auto dst = std::begin(out);
+    const size_t n = size_t(std::distance(src, std::end(in)));
+    if(size_t(std::distance(dst, std::end(out))) < n) {
+      throw "parallelTransform output too small";
+    }
+    parallelChunks(n, chunkGrain(n, grain), [&](size_t, size_t b, size_t e) {
+      for(size_t i = b; i < e; ++i) {
+        dst[i] = f(src[i]);
+      }
+    }, pool);
+  }
+  /*-----------------------------------------------
+    reduce(init, transform(item)) over c
+    - each chunk folds its items left to right from
+      T{}, then partials fold in chunk order from
+      init, so the result depends on grain but not
+      on thread count or schedule
+    - reduce should be associative, T{} its identity
+  */
+  template<typename C, typename T, typename R, typename F>
+    requires RandomAccessColl<const C>
+  T parallelTransformReduce(
+    const C& c, T init, R reduce, F transform,
+    size_t grain = 0, WorkStealingPool& pool = defaultPool()
+  ) {
+    auto first = std::begin(c);
+    const size_t n = size_t(std::distance(first, std::end(c)));
+    grain = chunkGrain(n, grain);
+    std::vector<T> partials((n + grain - 1) / grain, T{});
+    parallelChunks(n, grain, [&](size_t chunk, size_t b, size_t e) {
+      T acc {};
+      for(auto itr = first + b; itr != first + e; ++itr) {
+        acc = reduce(acc, transform(*itr));
+      }
+      partials[chunk] = acc;
+    }, pool);
+    for(auto& part : partials) {
+      init = reduce(init, part);
+    }
+    return init;
+  }
+}
+/*-- compare sequential and pooled loops, check determinism --*/
+
+void benchParallel() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark parallel transform-reduce", 45, "\n");
+  const size_t count = 1 << 24;
+  std::vector<double> v(count);
+  for(size_t i = 0; i < count; ++i) {
+    v[i] = 1e3 * std::sin(double(i));    // varied magnitudes, so sum order shows in the bits
+  }
+  auto plus = [](double a, double b) { return a + b; };
+  auto square = [](double x) { return x * x; };
+  std::cout << "  sum of squares over " << count << " doubles";
+
+  Timer tmr;
+  tmr.start();
+  double seq = std::transform_reduce(v.begin(), v.end(), 0.0, plus, square);
+  tmr.stop();
+  std::cout << "\n  std::transform_reduce:     " << tmr.elapsedMicroSec() << " us";
+
+  std::vector<size_t> threadCounts { 1, 2, 3 };
+  size_t hw = std::thread::hardware_concurrency();
+  if(hw > 3) {
+    threadCounts.push_back(hw);
+  }
+  std::vector<double> results;
+  for(size_t threads : threadCounts) {
+    WorkStealingPool pool(threads);
+    tmr.start();
+    results.push_back(parallelTransformReduce(v, 0.0, plus, square, 0, pool));
+    tmr.stop();
+    std::cout << "\n  parallelTransformReduce, " << threads << " thread"
+              << (threads > 1 ? "s: " : ":  ") << tmr.elapsedMicroSec() << " us";
+  }
+  bool same = std::all_of(results.begin(), results.end(), [&](double r) {
+    return std::memcmp(&r, &results[0], sizeof(double)) == 0;
+  });
+  std::cout << "\n  bitwise equal across thread counts: " << (same ? "yes" : "NO")
+            << ", differs from sequential by " << results[0] - seq;
+
+  std::vector<Point<double, 3, InlineCoords, NoStamp>> pts(count / 8);
+  for(size_t i = 0; i < pts.size(); ++i) {
+    pts[i] = { double(i), 1.0, -1.0 };
+  }
+  auto normalize = [](auto& pt) {
+    double n = std::sqrt(pt[0] * pt[0] + pt[1] * pt[1] + pt[2] * pt[2]);
+    for(auto& c : pt) {
+      c /= n;
+    }
+  };
+  tmr.start();
+  for(auto& pt : pts) {
+    normalize(pt);
+  }
+  tmr.stop();
+  std::cout << "\n  normalize " << pts.size() << " points, loop:              "
+            << tmr.elapsedMicroSec() << " us";
+  tmr.start();
+  parallelForEachOp(pts, normalize);
+  tmr.stop();
+  std::cout << "\n  normalize again, parallelForEachOp, " << defaultPool().size()
+            << " threads: " << tmr.elapsedMicroSec() << " us\n";
+}
+#endif
@@ -0,0 +1,326 @@
+/*-------------------------------------------------------------------
+  PointCloud.h defines columnar container PointCloud<T, N>
+  - PointCloud<T, N> holds many points as N coordinate columns
+    and a timestamp column, each a contiguous std::vector.
+  - Iteration yields PointRef proxies that look like a Point,
+    so code written for Point<T, N> can walk a cloud.
+*/
+#ifndef PointCloudHeader
+#define PointCloudHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <chrono>
+#include <iterator>
+#include <initializer_list>
+#include <algorithm>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    PointRef<T, N, Col> is a proxy for one row of a PointCloud.
+    - Col is std::vector<T> for mutable rows and const std::vector<T>
+      for immutable rows.
+    - It holds only a pointer to the cloud's columns and a row index,
+      so it is cheap to create and copy.
+    - Its coordinate iterator steps across the N columns, so range-for,
+      indexing, and size() work as they do for Point<T, N>.
+  */
+  template<typename T, size_t N, typename Col>
+  class PointRef {
+  public:
+    using value_type = T;
+    using reference = decltype(std::declval<Col&>()[0]);
+
+    class iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = PointRef::reference;
+
+      iterator() = default;
+      iterator(Col* cols, size_t row, size_t dim)
+        : cols_(cols), row_(row), dim_(dim) {}
+      reference operator*() const { return cols_[dim_][row_]; }
+      reference operator[](difference_type n) const { return cols_[dim_ + n][row_]; }
+      iterator& operator++() { ++dim_; return *this; }
+      iterator operator++(int) { iterator tmp = *this; ++dim_; return tmp; }
+      iterator& operator--() { --dim_; return *this; }
+      iterator operator--(int) { iterator tmp = *this; --dim_; return tmp; }
+      iterator& operator+=(difference_type n) { dim_ += n; return *this; }
+      iterator& operator-=(difference_type n) { dim_ -= n; return *this; }
+      iterator operator+(difference_type n) const { return iterator(cols_, row_, dim_ + n); }
+      iterator operator-(difference_type n) const { return iterator(cols_, row_, dim_ - n); }
+      difference_type operator-(const iterator& other) const {
+        return difference_type(dim_) - difference_type(other.dim_);
+      }
+      bool operator==(const iterator& other) const { return dim_ == other.dim_; }
+      bool operator!=(const iterator& other) const { return dim_ != other.dim_; }
+      bool operator<(const iterator& other) const { return dim_ < other.dim_; }
+    private:
+      Col* cols_ = nullptr;
+      size_t row_ = 0;
+      size_t dim_ = 0;
+    };
+    using const_iterator = iterator;
+
+    PointRef(Col* cols, size_t row) : cols_(cols), row_(row) {}
+
+    size_t size() const { return N; }
+    size_t row() const { return row_; }
+    reference operator[](size_t dim) const { return cols_[dim][row_]; }
+    iterator begin() const { return iterator(cols_, row_, 0); }
+    iterator end() const { return iterator(cols_, row_, N); }
+
+    /* copy row into a stand-alone point, its time is time of copy */
+    Point<T, N> toPoint() const {
+      Point<T, N> pt;
+      std::copy(begin(), end(), pt.begin());
+      return pt;
+    }
+  private:
+    Col* cols_;
+    size_t row_;
+  };
+  /*-----------------------------------------------
+    Display PointRef as comma separated list,
+    e.g., for demoWhiler(cloud)
+  */
+  template<typename T, size_t N, typename Col>
+  std::ostream& operator<<(std::ostream& out, const PointRef<T, N, Col>& p) {
+    out << "{ ";
+    for(size_t i = 0; i < N; ++i) {
+      out << p[i] << (i + 1 < N ? ", " : " }");
+    }
+    return out;
+  }
+
+  /*-------------------------------------------------------------------
+    PointCloud<T, N> holds a collection of points in structure of
+    arrays layout.
+    - column(d) is a contiguous std::vector<T> holding dimension d
+      for every point, so scans of one dimension stream through
+      memory and vectorize.
+    - times() holds a time_point for each point in the same order.
+    - begin() and end() return iterators yielding PointRef proxies.
+      Use "for(auto p : cloud)" or "for(auto&& p : cloud)", since
+      a proxy cannot bind to a non-const lvalue reference.
+  */
+  template<typename T, const size_t N>
+  class PointCloud {
+  public:
+    using column_type = std::vector<T>;
+    using time_type = time_point<system_clock>;
+    using reference = PointRef<T, N, column_type>;
+    using const_reference = PointRef<T, N, const column_type>;
+
+    /*---------------------------------------------
+      Row iterator, yields proxies by value
+    */
+    template<typename Ref, typename Col>
+    class basic_iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = Ref;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = Ref;
+
+      basic_iterator() = default;
+      basic_iterator(Col* cols, size_t row) : cols_(cols), row_(row) {}
+      Ref operator*() const { return Ref(cols_, row_); }
+      Ref operator[](difference_type n) const { return Ref(cols_, row_ + n); }
+      basic_iterator& operator++() { ++row_; return *this; }
+      basic_iterator operator++(int) { basic_iterator tmp = *this; ++row_; return tmp; }
+      basic_iterator& operator--() { --row_; return *this; }
+      basic_iterator operator--(int) { basic_iterator tmp = *this; --row_; return tmp; }
+      basic_iterator& operator+=(difference_type n) { row_ += n; return *this; }
+      basic_iterator& operator-=(difference_type n) { row_ -= n; return *this; }
+      basic_iterator operator+(difference_type n) const { return basic_iterator(cols_, row_ + n); }
+      basic_iterator operator-(difference_type n) const { return basic_iterator(cols_, row_ - n); }
+      difference_type operator-(const basic_iterator& other) const {
+        return difference_type(row_) - difference_type(other.row_);
+      }
+      bool operator==(const basic_iterator& other) const { return row_ == other.row_; }
+      bool operator!=(const basic_iterator& other) const { return row_ != other.row_; }
+      bool operator<(const basic_iterator& other) const { return row_ < other.row_; }
+    private:
+      Col* cols_ = nullptr;
+      size_t row_ = 0;
+    };
+    using iterator = basic_iterator<reference, column_type>;
+    using const_iterator = basic_iterator<const_reference, const column_type>;
+    using value_type = reference;
+
+    PointCloud() = default;
+    PointCloud(const PointCloud& pc) = default;
+    PointCloud(PointCloud&& pc) = default;
+    PointCloud& operator=(const PointCloud& pc) = default;
+    PointCloud& operator=(PointCloud&& pc) = default;
+    ~PointCloud() = default;
+
+    template<typename S, typename P>
+    explicit PointCloud(const std::vector<Point<T, N, S, P>>& pts);
+    template<typename E>
+      requires CloudExpr<E, T, N>
+    PointCloud& operator=(const E& e);       // fused assignment
+
+    void reserve(size_t n);
+    void clear();
+    size_t size() const { return tms.size(); }
+    bool empty() const { return tms.empty(); }
+
+    template<typename S, typename P>
+    void push_back(const Point<T, N, S, P>& pt);
+    void push_back(std::initializer_list<T> il, time_type tp = system_clock::now());
+
+    reference operator[](size_t row) { return reference(cols.data(), row); }
+    const_reference operator[](size_t row) const { return const_reference(cols.data(), row); }
+
+    iterator begin() { return iterator(cols.data(), 0); }
+    iterator end() { return iterator(cols.data(), size()); }
+    const_iterator begin() const { return const_iterator(cols.data(), 0); }
+    const_iterator end() const { return const_iterator(cols.data(), size()); }
+
+    column_type& column(size_t dim) { return cols[dim]; }
+    const column_type& column(size_t dim) const { return cols[dim]; }
+    std::vector<time_type>& times() { return tms; }
+    const std::vector<time_type>& times() const { return tms; }
+  private:
+    std::array<column_type, N> cols;
+    std::vector<time_type> tms;
+  };
+  /*-----------------------------------------------
+    Build columns from array of structs points
+  */
+  template<typename T, size_t N>
+  template<typename S, typename P>
+  PointCloud<T, N>::PointCloud(const std::vector<Point<T, N, S, P>>& pts) {
+    reserve(pts.size());
+    for(const auto& pt : pts) {
+      push_back(pt);
+    }
+  }
+  /*-----------------------------------------------
+    Evaluate a cloud expression column by column
+    - each inner loop walks contiguous columns, so
+      the compiler vectorizes the fused expression
+    - rows past the current size are added with
+      the current time, existing times are kept
+  */
+  template<typename T, size_t N>
+  template<typename E>
+    requires CloudExpr<E, T, N>
+  PointCloud<T, N>& PointCloud<T, N>::operator=(const E& e) {
+    const size_t rows = e.rows();
+    if(rows != size()) {
+      for(auto& col : cols) {
+        col.resize(rows);   // size differs, so this cloud is not in e
+      }
+      tms.resize(rows, system_clock::now());
+    }
+    for(size_t d = 0; d < N; ++d) {
+      T* out = cols[d].data();
+      for(size_t row = 0; row < rows; ++row) {
+        out[row] = T(e.value(d, row));
+      }
+    }
+    return *this;
+  }
+  /*-----------------------------------------------
+    Reserve capacity in every column
+  */
+  template<typename T, size_t N>
+  void PointCloud<T, N>::reserve(size_t n) {
+    for(auto& col : cols) {
+      col.reserve(n);
+    }
+    tms.reserve(n);
+  }
+  template<typename T, size_t N>
+  void PointCloud<T, N>::clear() {
+    for(auto& col : cols) {
+      col.clear();
+    }
+    tms.clear();
+  }
+  /*-----------------------------------------------
+    Append point's coordinates and time
+  */
+  template<typename T, size_t N>
+  template<typename S, typename P>
+  void PointCloud<T, N>::push_back(const Point<T, N, S, P>& pt) {
+    size_t d = 0;
+    for(auto item : pt) {
+      cols[d++].push_back(item);
+    }
+    tms.push_back(pt.timePoint());
+  }
+  /*-----------------------------------------------
+    Append coordinates from list
+    - if il is smaller than N fill remainder with
+      default values of T
+    - if il is larger use first N elements of il
+  */
+  template<typename T, size_t N>
+  void PointCloud<T, N>::push_back(std::initializer_list<T> il, time_type tp) {
+    auto itr = il.begin();
+    for(size_t d = 0; d < N; ++d) {
+      cols[d].push_back(itr != il.end() ? *itr++ : T{0});
+    }
+    tms.push_back(tp);
+  }
+  /*-----------------------------------------------
+    Sum of one dimension
+    - single pass over contiguous column
+  */
+  template<typename T, size_t N>
+  T columnSum(const PointCloud<T, N>& pc, size_t dim) {
+    T sum = T{0};
+    for(auto item : pc.column(dim)) {
+      sum += item;
+    }
+    return sum;
+  }
+}
+/*-- compare per-dimension scan of vector<Point> and PointCloud --*/
+
+void benchPointCloud() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark scan of one dimension", 45, "\n");
+  const size_t count = 1000000;
+  std::vector<Point<double, 3>> pts(count);
+  for(size_t i = 0; i < count; ++i) {
+    pts[i][0] = double(i % 100);
+    pts[i][1] = 1.0;
+    pts[i][2] = 2.0;
+  }
+  PointCloud<double, 3> pc(pts);
+  std::cout << "  " << count << " points";
+
+  Timer tmr;
+  tmr.start();
+  double aosSum = 0.0;
+  for(auto& pt : pts) {
+    aosSum += pt.coords()[0];
+  }
+  tmr.stop();
+  std::cout << "\n  vector<Point<double, 3>>: " << tmr.elapsedMicroSec()
+            << " us  (sum = " << aosSum << ")";
+
+  tmr.start();
+  double soaSum = columnSum(pc, 0);
+  tmr.stop();
+  std::cout << "\n  PointCloud<double, 3>:    " << tmr.elapsedMicroSec()
+            << " us  (sum = " << soaSum << ")\n";
+}
+#endif
@@ -0,0 +1,449 @@
+/*-------------------------------------------------------------------
+  PointFile.h defines a binary file format for Point<T, N> collections
+  - a 64 byte little-endian header records format version, coordinate
+    type, N, and point count
+  - coordinates follow as packed rows of N values, then an optional
+    column of int64 epoch nanosecond timestamps, each section starting
+    on a 64 byte boundary
+  - PointFileView maps a file into memory and presents its rows as
+    std::span<const T, N>, which satisfies PointLike, so the iteration
+    templates walk a file without copying it
+*/
+#ifndef PointFileHeader
+#define PointFileHeader
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <span>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <filesystem>
+#include <concepts>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    File header, identical on disk for every point type
+    - dataOffset and timeOffset let later versions grow the header
+      without breaking readers of this one
+    - timeOffset is zero when the file holds no timestamps
+  */
+  struct PointHeader {
+    char magic[8];            // "BITSPTS" and a terminating null
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t typeCode;   // coordinate type, see pointTypeCode
+    std::uint32_t dims;       // N
+    std::uint64_t count;      // points
+    std::uint64_t dataOffset; // first coordinate
+    std::uint64_t timeOffset; // first timestamp, or 0
+    std::uint32_t recordSize; // bytes per point in the data section
+    std::uint8_t reserved[12];
+  };
+  static_assert(sizeof(PointHeader) == 64);
+
+  constexpr char pointFileMagic[8] = "BITSPTS";
+  constexpr std::uint32_t pointFileVersion = 1;
+  constexpr std::uint64_t pointFileAlign = 64;
+
+  /*-----------------------------------------------
+    Type codes stored in the header
+    - 16 is reserved for Point4D records
+  */
+  template<typename T>
+  constexpr std::uint32_t pointTypeCode() {
+    if constexpr(std::same_as<T, float>) { return 1; }
+    else if constexpr(std::same_as<T, double>) { return 2; }
+    else if constexpr(std::same_as<T, std::int32_t>) { return 3; }
+    else if constexpr(std::same_as<T, std::int64_t>) { return 4; }
+    else {
+      static_assert(sizeof(T) == 0, "PointFile supports float, double, int32, int64");
+      return 0;
+    }
+  }
+  inline std::uint64_t alignUp(std::uint64_t n) {
+    return (n + pointFileAlign - 1) / pointFileAlign * pointFileAlign;
+  }
+
+  /*-----------------------------------------------
+    Write pts to path
+    - stamped points also write their timestamps
+    - rows are staged in a buffer so the stream sees
+      a few large writes
+  */
+  template<typename T, size_t N, typename S, typename P>
+  void writePointFile(
+    const std::string& path, const std::vector<Point<T, N, S, P>>& pts
+  ) {
+    static_assert(std::endian::native == std::endian::little,
+      "PointFile writes little-endian hosts only");
+    constexpr bool stamped = !std::same_as<P, NoStamp>;
+
+    PointHeader hdr{};
+    std::memcpy(hdr.magic, pointFileMagic, sizeof(hdr.magic));
+    hdr.version = pointFileVersion;
+    hdr.headerSize = sizeof(PointHeader);
+    hdr.typeCode = pointTypeCode<T>();
+    hdr.dims = std::uint32_t(N);
+    hdr.count = pts.size();
+    hdr.recordSize = std::uint32_t(N * sizeof(T));
+    hdr.dataOffset = alignUp(sizeof(PointHeader));
+    std::uint64_t dataEnd = hdr.dataOffset + hdr.count * hdr.recordSize;
+    hdr.timeOffset = stamped ? alignUp(dataEnd) : 0;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if(!out) {
+      throw "PointFile cannot open file for writing";
+    }
+    std::vector<char> pad(pointFileAlign, 0);
+    out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    out.write(pad.data(), std::streamsize(hdr.dataOffset - sizeof(hdr)));
+
+    const size_t chunk = 4096;
+    std::vector<T> rows;
+    rows.reserve(chunk * N);
+    for(size_t i = 0; i < pts.size(); i += chunk) {
+      rows.clear();
+      size_t last = std::min(pts.size(), i + chunk);
+      for(size_t j = i; j < last; ++j) {
+        rows.insert(rows.end(), pts[j].begin(), pts[j].end());
+      }
+      out.write(reinterpret_cast<const char*>(rows.data()),
+                std::streamsize(rows.size() * sizeof(T)));
+    }
+    if constexpr(stamped) {
+      out.write(pad.data(), std::streamsize(hdr.timeOffset - dataEnd));
+      std::vector<std::int64_t> times;
+      times.reserve(chunk);
+      for(size_t i = 0; i < pts.size(); i += chunk) {
+        times.clear();
+        size_t last = std::min(pts.size(), i + chunk);
+        for(size_t j = i; j < last; ++j) {
+          times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            pts[j].timePoint().time_since_epoch()
+          ).count());
+        }
+        out.write(reinterpret_cast<const char*>(times.data()),
+                  std::streamsize(times.size() * sizeof(std::int64_t)));
+      }
+    }
+    if(!out) {
+      throw "PointFile write failed";
+    }
+  }
+
+  /*-------------------------------------------------------------------
+    MappedFile maps a whole file read-only
+    - move-only, unmaps in its destructor
+  */
+  class MappedFile {
+  public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile& mf) = delete;
+    MappedFile& operator=(const MappedFile& mf) = delete;
+    MappedFile(MappedFile&& mf) noexcept { swap(mf); }
+    MappedFile& operator=(MappedFile&& mf) noexcept { swap(mf); return *this; }
+    ~MappedFile() { close(); }
+
+    const std::byte* data() const { return _data; }
+    size_t size() const { return _size; }
+  private:
+    void close();
+    void swap(MappedFile& mf) noexcept {
+      std::swap(_data, mf._data);
+      std::swap(_size, mf._size);
+    }
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+  };
+  inline MappedFile::MappedFile(const std::string& path) {
+  #ifdef _WIN32
+    HANDLE file = CreateFileA(
+      path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if(file == INVALID_HANDLE_VALUE) {
+      throw "PointFile cannot open file";
+    }
+    LARGE_INTEGER sz;
+    if(!GetFileSizeEx(file, &sz)) {
+      CloseHandle(file);
+      throw "PointFile cannot read file size";
+    }
+    _size = size_t(sz.QuadPart);
+    if(_size > 0) {
+      HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if(map != nullptr) {
+        _data = static_cast<const std::byte*>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(map);   // view keeps mapping alive
+      }
+    }
+    CloseHandle(file);
+  #else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+      throw "PointFile cannot open file";
+    }
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw "PointFile cannot read file size";
+    }
+    _size = size_t(st.st_size);
+    if(_size > 0) {
+      void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(p != MAP_FAILED) {
+        _data = static_cast<const std::byte*>(p);
+      }
+    }
+    ::close(fd);        // mapping outlives descriptor
+  #endif
+    if(_size > 0 && _data == nullptr) {
+      throw "PointFile cannot map file";
+    }
+  }
+  inline void MappedFile::close() {
+    if(_data != nullptr) {
+    #ifdef _WIN32
+      UnmapViewOfFile(_data);
+    #else
+      ::munmap(const_cast<std::byte*>(_data), _size);
+    #endif
+    }
+    _data = nullptr;
+    _size = 0;
+  }
+
+  /*-------------------------------------------------------------------
+    PointFileView<T, N> is a zero-copy view of a point file
+    - opening validates the header against T and N and throws a
+      string describing the first mismatch
+    - rows are std::span<const T, N> pointing into the mapping,
+      valid while the view lives
+    - time(i) returns int64 epoch nanoseconds for stamped files
+  */
+  template<typename T, const size_t N>
+  class PointFileView {
+  public:
+    using row_type = std::span<const T, N>;
+
+    class iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = row_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = row_type;
+
+      iterator() = default;
+      explicit iterator(const T* p) : p_(p) {}
+      row_type operator*() const { return row_type(p_, N); }
+      row_type operator[](difference_type n) const { return row_type(p_ + n * N, N); }
+      iterator& operator++() { p_ += N; return *this; }
+      iterator operator++(int) { iterator tmp = *this; p_ += N; return tmp; }
+      iterator& operator--() { p_ -= N; return *this; }
+      iterator operator--(int) { iterator tmp = *this; p_ -= N; return tmp; }
+      iterator& operator+=(difference_type n) { p_ += n * N; return *this; }
+      iterator& operator-=(difference_type n) { p_ -= n * N; return *this; }
+      iterator operator+(difference_type n) const { return iterator(p_ + n * N); }
+      iterator operator-(difference_type n) const { return iterator(p_ - n * N); }
+      difference_type operator-(const iterator& other) const {
+        return (p_ - other.p_) / difference_type(N);
+      }
+      bool operator==(const iterator& other) const { return p_ == other.p_; }
+      bool operator!=(const iterator& other) const { return p_ != other.p_; }
+      bool operator<(const iterator& other) const { return p_ < other.p_; }
+    private:
+      const T* p_ = nullptr;
+    };
+    using const_iterator = iterator;
+
+    explicit PointFileView(const std::string& path);
+
+    const PointHeader& header() const { return hdr; }
+    size_t size() const { return size_t(hdr.count); }
+    bool empty() const { return hdr.count == 0; }
+    bool hasTimes() const { return times != nullptr; }
+    const T* data() const { return coords; }
+
+    row_type operator[](size_t i) const { return row_type(coords + i * N, N); }
+    std::int64_t time(size_t i) const { return times[i]; }
+    iterator begin() const { return iterator(coords); }
+    iterator end() const { return iterator(coords + size() * N); }
+  private:
+    MappedFile file;
+    PointHeader hdr{};
+    const T* coords = nullptr;
+    const std::int64_t* times = nullptr;
+  };
+  template<typename T, size_t N>
+  PointFileView<T, N>::PointFileView(const std::string& path) : file(path) {
+    static_assert(std::endian::native == std::endian::little,
+      "PointFile reads little-endian hosts only");
+    if(file.size() < sizeof(PointHeader)) {
+      throw "PointFile too small for header";
+    }
+    std::memcpy(&hdr, file.data(), sizeof(hdr));
+    if(std::memcmp(hdr.magic, pointFileMagic, sizeof(hdr.magic)) != 0) {
+      throw "PointFile bad magic";
+    }
+    if(hdr.version == 0 || hdr.version > pointFileVersion) {
+      throw "PointFile unsupported version";
+    }
+    if(hdr.headerSize != sizeof(PointHeader)) {
+      throw "PointFile unexpected header size";
+    }
+    if(hdr.typeCode != pointTypeCode<T>() || hdr.dims != N
+       || hdr.recordSize != N * sizeof(T)) {
+      throw "PointFile holds a different point type";
+    }
+    auto fits = [this](std::uint64_t offset, std::uint64_t record) {
+      return offset <= file.size() && hdr.count <= (file.size() - offset) / record;
+    };
+    if(hdr.dataOffset % alignof(T) != 0 || !fits(hdr.dataOffset, hdr.recordSize)) {
+      throw "PointFile data section out of range";
+    }
+    coords = reinterpret_cast<const T*>(file.data() + hdr.dataOffset);
+    if(hdr.timeOffset != 0) {
+      if(hdr.timeOffset % alignof(std::int64_t) != 0
+         || !fits(hdr.timeOffset, sizeof(std::int64_t))) {
+        throw "PointFile time section out of range";
+      }
+      times = reinterpret_cast<const std::int64_t*>(file.data() + hdr.timeOffset);
+    }
+  }
+}
+/*-- demonstrate writing and mapping a point file --*/
+
+void demo_PointFile() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("binary point file", 45, "\n");
+  std::vector<Point<double, 3>> pts {
+    { 1.0, 2.0, 3.0 }, { 1.5, 2.5, 3.5 }, { -1.0, -2.0, -3.0 }
+  };
+  auto path = (std::filesystem::temp_directory_path() / "bits_demo_points.bin").string();
+  writePointFile(path, pts);
+  {
+    PointFileView<double, 3> view(path);
+    std::cout << "  " << view.size() << " points, version " << view.header().version
+              << ", " << std::filesystem::file_size(path) << " bytes"
+              << (view.hasTimes() ? ", with timestamps" : "");
+    for(auto row : view) {
+      std::cout << "\n  {";
+      for(auto item : row) {
+        std::cout << " " << item;
+      }
+      std::cout << " }";
+    }
+    try {
+      PointFileView<float, 3> wrong(path);
+    }
+    catch(const char* msg) {
+      std::cout << "\n  open as PointFileView<float, 3>: " << msg;
+    }
+  }
+  std::filesystem::remove(path);
+  std::cout << "\n";
+}
+
+/*-- compare binary save and load with text streams --*/
+
+void benchPointFile() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark binary point file vs text", 45, "\n");
+  const size_t count = 1000000;
+  std::vector<Point<double, 3, InlineCoords, EpochStamp>> pts(count);
+  for(size_t i = 0; i < count; ++i) {
+    pts[i][0] = 0.001 * double(i);
+    pts[i][1] = 1.0 / double(i + 1);
+    pts[i][2] = -0.5 * double(i);
+  }
+  stampAll(pts);
+  auto dir = std::filesystem::temp_directory_path();
+  auto binPath = (dir / "bits_bench_points.bin").string();
+  auto txtPath = (dir / "bits_bench_points.txt").string();
+  std::cout << "  " << count << " Point<double, 3> with timestamps";
+
+  Timer tmr;
+  tmr.start();
+  writePointFile(binPath, pts);
+  tmr.stop();
+  size_t binWrite = tmr.elapsedMilliSec();
+
+  tmr.start();
+  double binSum = 0.0;
+  {
+    PointFileView<double, 3> view(binPath);
+    for(auto row : view) {
+      for(auto item : row) {
+        binSum += item;
+      }
+    }
+  }
+  tmr.stop();
+  size_t binRead = tmr.elapsedMilliSec();
+
+  tmr.start();
+  {
+    std::ofstream out(txtPath);
+    out.precision(17);
+    for(auto& pt : pts) {
+      for(auto item : pt) {
+        out << item << ' ';
+      }
+      out << pt.timePoint().time_since_epoch().count() << '\n';
+    }
+  }
+  tmr.stop();
+  size_t txtWrite = tmr.elapsedMilliSec();
+
+  tmr.start();
+  double txtSum = 0.0;
+  {
+    std::ifstream in(txtPath);
+    double x = 0.0, y = 0.0, z = 0.0;
+    long long t = 0;
+    while(in >> x >> y >> z >> t) {
+      txtSum += x;
+      txtSum += y;
+      txtSum += z;
+    }
+  }
+  tmr.stop();
+  size_t txtRead = tmr.elapsedMilliSec();
+
+  std::cout << "\n  binary: write " << binWrite << " ms, map and sum " << binRead
+            << " ms, " << std::filesystem::file_size(binPath) / 1000000 << " MB";
+  std::cout << "\n  text:   write " << txtWrite << " ms, parse and sum " << txtRead
+            << " ms, " << std::filesystem::file_size(txtPath) / 1000000 << " MB";
+  std::cout << "\n  (sums differ by " << binSum - txtSum << ")\n";
+  std::filesystem::remove(binPath);
+  std::filesystem::remove(txtPath);
+}
+#endif
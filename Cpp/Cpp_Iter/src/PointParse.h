@@ -0,0 +1,289 @@
+/*-------------------------------------------------------------------
+  PointParse.h defines multi-threaded text ingestion for Point<T, N>
+  - input is CSV or whitespace separated text, one point per line,
+    taken from memory or from a mapped file
+  - text is split into chunks at line boundaries, one pass counts
+    lines per chunk so every chunk knows where its points go, and a
+    second pass parses chunks on separate threads with from_chars,
+    writing straight into one preallocated vector
+  - malformed lines are skipped and reported by byte offset and
+    line number
+*/
+#ifndef PointParseHeader
+#define PointParseHeader
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Distance.h"
+#include "PointFile.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-----------------------------------------------
+    One rejected line
+    - offset is the byte offset of the line start
+    - line numbers start at 1
+  */
+  struct ParseError {
+    size_t offset;
+    size_t line;
+    std::string reason;
+  };
+  template<typename T, size_t N, typename S, typename P>
+  struct ParseResult {
+    std::vector<Point<T, N, S, P>> points;
+    std::vector<ParseError> errors;
+    size_t lines = 0;                      // lines read, good or bad
+  };
+
+  /*-----------------------------------------------
+    Parse one line of N numbers into out
+    - values are separated by commas, semicolons,
+      spaces, or tabs
+    - returns nullptr on success, else the reason
+  */
+  template<typename T, size_t N>
+  const char* parseLine(const char* p, const char* e, T* out) {
+    auto isSep = [](char c) {
+      return c == ',' || c == ' ' || c == '\t' || c == ';';
+    };
+    for(size_t d = 0; d < N; ++d) {
+      while(p != e && isSep(*p)) {
+        ++p;
+      }
+      if(p == e) {
+        return "too few values";
+      }
+      auto [next, ec] = std::from_chars(p, e, out[d]);
+      if(ec != std::errc() || (next != e && !isSep(*next))) {
+        return "bad number";
+      }
+      p = next;
+    }
+    while(p != e && isSep(*p)) {
+      ++p;
+    }
+    return p == e ? nullptr : "too many values";
+  }
+  /*-----------------------------------------------
+    Blank lines and lines starting with # carry
+    no point and are not errors
+  */
+  inline bool skipLine(const char* p, const char* e) {
+    while(p != e && (*p == ' ' || *p == '\t')) {
+      ++p;
+    }
+    return p == e || *p == '#';
+  }
+
+  /*-------------------------------------------------------------------
+    Parse text into points
+    - threads == 0 uses hardware concurrency
+    - points appear in input order, whatever the thread count
+    - coordinates are written through Point iterators, so the
+      storage mode S and stamp policy P are the caller's choice,
+      NoStamp avoids any per point clock work
+  */
+  template<typename T, size_t N, typename S = InlineCoords, typename P = NoStamp>
+  ParseResult<T, N, S, P> parsePoints(std::string_view text, size_t threads = 0) {
+    ParseResult<T, N, S, P> result;
+    if(threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    /*-- chunk boundaries, each just past a newline --*/
+    const size_t minChunk = 1 << 16;
+    size_t nChunks = std::max<size_t>(1, std::min(threads * 4, text.size() / minChunk));
+    std::vector<size_t> bounds { 0 };
+    for(size_t c = 1; c < nChunks; ++c) {
+      size_t at = std::max(bounds.back(), text.size() * c / nChunks);
+      size_t nl = text.find('\n', at);
+      if(nl == std::string_view::npos) {
+        break;
+      }
+      bounds.push_back(nl + 1);
+    }
+    bounds.push_back(text.size());
+    nChunks = bounds.size() - 1;
+
+    /*-- pass 1: lines per chunk --*/
+    std::vector<size_t> lineCount(nChunks);
+    forEachBlock(nChunks, threads, [&](size_t c) {
+      const char* p = text.data() + bounds[c];
+      const char* e = text.data() + bounds[c + 1];
+      size_t n = size_t(std::count(p, e, '\n'));
+      if(p != e && e[-1] != '\n') {
+        ++n;                              // unterminated last line
+      }
+      lineCount[c] = n;
+    });
+    std::vector<size_t> firstLine(nChunks + 1, 0);
+    for(size_t c = 0; c < nChunks; ++c) {
+      firstLine[c + 1] = firstLine[c] + lineCount[c];
+    }
+    result.lines = firstLine[nChunks];
+    result.points.resize(result.lines);
+
+    /*-- pass 2: parse chunks into their own slots --*/
+    std::vector<size_t> good(nChunks, 0);
+    std::vector<std::vector<ParseError>> errors(nChunks);
+    forEachBlock(nChunks, threads, [&](size_t c) {
+      const char* base = text.data();
+      const char* p = base + bounds[c];
+      const char* end = base + bounds[c + 1];
+      size_t line = firstLine[c];
+      size_t slot = firstLine[c];
+      while(p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        const char* e = nl ? nl : end;
+        const char* le = (e != p && e[-1] == '\r') ? e - 1 : e;
+        ++line;
+        if(!skipLine(p, le)) {
+          T* out = result.points[slot].span().data();
+          const char* reason = parseLine<T, N>(p, le, out);
+          if(reason == nullptr) {
+            ++slot;
+          }
+          else {
+            errors[c].push_back({ size_t(p - base), line, reason });
+          }
+        }
+        p = e + 1;
+      }
+      good[c] = slot - firstLine[c];
+    });
+
+    /*-- close gaps left by skipped lines --*/
+    size_t filled = good[0];
+    for(size_t c = 1; c < nChunks; ++c) {
+      if(filled != firstLine[c]) {
+        std::move(
+          result.points.begin() + firstLine[c],
+          result.points.begin() + firstLine[c] + good[c],
+          result.points.begin() + filled
+        );
+      }
+      filled += good[c];
+    }
+    result.points.resize(filled);
+    for(auto& errs : errors) {
+      result.errors.insert(result.errors.end(), errs.begin(), errs.end());
+    }
+    return result;
+  }
+  /*-----------------------------------------------
+    Parse a text file by mapping it
+  */
+  template<typename T, size_t N, typename S = InlineCoords, typename P = NoStamp>
+  ParseResult<T, N, S, P> parsePointFile(const std::string& path, size_t threads = 0) {
+    MappedFile file(path);
+    std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+    return parsePoints<T, N, S, P>(text, threads);
+  }
+}
+/*-- demonstrate parsing text with malformed lines --*/
+
+void demo_PointParse() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("parse text into points", 45, "\n");
+  std::string text =
+    "# x, y, z\n"
+    "1.0, 2.0, 3.0\n"
+    "1.5 2.5 3.5\r\n"
+    "4.0, oops, 6.0\n"
+    "\n"
+    "7.0, 8.0\n"
+    "-1e3;2.5e1;0.5";
+  auto res = parsePoints<double, 3>(text);
+  std::cout << "  " << res.lines << " lines, " << res.points.size() << " points";
+  for(auto& pt : res.points) {
+    std::cout << "\n  {";
+    for(auto item : pt) {
+      std::cout << " " << item;
+    }
+    std::cout << " }";
+  }
+  for(auto& err : res.errors) {
+    std::cout << "\n  line " << err.line << " at offset " << err.offset
+              << ": " << err.reason;
+  }
+  std::cout << "\n";
+}
+
+/*-- compare chunked from_chars parsing with iostreams --*/
+
+void benchPointParse() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark text ingestion vs iostream", 45, "\n");
+  const size_t count = 2000000;
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+  std::string text;
+  text.reserve(count * 60);
+  char buf[32];
+  for(size_t i = 0; i < count; ++i) {
+    for(size_t d = 0; d < 3; ++d) {
+      auto r = std::to_chars(buf, buf + sizeof(buf), coord(gen));
+      text.append(buf, r.ptr);
+      text.push_back(d < 2 ? ' ' : '\n');
+    }
+  }
+  auto path = (std::filesystem::temp_directory_path() / "bits_bench_points.txt").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(text.data(), std::streamsize(text.size()));
+  }
+  double mb = double(text.size()) / 1.0e6;
+  std::cout << "  " << count << " lines of 3 doubles, " << size_t(mb) << " MB";
+
+  Timer tmr;
+  tmr.start();
+  std::vector<Point<double, 3, InlineCoords, NoStamp>> base;
+  {
+    std::ifstream in(path);
+    double x = 0.0, y = 0.0, z = 0.0;
+    while(in >> x >> y >> z) {
+      base.push_back({ x, y, z });
+    }
+  }
+  tmr.stop();
+  double baseMs = double(tmr.elapsedMicroSec()) / 1000.0;
+  std::cout << "\n  iostream:             " << baseMs << " ms, "
+            << mb / baseMs * 1000.0 << " MB/s";
+
+  std::vector<size_t> threadCounts { 1 };
+  size_t hw = std::thread::hardware_concurrency();
+  if(hw > 1) {
+    threadCounts.push_back(hw);
+  }
+  for(size_t threads : threadCounts) {
+    tmr.start();
+    auto res = parsePointFile<double, 3>(path, threads);
+    tmr.stop();
+    double ms = double(tmr.elapsedMicroSec()) / 1000.0;
+    bool same = res.points.size() == base.size() && res.errors.empty();
+    for(size_t i = 0; same && i < base.size(); ++i) {
+      same = std::equal(base[i].begin(), base[i].end(), res.points[i].begin());
+    }
+    std::cout << "\n  from_chars, " << threads << " thread" << (threads > 1 ? "s: " : ":  ")
+              << ms << " ms, " << mb / ms * 1000.0 << " MB/s"
+              << "  (" << (same ? "matches" : "DIFFERS") << ")";
+  }
+  std::cout << "\n";
+  std::filesystem::remove(path);
+}
+#endif
@@ -0,0 +1,372 @@
+/*-------------------------------------------------------------------
+  PointsConstexpr.h defines StaticPoint<T, N>, a point type usable
+  in constant expressions, and compile-time geometry tables
+  - StaticPoint holds only std::array<T, N>, with no clock or display
+    state, so construction, indexing, arithmetic, and comparison are
+    all constexpr
+  - tables of unit directions, neighbor stencils, and rotations are
+    built by constexpr functions, so they live in read-only data and
+    cost nothing at startup
+  - StaticPoint converts to and from Point<T, N, S, P> at run time
+*/
+#ifndef PointsConstexprHeader
+#define PointsConstexprHeader
+
+#include <iostream>
+#include <string>
+#include <array>
+#include <span>
+#include <cmath>
+#include <compare>
+#include <numbers>
+#include <cstddef>
+#include <initializer_list>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    StaticPoint<T, N> is a literal type with N coordinates
+    - satisfies PointLike, so functions written for Point<T, N>
+      coordinates accept it
+    - comparison is lexicographic over coordinates
+  */
+  template<typename T, size_t N>
+  class StaticPoint {
+  public:
+    using value_type = T;
+    using iterator = typename std::array<T, N>::iterator;
+    using const_iterator = typename std::array<T, N>::const_iterator;
+
+    constexpr StaticPoint() : coord{} {}
+    constexpr StaticPoint(std::initializer_list<T> il) : coord{} {
+      size_t d = 0;
+      for(auto itr = il.begin(); itr != il.end() && d < N; ++itr) {
+        coord[d++] = *itr;
+      }
+    }
+    template<typename S, typename P>
+    explicit StaticPoint(const Point<T, N, S, P>& pt) : coord{} {
+      std::copy(pt.begin(), pt.end(), coord.begin());
+    }
+    template<typename S = InlineCoords, typename P = NoStamp>
+    Point<T, N, S, P> toPoint() const {
+      Point<T, N, S, P> pt;
+      std::copy(coord.begin(), coord.end(), pt.begin());
+      return pt;
+    }
+
+    constexpr size_t size() const { return N; }
+    constexpr T& operator[](size_t i) { return coord[i]; }
+    constexpr const T& operator[](size_t i) const { return coord[i]; }
+    constexpr T& at(size_t i) {
+      if(N <= i) {
+        throw "StaticPoint<T, N> indexing error";
+      }
+      return coord[i];
+    }
+    constexpr const T& at(size_t i) const {
+      if(N <= i) {
+        throw "StaticPoint<T, N> indexing error";
+      }
+      return coord[i];
+    }
+    constexpr std::span<T, N> span() { return coord; }
+    constexpr std::span<const T, N> span() const { return coord; }
+
+    constexpr iterator begin() { return coord.begin(); }
+    constexpr iterator end() { return coord.end(); }
+    constexpr const_iterator begin() const { return coord.begin(); }
+    constexpr const_iterator end() const { return coord.end(); }
+
+    constexpr StaticPoint& operator+=(const StaticPoint& p) {
+      for(size_t d = 0; d < N; ++d) {
+        coord[d] += p.coord[d];
+      }
+      return *this;
+    }
+    constexpr StaticPoint& operator-=(const StaticPoint& p) {
+      for(size_t d = 0; d < N; ++d) {
+        coord[d] -= p.coord[d];
+      }
+      return *this;
+    }
+    constexpr StaticPoint& operator*=(T s) {
+      for(auto& c : coord) {
+        c *= s;
+      }
+      return *this;
+    }
+    constexpr StaticPoint& operator/=(T s) {
+      for(auto& c : coord) {
+        c /= s;
+      }
+      return *this;
+    }
+    friend constexpr StaticPoint operator+(StaticPoint a, const StaticPoint& b) { return a += b; }
+    friend constexpr StaticPoint operator-(StaticPoint a, const StaticPoint& b) { return a -= b; }
+    friend constexpr StaticPoint operator*(StaticPoint a, T s) { return a *= s; }
+    friend constexpr StaticPoint operator*(T s, StaticPoint a) { return a *= s; }
+    friend constexpr StaticPoint operator/(StaticPoint a, T s) { return a /= s; }
+    friend constexpr StaticPoint operator-(StaticPoint a) { return a *= T(-1); }
+
+    friend constexpr bool operator==(const StaticPoint& a, const StaticPoint& b) = default;
+    friend constexpr auto operator<=>(const StaticPoint& a, const StaticPoint& b) = default;
+  private:
+    std::array<T, N> coord;
+  };
+
+  template<typename T, size_t N>
+  constexpr T dot(const StaticPoint<T, N>& a, const StaticPoint<T, N>& b) {
+    T sum = T{0};
+    for(size_t d = 0; d < N; ++d) {
+      sum += a[d] * b[d];
+    }
+    return sum;
+  }
+  template<typename T>
+  constexpr StaticPoint<T, 3> cross(const StaticPoint<T, 3>& a, const StaticPoint<T, 3>& b) {
+    return {
+      a[1] * b[2] - a[2] * b[1],
+      a[2] * b[0] - a[0] * b[2],
+      a[0] * b[1] - a[1] * b[0]
+    };
+  }
+
+  /*-------------------------------------------------------------------
+    Constexpr math
+    - std::sqrt, std::sin, and std::cos are not constexpr in C++20,
+      so tables use these, exact to a few ulps for the ranges used
+  */
+  namespace Const {
+
+    constexpr double sqrt(double x) {
+      if(x <= 0.0) {
+        return 0.0;
+      }
+      double r = x < 1.0 ? 1.0 : x;
+      for(int i = 0; i < 100; ++i) {    // Newton, converges in < 40 steps
+        double next = 0.5 * (r + x / r);
+        if(next == r) {
+          break;
+        }
+        r = next;
+      }
+      return r;
+    }
+    /*-----------------------------------------------
+      Taylor series after reducing x to [-pi, pi]
+    */
+    constexpr double reduce(double x) {
+      constexpr double twoPi = 2.0 * std::numbers::pi;
+      long long k = (long long)(x / twoPi);
+      x -= double(k) * twoPi;
+      if(x > std::numbers::pi) {
+        x -= twoPi;
+      }
+      else if(x < -std::numbers::pi) {
+        x += twoPi;
+      }
+      return x;
+    }
+    constexpr double sin(double x) {
+      x = reduce(x);
+      double term = x, sum = x;
+      for(int n = 1; n < 30; ++n) {
+        term *= -x * x / double((2 * n) * (2 * n + 1));
+        sum += term;
+      }
+      return sum;
+    }
+    constexpr double cos(double x) {
+      x = reduce(x);
+      double term = 1.0, sum = 1.0;
+      for(int n = 1; n < 30; ++n) {
+        term *= -x * x / double((2 * n - 1) * (2 * n));
+        sum += term;
+      }
+      return sum;
+    }
+  }
+
+  template<typename T, size_t N>
+  constexpr T norm(const StaticPoint<T, N>& a) {
+    return T(Const::sqrt(double(dot(a, a))));
+  }
+  template<typename T, size_t N>
+  constexpr StaticPoint<T, N> normalized(const StaticPoint<T, N>& a) {
+    T n = norm(a);
+    return n == T{0} ? a : a / n;
+  }
+
+  /*-------------------------------------------------------------------
+    Compile-time tables
+  */
+
+  /*-----------------------------------------------
+    2N axis directions, +e0, -e0, +e1, -e1, ...
+  */
+  template<typename T, size_t N>
+  constexpr std::array<StaticPoint<T, N>, 2 * N> axisDirections() {
+    std::array<StaticPoint<T, N>, 2 * N> dirs{};
+    for(size_t d = 0; d < N; ++d) {
+      dirs[2 * d][d] = T{1};
+      dirs[2 * d + 1][d] = T{-1};
+    }
+    return dirs;
+  }
+  /*-----------------------------------------------
+    Offsets to the 3^N - 1 neighbors of a grid cell,
+    in odometer order over {-1, 0, 1}^N, center
+    excluded
+  */
+  constexpr size_t pow3(size_t n) {
+    return n == 0 ? 1 : 3 * pow3(n - 1);
+  }
+  template<typename T, size_t N>
+  constexpr std::array<StaticPoint<T, N>, pow3(N) - 1> neighborOffsets() {
+    std::array<StaticPoint<T, N>, pow3(N) - 1> offs{};
+    size_t k = 0;
+    for(size_t code = 0; code < pow3(N); ++code) {
+      StaticPoint<T, N> off;
+      size_t c = code;
+      bool center = true;
+      for(size_t d = 0; d < N; ++d) {
+        off[d] = T(int(c % 3) - 1);
+        center = center && off[d] == T{0};
+        c /= 3;
+      }
+      if(!center) {
+        offs[k++] = off;
+      }
+    }
+    return offs;
+  }
+  /*-----------------------------------------------
+    Unit vectors to all 3^N - 1 neighbors, axis,
+    face diagonal, and corner directions
+  */
+  template<typename T, size_t N>
+  constexpr std::array<StaticPoint<T, N>, pow3(N) - 1> neighborDirections() {
+    auto dirs = neighborOffsets<T, N>();
+    for(auto& dir : dirs) {
+      dir = normalized(dir);
+    }
+    return dirs;
+  }
+
+  /*-----------------------------------------------
+    3x3 rotation, rows are StaticPoints
+  */
+  template<typename T>
+  using Rotation3 = std::array<StaticPoint<T, 3>, 3>;
+
+  template<typename T>
+  constexpr StaticPoint<T, 3> rotate(const Rotation3<T>& m, const StaticPoint<T, 3>& p) {
+    return { dot(m[0], p), dot(m[1], p), dot(m[2], p) };
+  }
+  template<typename T>
+  constexpr Rotation3<T> rotationZ(double angle) {
+    T c = T(Const::cos(angle)), s = T(Const::sin(angle));
+    return {{ { c, -s, T{0} }, { s, c, T{0} }, { T{0}, T{0}, T{1} } }};
+  }
+  /*-----------------------------------------------
+    K rotations about z, by 2 pi k / K
+  */
+  template<typename T, size_t K>
+  constexpr std::array<Rotation3<T>, K> rotationsZ() {
+    std::array<Rotation3<T>, K> rots{};
+    for(size_t k = 0; k < K; ++k) {
+      rots[k] = rotationZ<T>(2.0 * std::numbers::pi * double(k) / double(K));
+    }
+    return rots;
+  }
+}
+/*-- demonstrate StaticPoint and compile-time tables --*/
+
+void demo_StaticPoint() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("constexpr StaticPoint<T, N> and tables", 45, "\n");
+
+  constexpr StaticPoint<int, 3> a { 1, 2, 3 };
+  constexpr StaticPoint<int, 3> b { 4, 5, 6 };
+  constexpr auto c = a + b * 2 - StaticPoint<int, 3>{ 1, 1, 1 };
+  static_assert(c == StaticPoint<int, 3>{ 8, 11, 14 });
+  static_assert(a < b && dot(a, b) == 32);
+  static_assert(cross(a, b) == StaticPoint<int, 3>{ -3, 6, -3 });
+
+  static constexpr auto axes = axisDirections<double, 3>();
+  static constexpr auto stencil = neighborOffsets<int, 3>();
+  static constexpr auto dirs = neighborDirections<double, 2>();
+  static constexpr auto rots = rotationsZ<double, 8>();
+  static_assert(stencil.size() == 26 && axes[3][1] == -1.0);
+
+  auto show = [](const std::string& nm, const auto& p) {
+    std::cout << nm << "{ ";
+    for(auto item : p) {
+      std::cout << item << " ";
+    }
+    std::cout << "}";
+  };
+  show("  c = a + b * 2 - { 1, 1, 1 } = ", c);
+  std::cout << "\n  axis directions in 3D:";
+  for(auto& dir : axes) {
+    show(" ", dir);
+  }
+  std::cout << "\n  " << stencil.size() << " neighbor offsets in 3D, first ";
+  show("", stencil.front());
+  std::cout << ", last ";
+  show("", stencil.back());
+  std::cout << "\n  neighbor directions in 2D:";
+  for(auto& dir : dirs) {
+    show("\n    ", dir);
+  }
+  constexpr StaticPoint<double, 3> x { 1.0, 0.0, 0.0 };
+  show("\n  rots[1] * { 1, 0, 0 } = ", rotate(rots[1], x));
+
+  Point<double, 3> rt = rotate(rots[2], x).toPoint<InlineCoords, TimeStamp>();
+  StaticPoint<double, 3> back(rt);
+  show("\n  to Point and back: ", back);
+  std::cout << "\n";
+}
+
+/*-- compare table lookup with run-time trig --*/
+
+void benchStaticPoint() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark constexpr rotation table", 45, "\n");
+  const size_t count = 4000000;
+  constexpr size_t K = 64;
+  static constexpr auto rots = rotationsZ<double, K>();
+  std::cout << "  " << count << " rotations by one of " << K << " angles";
+
+  StaticPoint<double, 3> p { 1.0, 0.5, 0.25 };
+  Timer tmr;
+  tmr.start();
+  StaticPoint<double, 3> sum1;
+  for(size_t i = 0; i < count; ++i) {
+    double angle = 2.0 * std::numbers::pi * double(i % K) / double(K);
+    double c = std::cos(angle), s = std::sin(angle);
+    sum1 += StaticPoint<double, 3>{ c * p[0] - s * p[1], s * p[0] + c * p[1], p[2] };
+  }
+  tmr.stop();
+  size_t trig = tmr.elapsedMicroSec();
+
+  tmr.start();
+  StaticPoint<double, 3> sum2;
+  for(size_t i = 0; i < count; ++i) {
+    sum2 += rotate(rots[i % K], p);
+  }
+  tmr.stop();
+  size_t table = tmr.elapsedMicroSec();
+  std::cout << "\n  std::sin/cos:     " << trig << " us"
+            << "\n  constexpr table:  " << table << " us"
+            << "  (difference " << norm(sum1 - sum2) << ")\n";
+}
+#endif
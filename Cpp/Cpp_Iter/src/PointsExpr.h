@@ -0,0 +1,353 @@
+/*-------------------------------------------------------------------
+  PointsExpr.h defines lazy arithmetic operators for Point<T, N>
+  and PointCloud<T, N>
+  - a + b * s - c builds a small tree of expression nodes that
+    hold references to their operands; nothing is computed until
+    the tree is assigned to a Point or PointCloud
+  - assignment evaluates the whole tree in one loop per coordinate,
+    so no intermediate points, or heap vectors, are made
+  - points and scalars broadcast over every row of a cloud, so
+    cloud = cloud * scale + offset is one pass over each column
+  - nodes refer to their operands, so an expression should be
+    assigned in the statement that builds it
+*/
+#ifndef PointsExprHeader
+#define PointsExprHeader
+
+#include <iostream>
+#include <string>
+#include <array>
+#include <vector>
+#include <cmath>
+#include <concepts>
+#include <type_traits>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "PointCloud.h"
+#include "Time.h"
+
+namespace Points {
+
+  namespace Expr {
+
+    /*-----------------------------------------------
+      Element operations
+    */
+    struct Add { template<typename T> static T apply(T a, T b) { return a + b; } };
+    struct Sub { template<typename T> static T apply(T a, T b) { return a - b; } };
+    struct Mul { template<typename T> static T apply(T a, T b) { return a * b; } };
+    struct Div { template<typename T> static T apply(T a, T b) { return a / b; } };
+
+    /*-----------------------------------------------
+      Leaves
+      - every node has dims, perRow, value_type,
+        value(d, row), and rows(), 0 rows meaning
+        "broadcast to any row count"
+    */
+    template<typename T, size_t N>
+    class PointLeaf {
+    public:
+      static constexpr size_t dims = N;
+      static constexpr bool perRow = false;
+      using value_type = T;
+      explicit PointLeaf(const T* p) : p_(p) {}
+      T value(size_t d, size_t) const { return p_[d]; }
+      size_t rows() const { return 0; }
+    private:
+      const T* p_;
+    };
+
+    template<typename T, size_t N>
+    class CloudLeaf {
+    public:
+      static constexpr size_t dims = N;
+      static constexpr bool perRow = true;
+      using value_type = T;
+      explicit CloudLeaf(const PointCloud<T, N>& pc) : rows_(pc.size()) {
+        for(size_t d = 0; d < N; ++d) {
+          cols_[d] = pc.column(d).data();
+        }
+      }
+      T value(size_t d, size_t row) const { return cols_[d][row]; }
+      size_t rows() const { return rows_; }
+    private:
+      std::array<const T*, N> cols_;
+      size_t rows_;
+    };
+
+    template<typename T>
+    class ScalarLeaf {
+    public:
+      static constexpr size_t dims = 0;   // matches any N
+      static constexpr bool perRow = false;
+      using value_type = T;
+      explicit ScalarLeaf(T s) : s_(s) {}
+      T value(size_t, size_t) const { return s_; }
+      size_t rows() const { return 0; }
+    private:
+      T s_;
+    };
+
+    /*-----------------------------------------------
+      Interior nodes hold their children by value,
+      children are leaves or nodes, all small
+    */
+    template<typename Op, typename L, typename R>
+    class Binary {
+    public:
+      static constexpr size_t dims = L::dims != 0 ? L::dims : R::dims;
+      static constexpr bool perRow = L::perRow || R::perRow;
+      using value_type = typename L::value_type;
+      static_assert(L::dims == R::dims || L::dims == 0 || R::dims == 0,
+        "Point expression operands differ in dimension");
+
+      Binary(const L& l, const R& r) : l_(l), r_(r), rows_(l.rows()) {
+        if(rows_ == 0) {
+          rows_ = r.rows();
+        }
+        else if(r.rows() != 0 && r.rows() != rows_) {
+          throw "Point expression operands differ in size";
+        }
+      }
+      value_type value(size_t d, size_t row) const {
+        return Op::apply(l_.value(d, row), value_type(r_.value(d, row)));
+      }
+      size_t rows() const { return rows_; }
+    private:
+      L l_;
+      R r_;
+      size_t rows_;
+    };
+
+    template<typename E>
+    class Negate {
+    public:
+      static constexpr size_t dims = E::dims;
+      static constexpr bool perRow = E::perRow;
+      using value_type = typename E::value_type;
+      explicit Negate(const E& e) : e_(e) {}
+      value_type value(size_t d, size_t row) const { return -e_.value(d, row); }
+      size_t rows() const { return e_.rows(); }
+    private:
+      E e_;
+    };
+
+    /*-----------------------------------------------
+      Operand classification and wrapping
+    */
+    template<typename X>
+    struct IsNode : std::false_type {};
+    template<typename Op, typename L, typename R>
+    struct IsNode<Binary<Op, L, R>> : std::true_type {};
+    template<typename E>
+    struct IsNode<Negate<E>> : std::true_type {};
+
+    template<typename X>
+    struct IsPointOrCloud : std::false_type {};
+    template<typename T, size_t N, typename S, typename P>
+    struct IsPointOrCloud<Point<T, N, S, P>> : std::true_type {};
+    template<typename T, size_t N>
+    struct IsPointOrCloud<PointCloud<T, N>> : std::true_type {};
+
+    template<typename X>
+    concept Operand = IsNode<std::remove_cvref_t<X>>::value
+                   || IsPointOrCloud<std::remove_cvref_t<X>>::value;
+
+    template<typename X>
+    concept Scalar = std::is_arithmetic_v<std::remove_cvref_t<X>>;
+
+    template<typename E>
+      requires IsNode<E>::value
+    const E& wrap(const E& e) { return e; }
+
+    template<typename T, size_t N, typename S, typename P>
+    PointLeaf<T, N> wrap(const Point<T, N, S, P>& pt) {
+      return PointLeaf<T, N>(pt.span().data());
+    }
+    template<typename T, size_t N>
+    CloudLeaf<T, N> wrap(const PointCloud<T, N>& pc) {
+      return CloudLeaf<T, N>(pc);
+    }
+
+    template<typename X>
+    using Leaf = std::remove_cvref_t<decltype(wrap(std::declval<const X&>()))>;
+
+    template<typename Op, typename A, typename B>
+    auto make(const A& a, const B& b) {
+      if constexpr(Scalar<A>) {
+        using T = typename Leaf<B>::value_type;
+        return Binary<Op, ScalarLeaf<T>, Leaf<B>>(ScalarLeaf<T>(T(a)), wrap(b));
+      }
+      else if constexpr(Scalar<B>) {
+        using T = typename Leaf<A>::value_type;
+        return Binary<Op, Leaf<A>, ScalarLeaf<T>>(wrap(a), ScalarLeaf<T>(T(b)));
+      }
+      else {
+        return Binary<Op, Leaf<A>, Leaf<B>>(wrap(a), wrap(b));
+      }
+    }
+  }  // namespace Expr
+
+  /*-------------------------------------------------------------------
+    Operators
+    - at least one operand is a Point, a PointCloud, or an
+      expression, the other may also be an arithmetic scalar
+    - element-wise, so a * b is the Hadamard product
+  */
+  template<typename A, typename B>
+    requires (Expr::Operand<A> && (Expr::Operand<B> || Expr::Scalar<B>))
+          || (Expr::Scalar<A> && Expr::Operand<B>)
+  auto operator+(const A& a, const B& b) { return Expr::make<Expr::Add>(a, b); }
+
+  template<typename A, typename B>
+    requires (Expr::Operand<A> && (Expr::Operand<B> || Expr::Scalar<B>))
+          || (Expr::Scalar<A> && Expr::Operand<B>)
+  auto operator-(const A& a, const B& b) { return Expr::make<Expr::Sub>(a, b); }
+
+  template<typename A, typename B>
+    requires (Expr::Operand<A> && (Expr::Operand<B> || Expr::Scalar<B>))
+          || (Expr::Scalar<A> && Expr::Operand<B>)
+  auto operator*(const A& a, const B& b) { return Expr::make<Expr::Mul>(a, b); }
+
+  template<typename A, typename B>
+    requires (Expr::Operand<A> && (Expr::Operand<B> || Expr::Scalar<B>))
+          || (Expr::Scalar<A> && Expr::Operand<B>)
+  auto operator/(const A& a, const B& b) { return Expr::make<Expr::Div>(a, b); }
+
+  template<typename A>
+    requires Expr::Operand<A>
+  auto operator-(const A& a) {
+    return Expr::Negate<Expr::Leaf<A>>(Expr::wrap(a));
+  }
+}
+/*-- demonstrate fused Point and PointCloud arithmetic --*/
+
+void demo_PointExpr() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("expression templates for Point arithmetic", 45, "\n");
+  auto show = [](const std::string& nm, const auto& p) {
+    std::cout << "\n  " << nm << " = { ";
+    for(auto item : p) {
+      std::cout << item << " ";
+    }
+    std::cout << "}";
+  };
+  Point<double, 3> a { 1.0, 2.0, 3.0 };
+  Point<double, 3> b { 0.5, 0.5, 0.5 };
+  Point<double, 3> c { 1.0, 1.0, 1.0 };
+  show("a", a);
+  show("b", b);
+  show("c", c);
+  Point<double, 3> r = a + b * 2.0 - c;
+  show("a + b * 2.0 - c", r);
+  r = -(a - c) / 2.0;
+  show("-(a - c) / 2.0", r);
+  a = a * a;
+  show("a = a * a", a);
+
+  PointCloud<double, 3> cloud;
+  cloud.push_back({ 1.0, 2.0, 3.0 });
+  cloud.push_back({ 4.0, 5.0, 6.0 });
+  Point<double, 3, InlineCoords, NoStamp> offset { 10.0, 20.0, 30.0 };
+  cloud = cloud * 2.0 + offset;
+  std::cout << "\n  cloud = cloud * 2.0 + offset:";
+  for(auto row : cloud) {
+    show("  row", row);
+  }
+  std::cout << "\n";
+}
+
+/*-- compare fused expressions with chained value-returning ops --*/
+
+template<typename S>
+void benchPointExprMode(const std::string& mode, size_t count) {
+  using namespace Points;
+  using Pt = Point<double, 3, S, NoStamp>;
+
+  std::vector<Pt> as(count), bs(count), cs(count), out(count);
+  for(size_t i = 0; i < count; ++i) {
+    as[i] = { double(i), 1.0, 2.0 };
+    bs[i] = { 0.5, double(i % 7), 1.5 };
+    cs[i] = { 1.0, 1.0, double(i % 3) };
+  }
+  const double s = 1.25;
+  Timer tmr;
+
+  /* one temporary point per operation */
+  tmr.start();
+  for(size_t i = 0; i < count; ++i) {
+    Pt t1;
+    for(size_t d = 0; d < 3; ++d) {
+      t1[d] = bs[i][d] * s;
+    }
+    Pt t2;
+    for(size_t d = 0; d < 3; ++d) {
+      t2[d] = as[i][d] + t1[d];
+    }
+    Pt t3;
+    for(size_t d = 0; d < 3; ++d) {
+      t3[d] = t2[d] - cs[i][d];
+    }
+    out[i] = std::move(t3);
+  }
+  tmr.stop();
+  size_t naive = tmr.elapsedMicroSec();
+  double check0 = 0.0;
+  for(auto& pt : out) {
+    check0 += pt[0] + pt[1] + pt[2];
+  }
+
+  tmr.start();
+  for(size_t i = 0; i < count; ++i) {
+    out[i] = as[i] + bs[i] * s - cs[i];
+  }
+  tmr.stop();
+  size_t fused = tmr.elapsedMicroSec();
+  double check1 = 0.0;
+  for(auto& pt : out) {
+    check1 += pt[0] + pt[1] + pt[2];
+  }
+  std::cout << "\n  " << mode << ": temporaries " << naive << " us, fused "
+            << fused << " us  (check " << check0 - check1 << ")";
+}
+void benchPointExpr() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark fused Point expressions", 45, "\n");
+  const size_t count = 1000000;
+  std::cout << "  a + b * s - c over " << count << " points";
+  benchPointExprMode<HeapCoords>("HeapCoords  ", count);
+  benchPointExprMode<InlineCoords>("InlineCoords", count);
+
+  PointCloud<double, 3> cloud;
+  cloud.reserve(count);
+  for(size_t i = 0; i < count; ++i) {
+    cloud.push_back({ double(i), 1.0, 2.0 });
+  }
+  PointCloud<double, 3> copy = cloud;
+  Point<double, 3, InlineCoords, NoStamp> offset { 1.0, -1.0, 0.5 };
+  const double scale = 0.5;
+  Timer tmr;
+  tmr.start();
+  for(auto row : copy) {
+    for(size_t d = 0; d < 3; ++d) {
+      row[d] = row[d] * scale + offset[d];
+    }
+  }
+  tmr.stop();
+  size_t rowWise = tmr.elapsedMicroSec();
+  tmr.start();
+  cloud = cloud * scale + offset;
+  tmr.stop();
+  size_t fused = tmr.elapsedMicroSec();
+  double diff = 0.0;
+  for(size_t d = 0; d < 3; ++d) {
+    diff += columnSum(cloud, d) - columnSum(copy, d);
+  }
+  std::cout << "\n  cloud * scale + offset: row loop " << rowWise << " us, fused "
+            << fused << " us  (check " << diff << ")\n";
+}
+#endif
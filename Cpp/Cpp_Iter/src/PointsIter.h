@@ -2,15 +2,28 @@
   PointsGen.h defines point classe Point<T, N>
   - Point<T, N> represents points with N coordinates of
     unspecified type T and a Time t.
+  - coordinates are held inline by default, or in a heap
+    vector with Point<T, N, HeapCoords>, or in a std::pmr vector
+    drawing on a caller's memory resource with PmrCoords
+  - the timestamp is a full Time by default, a raw epoch count
+    with Point<T, N, S, EpochStamp>, or absent with NoStamp
 */
 #ifndef PointsHeader
 #define PointsHeader
 
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
+#include <algorithm>
 #include <initializer_list>
 #include <concepts>
+#include <chrono>
+#include <span>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include "AnalysisIter.h"
 #include "Time.h"
 
@@ -19,42 +32,191 @@ namespace Points {
   //using namespace Analysis;
   
   /*-------------------------------------------------------------------
-    Point<T, N> class represents a point in an N-Dimensional hyperspace.
-    It uses a template parameter to support a variety of coordinate 
-    types, and uses a vector to hold any finite number of 
-    coordinates, specified by N.
+    Coordinate storage modes for Point<T, N, S>
+    - InlineCoords holds the N coordinates in a std::array inside
+      the point, so constructing or copying a point never touches
+      the heap and indexing needs no pointer indirection.
+    - HeapCoords holds them in a std::vector, the original layout.
+      It is kept for comparison and for code that wants a vector.
+    - PmrCoords holds them in a std::pmr::vector, so a batch of
+      points can draw from an arena or pool memory resource.
+    CoordStorage<T, N, S> maps a mode tag S to its container type
+    and makes a zero-filled container with N elements.
+  */
+  struct InlineCoords {};
+  struct HeapCoords {};
+  struct PmrCoords {};
+
+  template<typename T, size_t N, typename S>
+  struct CoordStorage;
+
+  template<typename T, size_t N>
+  struct CoordStorage<T, N, InlineCoords> {
+    using type = std::array<T, N>;
+    static type make() { return type{}; }
+  };
+  template<typename T, size_t N>
+  struct CoordStorage<T, N, HeapCoords> {
+    using type = std::vector<T>;
+    static type make() { return type(N, T{0}); }  // one allocation
+  };
+  template<typename T, size_t N>
+  struct CoordStorage<T, N, PmrCoords> {
+    using type = std::pmr::vector<T>;
+    static type make() { return type(N, T{0}); }  // default resource
+    static type make(const std::pmr::polymorphic_allocator<T>& a) {
+      return type(N, T{0}, a);
+    }
+  };
 
-    It also carries a Time t instance which conceptually is the time
-    at which something was at that point in space. Time is a class
-    defined for this demonstration in Time.h.
+  /*-------------------------------------------------------------------
+    Timestamp policies for Point<T, N, S, P>
+    - TimeStamp holds a full Time. Construction reads the clock
+      once, the calendar breakdown waits until it is asked for.
+    - EpochStamp holds nanoseconds since the system_clock epoch in
+      an int64_t. Construction leaves it zero, meaning unstamped,
+      and stampAll sets a whole batch from a single clock read.
+    - NoStamp holds nothing, so a point is just its coordinates.
+    StampStorage<P> maps a policy tag P to its stored type and
+    converts between that type and a system_clock time_point.
+  */
+  struct TimeStamp {};
+  struct EpochStamp {};
+  struct NoStamp {};
+
+  template<typename P>
+  struct StampStorage;
+
+  template<>
+  struct StampStorage<TimeStamp> {
+    using type = Time;
+    static type make() { return Time(); }
+    static void set(type& s, std::chrono::time_point<std::chrono::system_clock> tp) {
+      s = Time(tp);
+    }
+    static std::chrono::time_point<std::chrono::system_clock> get(const type& s) {
+      return s.timePoint();
+    }
+  };
+  template<>
+  struct StampStorage<EpochStamp> {
+    using type = std::int64_t;
+    static type make() { return 0; }
+    static void set(type& s, std::chrono::time_point<std::chrono::system_clock> tp) {
+      s = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        tp.time_since_epoch()
+      ).count();
+    }
+    static std::chrono::time_point<std::chrono::system_clock> get(const type& s) {
+      return std::chrono::time_point<std::chrono::system_clock>(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds(s)
+        )
+      );
+    }
+  };
+  template<>
+  struct StampStorage<NoStamp> {
+    struct type {};
+    static type make() { return type{}; }
+    static void set(type&, std::chrono::time_point<std::chrono::system_clock>) {}
+    static std::chrono::time_point<std::chrono::system_clock> get(const type&) {
+      return std::chrono::time_point<std::chrono::system_clock>{};
+    }
+  };
+
+  /*-----------------------------------------------
+    Lazy coordinate expressions, built by the
+    operators in PointsExpr.h
+    - value(d, row) yields coordinate d, per point
+      expressions ignore row
+    - PointExpr is assignable to Point<T, N>,
+      CloudExpr to PointCloud<T, N>
+  */
+  template<typename E, typename T, size_t N>
+  concept CoordExpr = requires(const E& e, size_t d) {
+    { e.value(d, d) } -> std::convertible_to<T>;
+    { e.rows() } -> std::convertible_to<size_t>;
+  } && (E::dims == N);
+
+  template<typename E, typename T, size_t N>
+  concept PointExpr = CoordExpr<E, T, N> && !E::perRow;
+
+  template<typename E, typename T, size_t N>
+  concept CloudExpr = CoordExpr<E, T, N> && E::perRow;
+
+  /*-------------------------------------------------------------------
+    Point<T, N, S> class represents a point in an N-Dimensional 
+    hyperspace. It uses a template parameter to support a variety of 
+    coordinate types, and holds N coordinates, specified at compile
+    time, in storage selected by mode S, InlineCoords by default.
+
+    It also carries a timestamp which conceptually is the time at
+    which something was at that point in space. Policy P selects how
+    it is held, a Time by default. Time is a class defined for this
+    demonstration in Time.h.
 
     All its special members, ctors, assignment, ... with the exception 
     of constructor Point(), are declared default to indicate to a maintainer 
     that compiler generated methods are correct and should not be provided.
 
-    It does not provide an iterator nor begin() and end() members.
-    Those will added in the iteration bit.
+    Indexing follows the standard containers: at() checks and throws,
+    operator[] does not, asserting only in debug builds. span()
+    returns a fixed extent std::span over the coordinates for loops
+    and kernels that want a pointer and a compile-time length.
+
+    It provides iterator types and begin() and end() members, taken 
+    from its coordinate container.
+
+    With PmrCoords it is allocator-aware: the constructors taking a
+    trailing allocator place the coordinates in that allocator's
+    resource, and std::pmr containers of points pass theirs down.
+    Plain copy construction uses the default resource, as for any
+    std::pmr container.
   */
-  template<typename T, const size_t N>
+  template<
+    typename T, const size_t N,
+    typename S = InlineCoords, typename P = TimeStamp
+  >
   class Point {
   public:
-    using iterator = typename std::vector<T>::iterator;
-    using const_iterator = typename std::vector<T>::const_iterator;
+    using coord_type = typename CoordStorage<T, N, S>::type;
+    using stamp_type = typename StampStorage<P>::type;
+    using iterator = typename coord_type::iterator;
+    using const_iterator = typename coord_type::const_iterator;
     using value_type = T;
+    using pmr_allocator = std::pmr::polymorphic_allocator<T>;
     
     Point();                                      // default ctor
     Point(std::initializer_list<T> il);           // construct from list
+    explicit Point(const pmr_allocator& a)        // PmrCoords ctors
+      requires std::same_as<S, PmrCoords>;
+    Point(std::initializer_list<T> il, const pmr_allocator& a)
+      requires std::same_as<S, PmrCoords>;
+    Point(const Point& pt, const pmr_allocator& a)
+      requires std::same_as<S, PmrCoords>;
+    Point(Point&& pt, const pmr_allocator& a)
+      requires std::same_as<S, PmrCoords>;
+    template<typename E>
+      requires PointExpr<E, T, N>
+    Point(const E& e);                            // evaluate expression
     Point(const Point& pt) = default;             // copy ctor
     Point(Point&& pt) = default;                  // move ctor
     Point& operator=(const Point& pt) = default;  // copy assignment
     Point& operator=(Point&& pt) = default;       // move assignemnt
+    template<typename E>
+      requires PointExpr<E, T, N>
+    Point& operator=(const E& e);                 // fused assignment
     ~Point() = default;                           // dtor
 
     void init(const std::vector<T>& v);
 
     std::string timeToString();
     void updateTime();
-    Time& time();
+    void stamp(time_point<system_clock> tp);
+    time_point<system_clock> timePoint() const;
+    Time& time() requires std::same_as<P, TimeStamp>;
+    const Time& time() const requires std::same_as<P, TimeStamp>;
     const size_t size() const;
 
     iterator begin();
@@ -62,94 +224,162 @@ namespace Points {
     const_iterator begin() const;
     const_iterator end() const;
 
-    T& operator[](size_t index);                  // index oper
-    const T operator[](size_t index) const;       // const index oper
+    T& at(size_t index);                          // checked index
+    const T& at(size_t index) const;
+    T& operator[](size_t index);                  // unchecked index oper
+    const T& operator[](size_t index) const;      // const index oper
+
+    std::span<T, N> span();                       // view of coordinates
+    std::span<const T, N> span() const;
     
-    std::vector<T>& coords() { return coord; }    // accessor
+    coord_type& coords() { return coord; }        // accessor
 
     void show(const std::string& name);           // display contents
     size_t& left() { return _left; }              // display indent
     size_t& width() { return _width; }            // display width
   private:
-    std::vector<T> coord;
-    Time tm;
+    coord_type coord;
+    [[no_unique_address]] stamp_type tm;
     size_t _left = 2;   // default display indent
     size_t _width = 7;  // default display row width
   };
   /*-----------------------------------------------
-    Point<T, N> constructor with size Template
+    Point<T, N, S, P> constructor with size Template
     parameter
+    - coordinates are zero-filled by CoordStorage
+    - timestamp is made by StampStorage
   */
-  template<typename T, size_t N>
-  Point<T, N>::Point() 
-    : tm(Time()) {
-    for(size_t i=0; i<N; i++) {
-      coord.push_back(T{0});
-    }
-  }
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point() 
+    : coord(CoordStorage<T, N, S>::make()), tm(StampStorage<P>::make()) {}
   /*-----------------------------------------------
     Fill coor with elements from initializer list li
     - if li is smaller than N then fill remainder with 
       default values of T
     - if li is larger use first N elements of li
   */
-  template<typename T, size_t N>
-  Point<T, N>::Point(std::initializer_list<T> il) 
-    : tm(Time()) {
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point(std::initializer_list<T> il) 
+    : coord(CoordStorage<T, N, S>::make()), tm(StampStorage<P>::make()) {
     size_t sz = std::min(N, il.size());
-    size_t i = 0;
-    for(auto item : il) {
-      coord.push_back(item);
-      if(++i == sz) {
-        break;
-      }
-    }
-    for(size_t i = il.size(); i<N; i++) {
-      coord.push_back(T{0});
+    std::copy_n(il.begin(), sz, coord.begin());
+  }
+  /*-----------------------------------------------
+    PmrCoords constructors, coordinates come from
+    a's memory resource
+  */
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point(const pmr_allocator& a)
+    requires std::same_as<S, PmrCoords>
+    : coord(CoordStorage<T, N, S>::make(a)), tm(StampStorage<P>::make()) {}
+
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point(std::initializer_list<T> il, const pmr_allocator& a)
+    requires std::same_as<S, PmrCoords>
+    : coord(CoordStorage<T, N, S>::make(a)), tm(StampStorage<P>::make()) {
+    size_t sz = std::min(N, il.size());
+    std::copy_n(il.begin(), sz, coord.begin());
+  }
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point(const Point& pt, const pmr_allocator& a)
+    requires std::same_as<S, PmrCoords>
+    : coord(pt.coord, a), tm(pt.tm), _left(pt._left), _width(pt._width) {}
+
+  template<typename T, size_t N, typename S, typename P>
+  Point<T, N, S, P>::Point(Point&& pt, const pmr_allocator& a)
+    requires std::same_as<S, PmrCoords>
+    : coord(std::move(pt.coord), a), tm(std::move(pt.tm)),
+      _left(pt._left), _width(pt._width) {}
+  /*-----------------------------------------------
+    Evaluate a coordinate expression in one loop
+    over N, with no intermediate points
+    - each coordinate reads only the same index of
+      its operands, so p = p + q is safe
+    - assignment keeps the existing timestamp
+  */
+  template<typename T, size_t N, typename S, typename P>
+  template<typename E>
+    requires PointExpr<E, T, N>
+  Point<T, N, S, P>::Point(const E& e)
+    : coord(CoordStorage<T, N, S>::make()), tm(StampStorage<P>::make()) {
+    *this = e;
+  }
+  template<typename T, size_t N, typename S, typename P>
+  template<typename E>
+    requires PointExpr<E, T, N>
+  Point<T, N, S, P>& Point<T, N, S, P>::operator=(const E& e) {
+    T* out = coord.data();
+    for(size_t d = 0; d < N; ++d) {
+      out[d] = T(e.value(d, 0));
     }
+    return *this;
   }
   /*---------------------------------------------
     Always returns N
   */
-  template<typename T, size_t N>
-  const size_t Point<T, N>::size() const {
+  template<typename T, size_t N, typename S, typename P>
+  const size_t Point<T, N, S, P>::size() const {
     return coord.size();
   }
   /*---------------------------------------------
-    index returns mutable value
+    at() checks index and throws if out of range
   */
-  template<typename T, size_t N>
-  T& Point<T, N>::operator[](size_t index) {
-    if (index < 0 || coord.size() <= index) {
+  template<typename T, size_t N, typename S, typename P>
+  T& Point<T, N, S, P>::at(size_t index) {
+    if (N <= index) {
       throw "Point<T, N> indexing error";
     }
     return coord[index];
   }
-  /*---------------------------------------------
-    index returns immutable value
-  */
-  template<typename T, size_t N>
-  const T Point<T, N>::operator[](size_t index) const {
-    if (index < 0 || coord.len() <= index) {
+  template<typename T, size_t N, typename S, typename P>
+  const T& Point<T, N, S, P>::at(size_t index) const {
+    if (N <= index) {
       throw "Point<T, N> indexing error";
     }
     return coord[index];
   }
+  /*---------------------------------------------
+    operator[] does not check, as for std::array,
+    so hot loops pay nothing per access
+    - debug builds assert on the index
+  */
+  template<typename T, size_t N, typename S, typename P>
+  T& Point<T, N, S, P>::operator[](size_t index) {
+    assert(index < N);
+    return coord[index];
+  }
+  template<typename T, size_t N, typename S, typename P>
+  const T& Point<T, N, S, P>::operator[](size_t index) const {
+    assert(index < N);
+    return coord[index];
+  }
+  /*---------------------------------------------
+    Fixed extent view of the N coordinates, which
+    are contiguous in every storage mode
+  */
+  template<typename T, size_t N, typename S, typename P>
+  std::span<T, N> Point<T, N, S, P>::span() {
+    return std::span<T, N>(coord.data(), N);
+  }
+  template<typename T, size_t N, typename S, typename P>
+  std::span<const T, N> Point<T, N, S, P>::span() const {
+    return std::span<const T, N>(coord.data(), N);
+  }
 
-  template<typename T, const size_t N>
-  typename Point<T, N>::iterator Point<T, N>::begin() {
+  template<typename T, const size_t N, typename S, typename P>
+  typename Point<T, N, S, P>::iterator Point<T, N, S, P>::begin() {
     return coord.begin();
   }
-  template<typename T, const size_t N>
-  typename Point<T, N>::iterator Point<T, N>::end() {
+  template<typename T, const size_t N, typename S, typename P>
+  typename Point<T, N, S, P>::iterator Point<T, N, S, P>::end() {
     return coord.end();
   }
-  template<typename T, const size_t N>
-  typename Point<T, N>::const_iterator Point<T, N>::begin() const {
+  template<typename T, const size_t N, typename S, typename P>
+  typename Point<T, N, S, P>::const_iterator Point<T, N, S, P>::begin() const {
     return coord.begin();
   }
-  template<typename T, const size_t N>
-  typename Point<T, N>::const_iterator Point<T, N>::end() const {
+  template<typename T, const size_t N, typename S, typename P>
+  typename Point<T, N, S, P>::const_iterator Point<T, N, S, P>::end() const {
     return coord.end();
   }
 
@@ -159,8 +389,8 @@ namespace Points {
       values of T
     - if v is larger use first N elements of v
   */
-  template<typename T, size_t N>
-  void Point<T, N>::init(const std::vector<T>& v) {
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::init(const std::vector<T>& v) {
     size_t sz = std::min(N, v.size());
     for(size_t i=0; i<sz; i++) {
       coord[i] = v[i];
@@ -171,50 +401,106 @@ namespace Points {
   }
   /*---------------------------------------------
     returns string datetime
+    - EpochStamp builds a temporary Time, so call
+      this for display, not in bulk
   */
-  template<typename T, size_t N>
-  std::string Point<T, N>::timeToString() {
-    std::string ts = tm.toString();
-    return ts;
+  template<typename T, size_t N, typename S, typename P>
+  std::string Point<T, N, S, P>::timeToString() {
+    if constexpr(std::same_as<P, TimeStamp>) {
+      return tm.toString();
+    }
+    else if constexpr(std::same_as<P, EpochStamp>) {
+      return Time(timePoint()).toString();
+    }
+    else {
+      return "no timestamp";
+    }
   }
   /*---------------------------------------------
     set time to current time
   */
-  template<typename T, size_t N>
-  void Point<T, N>::updateTime() {
-    tm = std::time(0);
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::updateTime() {
+    StampStorage<P>::set(tm, system_clock::now());
   }
   /*---------------------------------------------
-    returns current number of seconds in clock's 
-    epoch
+    set time to tp, e.g., one clock read shared
+    by a batch of points
   */
-  template<typename T, size_t N>
-  Time& Point<T, N>::time() {
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::stamp(time_point<system_clock> tp) {
+    StampStorage<P>::set(tm, tp);
+  }
+  template<typename T, size_t N, typename S, typename P>
+  time_point<system_clock> Point<T, N, S, P>::timePoint() const {
+    return StampStorage<P>::get(tm);
+  }
+  /*---------------------------------------------
+    returns Time instance, only for TimeStamp
+    policy
+  */
+  template<typename T, size_t N, typename S, typename P>
+  Time& Point<T, N, S, P>::time() requires std::same_as<P, TimeStamp> {
+    return tm;
+  }
+  template<typename T, size_t N, typename S, typename P>
+  const Time& Point<T, N, S, P>::time() const requires std::same_as<P, TimeStamp> {
     return tm;
   }
   /*-----------------------------------------------
     PointtN<T> display function 
   */
-  template<typename T, size_t N>
-  void Point<T, N>::show(const std::string& name) {
+  template<typename T, size_t N, typename S, typename P>
+  void Point<T, N, S, P>::show(const std::string& name) {
     std::cout << "\n" << indent(_left) << name << ": " << "Point<T, N>";
     std::cout << " {\n";
     std::cout << fold(coord, _left + 2, _width);
     std::cout << indent(_left) << "}";
-    std::cout << "\n" << indent(_left) << tm.toString() << std::endl;
+    std::cout << "\n" << indent(_left) << timeToString() << std::endl;
   }
   /*-----------------------------------------------
     Overload operator<< required for 
     showType(Point<T, N> t, const std::string& nm) 
   */
-  template<typename T, size_t N>
-  std::ostream& operator<<(std::ostream& out, Point<T, N>& t2) {
+  template<typename T, size_t N, typename S, typename P>
+  std::ostream& operator<<(std::ostream& out, Point<T, N, S, P>& t2) {
     out << "\n" << indent(t2.left()) << "Point<T, N>";
     out << " {\n";
     out << fold(t2.coords(), t2.left() + 2, t2.width());
     out << indent(t2.left()) << "}";
     return out;
   }
+  /*-----------------------------------------------
+    Stamp every point in pts with one clock read
+    - pts is any range of Point<T, N, S, P>
+  */
+  template<typename R>
+  void stampAll(R& pts, time_point<system_clock> tp = system_clock::now()) {
+    for(auto& pt : pts) {
+      pt.stamp(tp);
+    }
+  }
+  /*-----------------------------------------------
+    PointLike is satisfied by Point<T, N, S> and by
+    proxies like PointCloud's PointRef that index and
+    iterate over N coordinates
+  */
+  template<typename P>
+  concept PointLike = requires(const P& p) {
+    p.begin();
+    p.end();
+    p.size();
+    p[0];
+  };
+}
+/*-----------------------------------------------
+  PmrCoords points are constructed with their
+  container's allocator by std::pmr containers
+*/
+namespace std {
+  template<typename T, size_t N, typename P, typename A>
+  struct uses_allocator<Points::Point<T, N, Points::PmrCoords, P>, A>
+    : is_convertible<A, pmr::polymorphic_allocator<T>> {};
 }
 /*-- demonstrate iteration over Point type --*/
 
@@ -251,9 +537,171 @@ void demo_custom_type_Point_iteration() {
   }
   std::cout << std::endl;
 
+  showOp("iteration over span view", "\n");
+  for(auto item : p1.span()) {
+    std::cout << item << " ";
+  }
+  std::cout << std::endl;
+
+  showOp("checked indexing with at()", "\n");
+  try {
+    p1.at(p1.size()) = 0;
+  }
+  catch(const char* msg) {
+    std::cout << "p1.at(" << p1.size() << ") threw \"" << msg << "\"\n";
+  }
+
   showOp("Point<int, 10> p2 { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }");
   Point<int, 10> p2 { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
   p2.left() = 0;
   p2.show("p2");
 }
+/*-- compare cost of Point storage modes --*/
+
+template<typename S>
+void benchPointStorageMode(const std::string& mode, size_t count) {
+  using namespace Points;
+
+  Timer tmr;
+  tmr.start();
+  std::vector<Point<double, 3, S>> pts;
+  pts.reserve(count);
+  for(size_t i = 0; i < count; ++i) {
+    pts.push_back(Point<double, 3, S> { 1.0, 2.0, 3.0 });
+  }
+  tmr.stop();
+  size_t construct = tmr.elapsedMicroSec();
+
+  tmr.start();
+  std::vector<Point<double, 3, S>> cpy = pts;
+  tmr.stop();
+  size_t copy = tmr.elapsedMicroSec();
+
+  tmr.start();
+  double sum = 0.0;
+  for(auto& pt : cpy) {
+    for(auto item : pt) {
+      sum += item;
+    }
+  }
+  tmr.stop();
+  size_t iterate = tmr.elapsedMicroSec();
+
+  std::cout << "\n  " << mode << ": sizeof = " << sizeof(Point<double, 3, S>)
+            << ", construct = " << construct << " us"
+            << ", copy = " << copy << " us"
+            << ", iterate = " << iterate << " us"
+            << "  (sum = " << sum << ")";
+}
+void benchPointStorage() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark Point<double, 3> storage modes", 45, "\n");
+  const size_t count = 1000000;
+  std::cout << "  " << count << " points";
+  benchPointStorageMode<HeapCoords>("HeapCoords  ", count);
+  benchPointStorageMode<InlineCoords>("InlineCoords", count);
+  std::cout << "\n";
+}
+/*-- compare cost of Point timestamp policies --*/
+
+template<typename P>
+void benchPointStampMode(const std::string& mode, size_t count) {
+  using namespace Points;
+
+  Timer tmr;
+  tmr.start();
+  std::vector<Point<double, 3, InlineCoords, P>> pts;
+  pts.reserve(count);
+  for(size_t i = 0; i < count; ++i) {
+    pts.push_back(Point<double, 3, InlineCoords, P> { 1.0, 2.0, 3.0 });
+  }
+  tmr.stop();
+  size_t construct = tmr.elapsedMicroSec();
+
+  tmr.start();
+  std::vector<Point<double, 3, InlineCoords, P>> cpy = pts;
+  tmr.stop();
+  size_t copy = tmr.elapsedMicroSec();
+
+  tmr.start();
+  stampAll(cpy);
+  tmr.stop();
+  size_t stamp = tmr.elapsedMicroSec();
+
+  std::cout << "\n  " << mode << ": sizeof = " 
+            << sizeof(Point<double, 3, InlineCoords, P>)
+            << ", construct = " << construct << " us"
+            << ", copy = " << copy << " us"
+            << ", stampAll = " << stamp << " us";
+}
+void benchPointStamp() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark Point<double, 3> timestamp policies", 45, "\n");
+  const size_t count = 1000000;
+  std::cout << "  " << count << " points";
+  benchPointStampMode<TimeStamp>("TimeStamp ", count);
+  benchPointStampMode<EpochStamp>("EpochStamp", count);
+  benchPointStampMode<NoStamp>("NoStamp   ", count);
+  std::cout << "\n";
+}
+/*-- compare checked, unchecked, and span coordinate access --*/
+
+void benchPointIndexing() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark Point<double, 3> indexing", 45, "\n");
+  const size_t count = 1000000, passes = 20;
+  std::vector<Point<double, 3, InlineCoords, NoStamp>> pts(count);
+  for(size_t i = 0; i < count; ++i) {
+    pts[i] = { double(i), 0.5, -1.0 };
+  }
+  std::cout << "  " << passes << " passes over " << count << " points";
+  Timer tmr;
+  auto report = [&](const std::string& name, double sum) {
+    std::cout << "\n  " << name << ": " << tmr.elapsedMicroSec() << " us"
+              << "  (sum = " << sum << ")";
+  };
+
+  double sum = 0.0;
+  tmr.start();
+  for(size_t r = 0; r < passes; ++r) {
+    for(auto& pt : pts) {
+      for(size_t d = 0; d < 3; ++d) {
+        sum += pt.at(d);
+      }
+    }
+  }
+  tmr.stop();
+  report("at()      ", sum);
+
+  sum = 0.0;
+  tmr.start();
+  for(size_t r = 0; r < passes; ++r) {
+    for(auto& pt : pts) {
+      for(size_t d = 0; d < 3; ++d) {
+        sum += pt[d];
+      }
+    }
+  }
+  tmr.stop();
+  report("operator[]", sum);
+
+  sum = 0.0;
+  tmr.start();
+  for(size_t r = 0; r < passes; ++r) {
+    for(auto& pt : pts) {
+      for(double v : pt.span()) {
+        sum += v;
+      }
+    }
+  }
+  tmr.stop();
+  report("span()    ", sum);
+  std::cout << "\n";
+}
 #endif
\ No newline at end of file
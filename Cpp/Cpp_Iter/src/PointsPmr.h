@@ -0,0 +1,231 @@
+/*-------------------------------------------------------------------
+  PointsPmr.h defines arena and pool support for Point<T, N, PmrCoords>
+  - PointArena builds a batch of points from a monotonic buffer and
+    gives all their memory back at once
+  - pointPoolOptions tunes std::pmr pool resources for blocks the
+    size of one point's coordinates
+  - CountingResource wraps another resource and counts its calls,
+    used here to compare allocation counts with the global heap
+*/
+#ifndef PointsPmrHeader
+#define PointsPmrHeader
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <memory_resource>
+#include <initializer_list>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    CountingResource forwards to upstream and counts allocations,
+    deallocations, and bytes requested
+  */
+  class CountingResource : public std::pmr::memory_resource {
+  public:
+    explicit CountingResource(
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+    ) : _upstream(upstream) {}
+    size_t allocations() const { return _allocs; }
+    size_t deallocations() const { return _deallocs; }
+    size_t bytes() const { return _bytes; }
+    void resetCounts() { _allocs = _deallocs = _bytes = 0; }
+  private:
+    void* do_allocate(size_t n, size_t align) override {
+      ++_allocs;
+      _bytes += n;
+      return _upstream->allocate(n, align);
+    }
+    void do_deallocate(void* p, size_t n, size_t align) override {
+      ++_deallocs;
+      _upstream->deallocate(p, n, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+    std::pmr::memory_resource* _upstream;
+    size_t _allocs = 0;
+    size_t _deallocs = 0;
+    size_t _bytes = 0;
+  };
+
+  /*-----------------------------------------------
+    Pool options for point-sized blocks
+    - a coordinate vector of up to 8 doubles is one
+      64 byte block, larger requests go upstream
+    - chunks hold up to 4096 blocks so refills are
+      rare for large batches
+  */
+  inline std::pmr::pool_options pointPoolOptions() {
+    std::pmr::pool_options opts;
+    opts.largest_required_pool_block = 64;
+    opts.max_blocks_per_chunk = 4096;
+    return opts;
+  }
+
+  /*-------------------------------------------------------------------
+    PointArena<T, N, P> holds a short-lived batch of points
+    - points and their coordinates come from one monotonic buffer,
+      so each allocation is a pointer bump
+    - reset() drops the batch and returns every block to upstream
+      in one step, keeping the initial buffer for the next batch
+  */
+  template<typename T, const size_t N, typename P = NoStamp>
+  class PointArena {
+  public:
+    using point_type = Point<T, N, PmrCoords, P>;
+
+    explicit PointArena(
+      size_t initialBytes = 1 << 16,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+    );
+    PointArena(const PointArena& pa) = delete;
+    PointArena& operator=(const PointArena& pa) = delete;
+    ~PointArena() = default;
+
+    point_type& add(std::initializer_list<T> il);
+    void reserve(size_t n) { pts.reserve(n); }
+    void reset();
+
+    size_t size() const { return pts.size(); }
+    std::pmr::vector<point_type>& points() { return pts; }
+    std::pmr::memory_resource* resource() { return &arena; }
+  private:
+    std::vector<std::byte> initial;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<point_type> pts;   // declared last, destroyed first
+  };
+  template<typename T, size_t N, typename P>
+  PointArena<T, N, P>::PointArena(
+    size_t initialBytes, std::pmr::memory_resource* upstream
+  ) : initial(initialBytes),
+      arena(initial.data(), initial.size(), upstream),
+      pts(&arena) {}
+  /*-----------------------------------------------
+    Append a point, its coordinates also come from
+    the arena
+  */
+  template<typename T, size_t N, typename P>
+  typename PointArena<T, N, P>::point_type& PointArena<T, N, P>::add(
+    std::initializer_list<T> il
+  ) {
+    return pts.emplace_back(il);
+  }
+  /*-----------------------------------------------
+    Destroy the points, then release arena memory
+    - the swap drops pts' buffer before release, so
+      no live object refers into released blocks
+  */
+  template<typename T, size_t N, typename P>
+  void PointArena<T, N, P>::reset() {
+    std::pmr::vector<point_type>(&arena).swap(pts);
+    arena.release();
+  }
+}
+/*-- demonstrate Point batches on arena and pool resources --*/
+
+void demo_PointPmr() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("Point<T, N, PmrCoords> on arena and pool", 45, "\n");
+  CountingResource heap;
+  PointArena<double, 3> batch(256, &heap);
+  for(size_t i = 0; i < 100; ++i) {
+    batch.add({ double(i), 1.0, 2.0 });
+  }
+  auto& first = batch.points().front();
+  std::cout << "  arena: " << batch.size() << " points, coordinates in arena: "
+            << (first.coords().get_allocator().resource() == batch.resource() ? "yes" : "no")
+            << ", upstream allocations " << heap.allocations();
+  batch.reset();
+  std::cout << "\n  after reset: " << batch.size() << " points, upstream deallocations "
+            << heap.deallocations();
+
+  CountingResource poolHeap;
+  {
+    std::pmr::unsynchronized_pool_resource pool(pointPoolOptions(), &poolHeap);
+    std::pmr::vector<Point<double, 3, PmrCoords, NoStamp>> pts(&pool);
+    for(size_t i = 0; i < 100; ++i) {
+      pts.emplace_back()[0] = double(i);
+    }
+    std::cout << "\n  pool:  " << pts.size() << " points, upstream allocations "
+              << poolHeap.allocations();
+  }
+  std::cout << "\n";
+}
+
+/*-- compare batch build and release on heap, arena, and pool --*/
+
+void benchPointPmr() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark Point batches: heap vs arena vs pool", 45, "\n");
+  const size_t batch = 10000, rounds = 200;
+  std::cout << "  " << rounds << " batches of " << batch << " Point<double, 3>";
+
+  auto report = [&](const std::string& name, size_t us, size_t allocs) {
+    std::cout << "\n  " << name << ": " << double(us) / rounds << " us/batch, "
+              << double(allocs) / rounds << " allocations/batch";
+  };
+  Timer tmr;
+  double check = 0.0;
+
+  /*-- global heap, one coordinate vector per point, counted --*/
+  CountingResource globalHeap(std::pmr::new_delete_resource());
+  tmr.start();
+  for(size_t r = 0; r < rounds; ++r) {
+    std::pmr::vector<Point<double, 3, PmrCoords, NoStamp>> pts(&globalHeap);
+    pts.reserve(batch);
+    for(size_t i = 0; i < batch; ++i) {
+      auto& pt = pts.emplace_back();
+      pt[0] = double(i); pt[1] = 1.0; pt[2] = 2.0;
+    }
+    check += pts.back()[0];
+  }
+  tmr.stop();
+  report("global heap     ", tmr.elapsedMicroSec(), globalHeap.allocations());
+
+  /*-- monotonic arena, released in one step per batch --*/
+  CountingResource arenaHeap;
+  {
+    PointArena<double, 3> arena(1 << 20, &arenaHeap);
+    tmr.start();
+    for(size_t r = 0; r < rounds; ++r) {
+      arena.reserve(batch);
+      for(size_t i = 0; i < batch; ++i) {
+        arena.add({ double(i), 1.0, 2.0 });
+      }
+      check += arena.points().back()[0];
+      arena.reset();
+    }
+    tmr.stop();
+  }
+  report("monotonic arena ", tmr.elapsedMicroSec(), arenaHeap.allocations());
+
+  /*-- pool, blocks recycled through free lists --*/
+  CountingResource poolHeap;
+  {
+    std::pmr::unsynchronized_pool_resource pool(pointPoolOptions(), &poolHeap);
+    tmr.start();
+    for(size_t r = 0; r < rounds; ++r) {
+      std::pmr::vector<Point<double, 3, PmrCoords, NoStamp>> pts(&pool);
+      pts.reserve(batch);
+      for(size_t i = 0; i < batch; ++i) {
+        auto& pt = pts.emplace_back();      // coordinates from pts' resource
+        pt[0] = double(i); pt[1] = 1.0; pt[2] = 2.0;
+      }
+      check += pts.back()[0];
+    }
+    tmr.stop();
+  }
+  report("pool resource   ", tmr.elapsedMicroSec(), poolHeap.allocations());
+  std::cout << "\n  (allocations reaching the global heap, check " << check << ")\n";
+}
+#endif
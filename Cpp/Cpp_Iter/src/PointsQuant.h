@@ -0,0 +1,479 @@
+/*-------------------------------------------------------------------
+  PointsQuant.h defines QuantizedCloud<Q, N>, a compact columnar
+  point set for coordinates with bounded range
+  - each coordinate is stored as a 16 or 32 bit unsigned fixed
+    point value q, decoded as offset[d] + scale[d] * q
+  - offset and scale are per set and per dimension, chosen from
+    the range of the points, so decode error is at most half of
+    scale[d]
+  - no time is stored; a 3 dimensional point takes 6 or 12 bytes,
+    against 24 bytes of coordinates plus a stamp for Point<double, 3>
+  - iterators and the block kernels decode on the fly, so data
+    stays compact in cache and is never expanded as a whole
+*/
+#ifndef PointsQuantHeader
+#define PointsQuantHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+#include <concepts>
+#include <random>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "PointCloud.h"
+#include "Bounds.h"
+#include "Time.h"
+
+namespace Points {
+
+  template<typename Q>
+  concept QuantWord = std::same_as<Q, std::uint16_t> || std::same_as<Q, std::uint32_t>;
+
+  template<QuantWord Q, size_t N>
+  class QuantizedCloud;
+
+  /*-------------------------------------------------------------------
+    QuantRef<Q, N> is a read-only proxy for one row of a cloud
+    - operator[] and its coordinate iterator return decoded doubles
+      by value, so range-for and indexing work as for Point<double, N>
+  */
+  template<QuantWord Q, size_t N>
+  class QuantRef {
+  public:
+    using value_type = double;
+
+    class iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = double;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = double;
+
+      iterator() = default;
+      iterator(const QuantizedCloud<Q, N>* qc, size_t row, size_t dim)
+        : qc_(qc), row_(row), dim_(dim) {}
+      double operator*() const { return qc_->value(row_, dim_); }
+      double operator[](difference_type n) const { return qc_->value(row_, dim_ + n); }
+      iterator& operator++() { ++dim_; return *this; }
+      iterator operator++(int) { iterator tmp = *this; ++dim_; return tmp; }
+      iterator& operator--() { --dim_; return *this; }
+      iterator operator--(int) { iterator tmp = *this; --dim_; return tmp; }
+      iterator& operator+=(difference_type n) { dim_ += n; return *this; }
+      iterator& operator-=(difference_type n) { dim_ -= n; return *this; }
+      iterator operator+(difference_type n) const { return iterator(qc_, row_, dim_ + n); }
+      iterator operator-(difference_type n) const { return iterator(qc_, row_, dim_ - n); }
+      difference_type operator-(const iterator& other) const {
+        return difference_type(dim_) - difference_type(other.dim_);
+      }
+      bool operator==(const iterator& other) const { return dim_ == other.dim_; }
+      bool operator!=(const iterator& other) const { return dim_ != other.dim_; }
+      bool operator<(const iterator& other) const { return dim_ < other.dim_; }
+    private:
+      const QuantizedCloud<Q, N>* qc_ = nullptr;
+      size_t row_ = 0;
+      size_t dim_ = 0;
+    };
+    using const_iterator = iterator;
+
+    QuantRef(const QuantizedCloud<Q, N>* qc, size_t row) : qc_(qc), row_(row) {}
+
+    size_t size() const { return N; }
+    size_t row() const { return row_; }
+    double operator[](size_t dim) const { return qc_->value(row_, dim); }
+    iterator begin() const { return iterator(qc_, row_, 0); }
+    iterator end() const { return iterator(qc_, row_, N); }
+
+    /* decode row into a stand-alone point without time */
+    Point<double, N, InlineCoords, NoStamp> toPoint() const {
+      Point<double, N, InlineCoords, NoStamp> pt;
+      std::copy(begin(), end(), pt.begin());
+      return pt;
+    }
+  private:
+    const QuantizedCloud<Q, N>* qc_;
+    size_t row_;
+  };
+  template<QuantWord Q, size_t N>
+  std::ostream& operator<<(std::ostream& out, const QuantRef<Q, N>& p) {
+    out << "{ ";
+    for(size_t i = 0; i < N; ++i) {
+      out << p[i] << (i + 1 < N ? ", " : " }");
+    }
+    return out;
+  }
+
+  /*-------------------------------------------------------------------
+    QuantizedCloud<Q, N> holds N columns of Q
+    - the range lo to hi per dimension is fixed at construction,
+      values outside it throw on insert
+    - fromPoints() takes the range from the points themselves
+  */
+  template<QuantWord Q, size_t N>
+  class QuantizedCloud {
+  public:
+    using column_type = std::vector<Q>;
+    using reference = QuantRef<Q, N>;
+    static constexpr double maxCode = double(std::numeric_limits<Q>::max());
+
+    class iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = QuantRef<Q, N>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = QuantRef<Q, N>;
+
+      iterator() = default;
+      iterator(const QuantizedCloud* qc, size_t row) : qc_(qc), row_(row) {}
+      reference operator*() const { return reference(qc_, row_); }
+      reference operator[](difference_type n) const { return reference(qc_, row_ + n); }
+      iterator& operator++() { ++row_; return *this; }
+      iterator operator++(int) { iterator tmp = *this; ++row_; return tmp; }
+      iterator& operator--() { --row_; return *this; }
+      iterator operator--(int) { iterator tmp = *this; --row_; return tmp; }
+      iterator& operator+=(difference_type n) { row_ += n; return *this; }
+      iterator& operator-=(difference_type n) { row_ -= n; return *this; }
+      iterator operator+(difference_type n) const { return iterator(qc_, row_ + n); }
+      iterator operator-(difference_type n) const { return iterator(qc_, row_ - n); }
+      difference_type operator-(const iterator& other) const {
+        return difference_type(row_) - difference_type(other.row_);
+      }
+      bool operator==(const iterator& other) const { return row_ == other.row_; }
+      bool operator!=(const iterator& other) const { return row_ != other.row_; }
+      bool operator<(const iterator& other) const { return row_ < other.row_; }
+    private:
+      const QuantizedCloud* qc_ = nullptr;
+      size_t row_ = 0;
+    };
+    using const_iterator = iterator;
+
+    QuantizedCloud(const std::array<double, N>& lo, const std::array<double, N>& hi);
+    template<typename S, typename P>
+    static QuantizedCloud fromPoints(const std::vector<Point<double, N, S, P>>& pts);
+
+    void reserve(size_t n);
+    void clear();
+    size_t size() const { return cols[0].size(); }
+    bool empty() const { return cols[0].empty(); }
+    size_t bytes() const { return N * size() * sizeof(Q); }
+
+    template<typename S, typename P>
+    void push_back(const Point<double, N, S, P>& pt);
+    void push_back(std::initializer_list<double> il);
+
+    Q encode(size_t dim, double v) const;
+    double decode(size_t dim, Q q) const { return off[dim] + scl[dim] * double(q); }
+    double value(size_t row, size_t dim) const { return decode(dim, cols[dim][row]); }
+    reference operator[](size_t row) const { return reference(this, row); }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size()); }
+
+    const column_type& column(size_t dim) const { return cols[dim]; }
+    double offset(size_t dim) const { return off[dim]; }
+    double scale(size_t dim) const { return scl[dim]; }
+
+    void decodeBlock(size_t dim, size_t b, size_t e, double* out) const;
+
+    /*---------------------------------------------
+      Codes as int32, which converts to double in
+      one SIMD instruction at every level; uint32
+      has no such conversion below AVX-512, so its
+      codes are shifted by codeBias
+    */
+    static constexpr double codeBias = sizeof(Q) == 4 ? 2147483648.0 : 0.0;
+    static std::int32_t signedCode(Q q) {
+      if constexpr(sizeof(Q) == 4) {
+        return std::int32_t(q ^ 0x80000000u);
+      }
+      else {
+        return std::int32_t(q);
+      }
+    }
+  private:
+    std::array<column_type, N> cols;
+    std::array<double, N> off;
+    std::array<double, N> scl;
+    std::array<double, N> inv;
+  };
+
+  /*-----------------------------------------------
+    scale spreads the range over every code, a
+    zero-width range keeps scale 1 so all codes
+    decode to lo
+  */
+  template<QuantWord Q, size_t N>
+  QuantizedCloud<Q, N>::QuantizedCloud(
+    const std::array<double, N>& lo, const std::array<double, N>& hi
+  ) {
+    for(size_t d = 0; d < N; ++d) {
+      if(!(hi[d] >= lo[d]) || !std::isfinite(hi[d] - lo[d])) {
+        throw "QuantizedCloud range must be finite with lo <= hi";
+      }
+      off[d] = lo[d];
+      scl[d] = hi[d] > lo[d] ? (hi[d] - lo[d]) / maxCode : 1.0;
+      inv[d] = 1.0 / scl[d];
+    }
+  }
+  template<QuantWord Q, size_t N>
+  template<typename S, typename P>
+  QuantizedCloud<Q, N> QuantizedCloud<Q, N>::fromPoints(
+    const std::vector<Point<double, N, S, P>>& pts
+  ) {
+    Bounds<double, N> b = bounds(pts);
+    QuantizedCloud qc(b.lo, b.hi);
+    for(auto& col : qc.cols) {
+      col.resize(pts.size());
+    }
+    for(size_t i = 0; i < pts.size(); ++i) {
+      for(size_t d = 0; d < N; ++d) {
+        qc.cols[d][i] = qc.encode(d, pts[i][d]);
+      }
+    }
+    return qc;
+  }
+  template<QuantWord Q, size_t N>
+  void QuantizedCloud<Q, N>::reserve(size_t n) {
+    for(auto& col : cols) {
+      col.reserve(n);
+    }
+  }
+  template<QuantWord Q, size_t N>
+  void QuantizedCloud<Q, N>::clear() {
+    for(auto& col : cols) {
+      col.clear();
+    }
+  }
+  /*-----------------------------------------------
+    Nearest code, values up to half a step past
+    either end of the range round onto it
+  */
+  template<QuantWord Q, size_t N>
+  Q QuantizedCloud<Q, N>::encode(size_t dim, double v) const {
+    double c = std::nearbyint((v - off[dim]) * inv[dim]);
+    if(!(c >= 0.0 && c <= maxCode)) {
+      throw "QuantizedCloud value outside range";
+    }
+    return Q(c);
+  }
+  template<QuantWord Q, size_t N>
+  template<typename S, typename P>
+  void QuantizedCloud<Q, N>::push_back(const Point<double, N, S, P>& pt) {
+    std::array<Q, N> q;
+    for(size_t d = 0; d < N; ++d) {
+      q[d] = encode(d, pt[d]);     // encode all first, so a throw adds nothing
+    }
+    for(size_t d = 0; d < N; ++d) {
+      cols[d].push_back(q[d]);
+    }
+  }
+  template<QuantWord Q, size_t N>
+  void QuantizedCloud<Q, N>::push_back(std::initializer_list<double> il) {
+    std::array<Q, N> q;
+    auto itr = il.begin();
+    for(size_t d = 0; d < N; ++d) {
+      q[d] = encode(d, itr != il.end() ? *itr++ : off[d]);
+    }
+    for(size_t d = 0; d < N; ++d) {
+      cols[d].push_back(q[d]);
+    }
+  }
+  /*-----------------------------------------------
+    Decode rows [b, e) of one column into out,
+    a plain convert, multiply, add loop that the
+    compiler vectorizes
+  */
+  template<QuantWord Q, size_t N>
+  void QuantizedCloud<Q, N>::decodeBlock(size_t dim, size_t b, size_t e, double* out) const {
+    const Q* src = cols[dim].data();
+    const double s = scl[dim];
+    const double o = off[dim] + s * codeBias;
+    for(size_t i = b; i < e; ++i) {
+      out[i - b] = o + s * double(signedCode(src[i]));
+    }
+  }
+
+  /*-------------------------------------------------------------------
+    Reductions on quantized columns
+    - min, max, and sum run on the integer codes, which are exact,
+      and decode once at the end, decoding is monotonic
+  */
+  template<QuantWord Q, size_t N>
+  Bounds<double, N> bounds(const QuantizedCloud<Q, N>& qc) {
+    const size_t n = qc.size();
+    if(n == 0) {
+      throw "bounds of empty point set";
+    }
+    Bounds<double, N> b;
+    for(size_t d = 0; d < N; ++d) {
+      const Q* col = qc.column(d).data();
+      Q lo = std::numeric_limits<Q>::max(), hi = 0;
+      std::uint64_t sum = 0;
+      for(size_t i = 0; i < n; ++i) {
+        lo = col[i] < lo ? col[i] : lo;
+        hi = col[i] > hi ? col[i] : hi;
+        sum += col[i];
+      }
+      b.lo[d] = qc.decode(d, lo);
+      b.hi[d] = qc.decode(d, hi);
+      b.mean[d] = qc.offset(d) + qc.scale(d) * (double(sum) / double(n));
+    }
+    b.count = n;
+    return b;
+  }
+  /*-----------------------------------------------
+    Squared distance from query to every point,
+    out is resized to qc.size()
+    - decodes in the inner loop, one tile of rows at
+      a time, so d2 stays in cache across columns
+  */
+  template<QuantWord Q, size_t N, typename S, typename P>
+  void distances2(
+    const QuantizedCloud<Q, N>& qc, const Point<double, N, S, P>& query,
+    std::vector<double>& out
+  ) {
+    const size_t n = qc.size();
+    constexpr size_t tile = 2048;
+    out.resize(n);
+    for(size_t t = 0; t < n; t += tile) {
+      const size_t te = std::min(n, t + tile);
+      double* d2 = out.data() + t;
+      std::fill(d2, d2 + (te - t), 0.0);
+      for(size_t d = 0; d < N; ++d) {
+        const Q* col = qc.column(d).data() + t;
+        const double s = qc.scale(d);
+        const double o = qc.offset(d) + s * qc.codeBias - query[d];
+        for(size_t i = 0; i < te - t; ++i) {
+          double v = o + s * double(qc.signedCode(col[i]));
+          d2[i] += v * v;
+        }
+      }
+    }
+  }
+}
+/*-- demonstrate encode, decode, and iteration --*/
+
+void demo_QuantizedCloud() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("quantized point storage", 45, "\n");
+  std::vector<Point<double, 3>> pts {
+    { 0.0, -5.0, 100.0 }, { 1.25, 0.0, 150.0 }, { 10.0, 5.0, 125.5 }
+  };
+  auto q16 = QuantizedCloud<std::uint16_t, 3>::fromPoints(pts);
+  std::cout << "  codes per unit:";
+  for(size_t d = 0; d < 3; ++d) {
+    std::cout << " " << 1.0 / q16.scale(d);
+  }
+  for(auto p : q16) {
+    std::cout << "\n  row " << p.row() << " decodes to " << p;
+  }
+  std::cout << "\n  " << q16.bytes() << " bytes for " << q16.size()
+            << " points, vector<Point<double, 3>> uses "
+            << pts.size() * sizeof(Point<double, 3>);
+  try {
+    q16.push_back({ 11.0, 0.0, 120.0 });
+  }
+  catch(const char* msg) {
+    std::cout << "\n  push_back { 11, 0, 120 }: " << msg;
+  }
+  std::cout << "\n";
+}
+
+/*-- compare full, columnar, and quantized point sets --*/
+
+template<typename Q>
+void benchQuantizedType(
+  const std::string& name, const std::vector<Points::Point<double, 3>>& pts,
+  const Points::Point<double, 3>& query, double refSum
+) {
+  using namespace Points;
+
+  Timer tmr;
+  tmr.start();
+  auto qc = QuantizedCloud<Q, 3>::fromPoints(pts);
+  tmr.stop();
+  size_t encodeUs = tmr.elapsedMicroSec();
+  double err = 0.0;
+  for(size_t i = 0; i < pts.size(); i += 97) {
+    for(size_t d = 0; d < 3; ++d) {
+      err = std::max(err, std::abs(qc.value(i, d) - pts[i][d]));
+    }
+  }
+  tmr.start();
+  Bounds<double, 3> b = bounds(qc);
+  tmr.stop();
+  size_t boundsUs = tmr.elapsedMicroSec();
+  std::vector<double> d2(pts.size());
+  tmr.start();
+  distances2(qc, query, d2);
+  tmr.stop();
+  size_t distUs = tmr.elapsedMicroSec();
+  double sum = 0.0;
+  for(double v : d2) {
+    sum += std::sqrt(v);
+  }
+  std::cout << "\n  " << name << ": " << qc.bytes() / pts.size() << " bytes/point"
+            << ", encode " << encodeUs << " us, bounds " << boundsUs
+            << " us, distances " << distUs << " us"
+            << "\n    max decode error " << std::scientific << err
+            << ", distance sum rel. error " << std::abs(sum - refSum) / refSum
+            << std::fixed << ", mean x " << b.mean[0];
+}
+void benchQuantized() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark quantized point storage", 45, "\n");
+  const size_t count = 1 << 22;
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+  std::vector<Point<double, 3>> pts(count);
+  for(auto& pt : pts) {
+    pt = { coord(gen), coord(gen), coord(gen) };
+  }
+  PointCloud<double, 3> pc(pts);
+  Point<double, 3> query { 10.0, -20.0, 30.0 };
+  std::cout << "  " << count << " points in a 2000 unit cube";
+
+  Timer tmr;
+  tmr.start();
+  Bounds<double, 3> b = bounds(pts);
+  tmr.stop();
+  size_t boundsUs = tmr.elapsedMicroSec();
+  std::vector<double> d2(count);
+  tmr.start();
+  for(size_t i = 0; i < count; ++i) {
+    double s = 0.0;
+    for(size_t d = 0; d < 3; ++d) {
+      double v = pts[i][d] - query[d];
+      s += v * v;
+    }
+    d2[i] = s;
+  }
+  tmr.stop();
+  size_t distUs = tmr.elapsedMicroSec();
+  double refSum = 0.0;
+  for(double v : d2) {
+    refSum += std::sqrt(v);
+  }
+  std::cout << "\n  vector<Point<double, 3>>: " << sizeof(Point<double, 3>) << " bytes/point"
+            << ", bounds " << boundsUs << " us, distances " << distUs << " us";
+  tmr.start();
+  b = bounds(pc);
+  tmr.stop();
+  std::cout << "\n  PointCloud<double, 3>: " << 3 * sizeof(double) + sizeof(PointCloud<double, 3>::time_type)
+            << " bytes/point, bounds " << tmr.elapsedMicroSec() << " us";
+  benchQuantizedType<std::uint32_t>("QuantizedCloud<uint32_t, 3>", pts, query, refSum);
+  benchQuantizedType<std::uint16_t>("QuantizedCloud<uint16_t, 3>", pts, query, refSum);
+  std::cout << "\n";
+}
+#endif
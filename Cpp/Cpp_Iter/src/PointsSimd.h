@@ -0,0 +1,849 @@
+/*-------------------------------------------------------------------
+  PointsSimd.h defines vectorized arithmetic for Point<T, N>
+  - element-wise add, sub, mul, scale and reductions dot, norm
+  - one pass min, max, and sum over a contiguous array, used by
+    the bounds reductions in Bounds.h
+  - kernels are written once over a Lanes<Level, T> traits type
+    and instantiated for SSE2, AVX2, and AVX-512
+  - the widest level the CPU supports is chosen at run time,
+    with a scalar loop as fallback
+*/
+#ifndef PointsSimdHeader
+#define PointsSimdHeader
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define BITS_SIMD_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+  #endif
+#else
+  #define BITS_SIMD_X86 0
+#endif
+
+/*-----------------------------------------------
+  GCC and Clang compile intrinsics only inside functions
+  targeting the matching instruction set. Flatten inlines
+  the kernel and its Lanes calls into each entry point, so
+  every level gets its own fully inlined loop.
+  MSVC accepts intrinsics anywhere and needs neither.
+*/
+#if defined(_MSC_VER) && !defined(__clang__)
+  #define BITS_TARGET(isa)
+  #define BITS_FLATTEN
+  #define BITS_INLINE __forceinline
+#else
+  #define BITS_TARGET(isa) __attribute__((target(isa)))
+  #define BITS_FLATTEN __attribute__((flatten))
+  #define BITS_INLINE inline
+#endif
+
+namespace Points {
+
+  template <typename T>
+    concept Number = std::integral<T> || std::floating_point<T>;
+
+namespace Simd {
+
+  /*-------------------------------------------------------------------
+    Instruction set levels, widest last
+  */
+  enum class Level { Scalar, SSE2, AVX2, AVX512 };
+
+  inline std::string levelName(Level lv) {
+    switch(lv) {
+      case Level::SSE2:   return "SSE2";
+      case Level::AVX2:   return "AVX2";
+      case Level::AVX512: return "AVX-512";
+      default:            return "Scalar";
+    }
+  }
+  /*-----------------------------------------------
+    Query CPU once for widest usable level
+    - AVX-512 requires F and DQ, DQ supplies
+      64-bit integer multiply
+  */
+  inline Level detectLevel() {
+  #if BITS_SIMD_X86
+    #if defined(_MSC_VER) && !defined(__clang__)
+      int r[4];
+      __cpuid(r, 0);
+      int maxLeaf = r[0];
+      __cpuid(r, 1);
+      bool sse2 = (r[3] & (1 << 26)) != 0;
+      bool osxsave = (r[2] & (1 << 27)) != 0;
+      unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+      bool ymmOS = (xcr0 & 0x06) == 0x06;
+      bool zmmOS = (xcr0 & 0xe6) == 0xe6;
+      bool avx2 = false, avx512 = false;
+      if(maxLeaf >= 7) {
+        __cpuidex(r, 7, 0);
+        avx2 = ymmOS && (r[1] & (1 << 5)) != 0;
+        avx512 = zmmOS && (r[1] & (1 << 16)) != 0 && (r[1] & (1 << 17)) != 0;
+      }
+    #else
+      __builtin_cpu_init();
+      bool sse2 = __builtin_cpu_supports("sse2");
+      bool avx2 = __builtin_cpu_supports("avx2");
+      bool avx512 = __builtin_cpu_supports("avx512f")
+                 && __builtin_cpu_supports("avx512dq");
+    #endif
+    if(avx512) return Level::AVX512;
+    if(avx2)   return Level::AVX2;
+    if(sse2)   return Level::SSE2;
+  #endif
+    return Level::Scalar;
+  }
+  inline Level level() {
+    static const Level lv = detectLevel();
+    return lv;
+  }
+
+  /*-------------------------------------------------------------------
+    Lanes<Level, T> wraps one register type V of width lanes of T
+    - load, store, add, sub, mul, set1, zero
+    - has_mul is false where the instruction set has no lane-wise
+      multiply for T; those kernels fall back to scalar code
+    - has_minmax is true for float and double, which have lane-wise
+      min and max at every level; AVX-512 uses the full-mask forms,
+      as GCC 12 warns on the undefined source inside _mm512_min_pd
+    - supported is false for T without a specialization, e.g.,
+      short or char, which always use scalar code
+  */
+  struct Sse2 {};
+  struct Avx2 {};
+  struct Avx512 {};
+
+  template<typename L, typename T>
+  struct Lanes {
+    static constexpr bool supported = false;
+    static constexpr bool has_mul = false;
+    static constexpr bool has_minmax = false;
+  };
+
+  template<typename T>
+  concept Int32 = std::integral<T> && sizeof(T) == 4;
+  template<typename T>
+  concept Int64 = std::integral<T> && sizeof(T) == 8;
+
+#if BITS_SIMD_X86
+  /*--- SSE2 ---*/
+  template<>
+  struct Lanes<Sse2, float> {
+    using V = __m128;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = true;
+    static constexpr size_t width = 4;
+    BITS_TARGET("sse2") static BITS_INLINE V load(const float* p) { return _mm_loadu_ps(p); }
+    BITS_TARGET("sse2") static BITS_INLINE void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    BITS_TARGET("sse2") static BITS_INLINE V add(V a, V b) { return _mm_add_ps(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V min(V a, V b) { return _mm_min_ps(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V max(V a, V b) { return _mm_max_ps(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V set1(float s) { return _mm_set1_ps(s); }
+    BITS_TARGET("sse2") static BITS_INLINE V zero() { return _mm_setzero_ps(); }
+  };
+  template<>
+  struct Lanes<Sse2, double> {
+    using V = __m128d;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = true;
+    static constexpr size_t width = 2;
+    BITS_TARGET("sse2") static BITS_INLINE V load(const double* p) { return _mm_loadu_pd(p); }
+    BITS_TARGET("sse2") static BITS_INLINE void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    BITS_TARGET("sse2") static BITS_INLINE V add(V a, V b) { return _mm_add_pd(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V min(V a, V b) { return _mm_min_pd(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V max(V a, V b) { return _mm_max_pd(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V set1(double s) { return _mm_set1_pd(s); }
+    BITS_TARGET("sse2") static BITS_INLINE V zero() { return _mm_setzero_pd(); }
+  };
+  template<Int32 T>
+  struct Lanes<Sse2, T> {
+    using V = __m128i;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = false;  // mullo_epi32 needs SSE4.1
+    static constexpr bool has_minmax = false;
+    static constexpr size_t width = 4;
+    BITS_TARGET("sse2") static BITS_INLINE V load(const T* p) { return _mm_loadu_si128((const __m128i*)p); }
+    BITS_TARGET("sse2") static BITS_INLINE void store(T* p, V v) { _mm_storeu_si128((__m128i*)p, v); }
+    BITS_TARGET("sse2") static BITS_INLINE V add(V a, V b) { return _mm_add_epi32(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V sub(V a, V b) { return _mm_sub_epi32(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V set1(T s) { return _mm_set1_epi32(int(s)); }
+    BITS_TARGET("sse2") static BITS_INLINE V zero() { return _mm_setzero_si128(); }
+  };
+  template<Int64 T>
+  struct Lanes<Sse2, T> {
+    using V = __m128i;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = false;
+    static constexpr bool has_minmax = false;
+    static constexpr size_t width = 2;
+    BITS_TARGET("sse2") static BITS_INLINE V load(const T* p) { return _mm_loadu_si128((const __m128i*)p); }
+    BITS_TARGET("sse2") static BITS_INLINE void store(T* p, V v) { _mm_storeu_si128((__m128i*)p, v); }
+    BITS_TARGET("sse2") static BITS_INLINE V add(V a, V b) { return _mm_add_epi64(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V sub(V a, V b) { return _mm_sub_epi64(a, b); }
+    BITS_TARGET("sse2") static BITS_INLINE V set1(T s) { return _mm_set1_epi64x((long long)s); }
+    BITS_TARGET("sse2") static BITS_INLINE V zero() { return _mm_setzero_si128(); }
+  };
+
+  /*--- AVX2 ---*/
+  template<>
+  struct Lanes<Avx2, float> {
+    using V = __m256;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = true;
+    static constexpr size_t width = 8;
+    BITS_TARGET("avx2") static BITS_INLINE V load(const float* p) { return _mm256_loadu_ps(p); }
+    BITS_TARGET("avx2") static BITS_INLINE void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    BITS_TARGET("avx2") static BITS_INLINE V add(V a, V b) { return _mm256_add_ps(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V min(V a, V b) { return _mm256_min_ps(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V max(V a, V b) { return _mm256_max_ps(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V set1(float s) { return _mm256_set1_ps(s); }
+    BITS_TARGET("avx2") static BITS_INLINE V zero() { return _mm256_setzero_ps(); }
+  };
+  template<>
+  struct Lanes<Avx2, double> {
+    using V = __m256d;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = true;
+    static constexpr size_t width = 4;
+    BITS_TARGET("avx2") static BITS_INLINE V load(const double* p) { return _mm256_loadu_pd(p); }
+    BITS_TARGET("avx2") static BITS_INLINE void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    BITS_TARGET("avx2") static BITS_INLINE V add(V a, V b) { return _mm256_add_pd(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V min(V a, V b) { return _mm256_min_pd(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V max(V a, V b) { return _mm256_max_pd(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V set1(double s) { return _mm256_set1_pd(s); }
+    BITS_TARGET("avx2") static BITS_INLINE V zero() { return _mm256_setzero_pd(); }
+  };
+  template<Int32 T>
+  struct Lanes<Avx2, T> {
+    using V = __m256i;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = false;
+    static constexpr size_t width = 8;
+    BITS_TARGET("avx2") static BITS_INLINE V load(const T* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    BITS_TARGET("avx2") static BITS_INLINE void store(T* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+    BITS_TARGET("avx2") static BITS_INLINE V add(V a, V b) { return _mm256_add_epi32(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V set1(T s) { return _mm256_set1_epi32(int(s)); }
+    BITS_TARGET("avx2") static BITS_INLINE V zero() { return _mm256_setzero_si256(); }
+  };
+  template<Int64 T>
+  struct Lanes<Avx2, T> {
+    using V = __m256i;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = false;  // mullo_epi64 needs AVX-512DQ
+    static constexpr bool has_minmax = false;
+    static constexpr size_t width = 4;
+    BITS_TARGET("avx2") static BITS_INLINE V load(const T* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    BITS_TARGET("avx2") static BITS_INLINE void store(T* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+    BITS_TARGET("avx2") static BITS_INLINE V add(V a, V b) { return _mm256_add_epi64(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V sub(V a, V b) { return _mm256_sub_epi64(a, b); }
+    BITS_TARGET("avx2") static BITS_INLINE V set1(T s) { return _mm256_set1_epi64x((long long)s); }
+    BITS_TARGET("avx2") static BITS_INLINE V zero() { return _mm256_setzero_si256(); }
+  };
+
+  /*--- AVX-512 ---*/
+  template<>
+  struct Lanes<Avx512, float> {
+    using V = __m512;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = true;
+    static constexpr size_t width = 16;
+    BITS_TARGET("avx512f") static BITS_INLINE V load(const float* p) { return _mm512_loadu_ps(p); }
+    BITS_TARGET("avx512f") static BITS_INLINE void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+    BITS_TARGET("avx512f") static BITS_INLINE V add(V a, V b) { return _mm512_add_ps(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V min(V a, V b) { return _mm512_mask_min_ps(a, __mmask16(-1), a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V max(V a, V b) { return _mm512_mask_max_ps(a, __mmask16(-1), a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V set1(float s) { return _mm512_set1_ps(s); }
+    BITS_TARGET("avx512f") static BITS_INLINE V zero() { return _mm512_setzero_ps(); }
+  };
+  template<>
+  struct Lanes<Avx512, double> {
+    using V = __m512d;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = true;
+    static constexpr size_t width = 8;
+    BITS_TARGET("avx512f") static BITS_INLINE V load(const double* p) { return _mm512_loadu_pd(p); }
+    BITS_TARGET("avx512f") static BITS_INLINE void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+    BITS_TARGET("avx512f") static BITS_INLINE V add(V a, V b) { return _mm512_add_pd(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V min(V a, V b) { return _mm512_mask_min_pd(a, __mmask8(-1), a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V max(V a, V b) { return _mm512_mask_max_pd(a, __mmask8(-1), a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V set1(double s) { return _mm512_set1_pd(s); }
+    BITS_TARGET("avx512f") static BITS_INLINE V zero() { return _mm512_setzero_pd(); }
+  };
+  template<Int32 T>
+  struct Lanes<Avx512, T> {
+    using V = __m512i;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = false;
+    static constexpr size_t width = 16;
+    BITS_TARGET("avx512f") static BITS_INLINE V load(const T* p) { return _mm512_loadu_si512(p); }
+    BITS_TARGET("avx512f") static BITS_INLINE void store(T* p, V v) { _mm512_storeu_si512(p, v); }
+    BITS_TARGET("avx512f") static BITS_INLINE V add(V a, V b) { return _mm512_add_epi32(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V sub(V a, V b) { return _mm512_sub_epi32(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V mul(V a, V b) { return _mm512_mullo_epi32(a, b); }
+    BITS_TARGET("avx512f") static BITS_INLINE V set1(T s) { return _mm512_set1_epi32(int(s)); }
+    BITS_TARGET("avx512f") static BITS_INLINE V zero() { return _mm512_setzero_si512(); }
+  };
+  template<Int64 T>
+  struct Lanes<Avx512, T> {
+    using V = __m512i;
+    static constexpr bool supported = true;
+    static constexpr bool has_mul = true;
+    static constexpr bool has_minmax = false;
+    static constexpr size_t width = 8;
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE V load(const T* p) { return _mm512_loadu_si512(p); }
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE void store(T* p, V v) { _mm512_storeu_si512(p, v); }
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE V add(V a, V b) { return _mm512_add_epi64(a, b); }
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE V sub(V a, V b) { return _mm512_sub_epi64(a, b); }
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE V mul(V a, V b) { return _mm512_mullo_epi64(a, b); }
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE V set1(T s) { return _mm512_set1_epi64((long long)s); }
+    BITS_TARGET("avx512f,avx512dq") static BITS_INLINE V zero() { return _mm512_setzero_si512(); }
+  };
+#endif
+
+  /*-----------------------------------------------
+    Lane forms and kernels below hold vector values
+    without a target attribute, so GCC warns of a
+    vector ABI change; they are flattened into the
+    targeted entry points and never called across
+    that boundary, so the warning is silenced for
+    them only
+  */
+#if !defined(_MSC_VER) || defined(__clang__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+  /*-------------------------------------------------------------------
+    Element-wise operations, used by binaryKernel
+    - scalar form for loop tails and fallback
+    - lane form for full registers, loading and storing itself so
+      no vector is passed by value, which GCC notes once per
+      translation unit regardless of the pragma above
+  */
+  struct AddOp {
+    template<typename T> static T apply(T a, T b) { return a + b; }
+    template<typename L, typename T> static BITS_INLINE void lanes(const T* a, const T* b, T* out) {
+      L::store(out, L::add(L::load(a), L::load(b)));
+    }
+  };
+  struct SubOp {
+    template<typename T> static T apply(T a, T b) { return a - b; }
+    template<typename L, typename T> static BITS_INLINE void lanes(const T* a, const T* b, T* out) {
+      L::store(out, L::sub(L::load(a), L::load(b)));
+    }
+  };
+  struct MulOp {
+    template<typename T> static T apply(T a, T b) { return a * b; }
+    template<typename L, typename T> static BITS_INLINE void lanes(const T* a, const T* b, T* out) {
+      L::store(out, L::mul(L::load(a), L::load(b)));
+    }
+  };
+
+  /*-------------------------------------------------------------------
+    Kernels over n contiguous elements, written once for any Lanes
+  */
+  template<typename L, typename Op, typename T>
+  BITS_INLINE void binaryKernel(const T* a, const T* b, T* out, size_t n) {
+    size_t i = 0;
+    for(; i + L::width <= n; i += L::width) {
+      Op::template lanes<L>(a + i, b + i, out + i);
+    }
+    for(; i < n; ++i) {
+      out[i] = Op::apply(a[i], b[i]);
+    }
+  }
+  template<typename L, typename T>
+  BITS_INLINE void scaleKernel(const T* a, T s, T* out, size_t n) {
+    auto vs = L::set1(s);
+    size_t i = 0;
+    for(; i + L::width <= n; i += L::width) {
+      L::store(out + i, L::mul(L::load(a + i), vs));
+    }
+    for(; i < n; ++i) {
+      out[i] = a[i] * s;
+    }
+  }
+  /*-----------------------------------------------
+    two accumulators hide add latency
+    - lane order differs from a sequential loop, so
+      floating point sums may differ in the last bits
+  */
+  template<typename L, typename T>
+  BITS_INLINE T dotKernel(const T* a, const T* b, size_t n) {
+    auto acc0 = L::zero();
+    auto acc1 = L::zero();
+    size_t i = 0;
+    for(; i + 2 * L::width <= n; i += 2 * L::width) {
+      acc0 = L::add(acc0, L::mul(L::load(a + i), L::load(b + i)));
+      acc1 = L::add(acc1, L::mul(L::load(a + i + L::width), L::load(b + i + L::width)));
+    }
+    for(; i + L::width <= n; i += L::width) {
+      acc0 = L::add(acc0, L::mul(L::load(a + i), L::load(b + i)));
+    }
+    alignas(64) T buf[L::width];
+    L::store(buf, L::add(acc0, acc1));
+    T sum = T{0};
+    for(size_t k = 0; k < L::width; ++k) {
+      sum += buf[k];
+    }
+    for(; i < n; ++i) {
+      sum += a[i] * b[i];
+    }
+    return sum;
+  }
+
+  /*-----------------------------------------------
+    min, max, and sum of n elements in one pass
+    - lo and hi are seeded by the caller, so calls
+      over several ranges combine
+    - lanes sum at most sumBlock elements in T before
+      adding into the double sum, which bounds float
+      rounding on long columns
+    - NaN elements give unspecified lo and hi
+  */
+  constexpr size_t sumBlock = 1024;
+
+  template<typename L, typename T>
+  BITS_INLINE void minMaxSumKernel(const T* a, size_t n, T& lo, T& hi, double& sum) {
+    auto vlo = L::set1(lo);
+    auto vhi = L::set1(hi);
+    alignas(64) T buf[L::width];
+    size_t i = 0;
+    while(i + L::width <= n) {
+      auto acc0 = L::zero();
+      auto acc1 = L::zero();
+      const size_t end = std::min(n, i + sumBlock);
+      for(; i + 2 * L::width <= end; i += 2 * L::width) {
+        auto v0 = L::load(a + i);
+        auto v1 = L::load(a + i + L::width);
+        vlo = L::min(vlo, L::min(v0, v1));
+        vhi = L::max(vhi, L::max(v0, v1));
+        acc0 = L::add(acc0, v0);
+        acc1 = L::add(acc1, v1);
+      }
+      for(; i + L::width <= end; i += L::width) {
+        auto v0 = L::load(a + i);
+        vlo = L::min(vlo, v0);
+        vhi = L::max(vhi, v0);
+        acc0 = L::add(acc0, v0);
+      }
+      L::store(buf, L::add(acc0, acc1));
+      for(size_t k = 0; k < L::width; ++k) {
+        sum += double(buf[k]);
+      }
+    }
+    L::store(buf, vlo);
+    for(size_t k = 0; k < L::width; ++k) {
+      lo = buf[k] < lo ? buf[k] : lo;
+    }
+    L::store(buf, vhi);
+    for(size_t k = 0; k < L::width; ++k) {
+      hi = buf[k] > hi ? buf[k] : hi;
+    }
+    for(; i < n; ++i) {
+      lo = a[i] < lo ? a[i] : lo;
+      hi = a[i] > hi ? a[i] : hi;
+      sum += double(a[i]);
+    }
+  }
+#if !defined(_MSC_VER) || defined(__clang__)
+  #pragma GCC diagnostic pop
+#endif
+
+  /*--- scalar fallbacks ---*/
+  template<typename Op, typename T>
+  void binaryScalar(const T* a, const T* b, T* out, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+      out[i] = Op::apply(a[i], b[i]);
+    }
+  }
+  template<typename T>
+  void scaleScalar(const T* a, T s, T* out, size_t n) {
+    for(size_t i = 0; i < n; ++i) {
+      out[i] = a[i] * s;
+    }
+  }
+  template<typename T>
+  T dotScalar(const T* a, const T* b, size_t n) {
+    T sum = T{0};
+    for(size_t i = 0; i < n; ++i) {
+      sum += a[i] * b[i];
+    }
+    return sum;
+  }
+
+  template<typename T>
+  void minMaxSumScalar(const T* a, size_t n, T& lo, T& hi, double& sum) {
+    for(size_t i = 0; i < n; ++i) {
+      lo = a[i] < lo ? a[i] : lo;
+      hi = a[i] > hi ? a[i] : hi;
+      sum += double(a[i]);
+    }
+  }
+
+#if BITS_SIMD_X86
+  /*-------------------------------------------------------------------
+    Entry points, one set per level, each compiled for its
+    instruction set with the kernel inlined
+  */
+  template<typename Op, typename T>
+  BITS_TARGET("sse2") BITS_FLATTEN
+  void binarySse2(const T* a, const T* b, T* out, size_t n) { binaryKernel<Lanes<Sse2, T>, Op>(a, b, out, n); }
+  template<typename T>
+  BITS_TARGET("sse2") BITS_FLATTEN
+  void scaleSse2(const T* a, T s, T* out, size_t n) { scaleKernel<Lanes<Sse2, T>>(a, s, out, n); }
+  template<typename T>
+  BITS_TARGET("sse2") BITS_FLATTEN
+  T dotSse2(const T* a, const T* b, size_t n) { return dotKernel<Lanes<Sse2, T>>(a, b, n); }
+  template<typename T>
+  BITS_TARGET("sse2") BITS_FLATTEN
+  void minMaxSumSse2(const T* a, size_t n, T& lo, T& hi, double& sum) {
+    minMaxSumKernel<Lanes<Sse2, T>>(a, n, lo, hi, sum);
+  }
+
+  template<typename Op, typename T>
+  BITS_TARGET("avx2") BITS_FLATTEN
+  void binaryAvx2(const T* a, const T* b, T* out, size_t n) { binaryKernel<Lanes<Avx2, T>, Op>(a, b, out, n); }
+  template<typename T>
+  BITS_TARGET("avx2") BITS_FLATTEN
+  void scaleAvx2(const T* a, T s, T* out, size_t n) { scaleKernel<Lanes<Avx2, T>>(a, s, out, n); }
+  template<typename T>
+  BITS_TARGET("avx2") BITS_FLATTEN
+  T dotAvx2(const T* a, const T* b, size_t n) { return dotKernel<Lanes<Avx2, T>>(a, b, n); }
+  template<typename T>
+  BITS_TARGET("avx2") BITS_FLATTEN
+  void minMaxSumAvx2(const T* a, size_t n, T& lo, T& hi, double& sum) {
+    minMaxSumKernel<Lanes<Avx2, T>>(a, n, lo, hi, sum);
+  }
+
+  template<typename Op, typename T>
+  BITS_TARGET("avx512f,avx512dq") BITS_FLATTEN
+  void binaryAvx512(const T* a, const T* b, T* out, size_t n) { binaryKernel<Lanes<Avx512, T>, Op>(a, b, out, n); }
+  template<typename T>
+  BITS_TARGET("avx512f,avx512dq") BITS_FLATTEN
+  void scaleAvx512(const T* a, T s, T* out, size_t n) { scaleKernel<Lanes<Avx512, T>>(a, s, out, n); }
+  template<typename T>
+  BITS_TARGET("avx512f,avx512dq") BITS_FLATTEN
+  T dotAvx512(const T* a, const T* b, size_t n) { return dotKernel<Lanes<Avx512, T>>(a, b, n); }
+  template<typename T>
+  BITS_TARGET("avx512f,avx512dq") BITS_FLATTEN
+  void minMaxSumAvx512(const T* a, size_t n, T& lo, T& hi, double& sum) {
+    minMaxSumKernel<Lanes<Avx512, T>>(a, n, lo, hi, sum);
+  }
+#endif
+
+  /*-------------------------------------------------------------------
+    Kernels<T> holds one function pointer per operation, filled
+    for a chosen level. Operations a level cannot do for T keep
+    their scalar versions.
+  */
+  template<typename T>
+  struct Kernels {
+    using Binary = void(*)(const T*, const T*, T*, size_t);
+    Binary add = binaryScalar<AddOp, T>;
+    Binary sub = binaryScalar<SubOp, T>;
+    Binary mul = binaryScalar<MulOp, T>;
+    void (*scale)(const T*, T, T*, size_t) = scaleScalar<T>;
+    T (*dot)(const T*, const T*, size_t) = dotScalar<T>;
+    void (*minMaxSum)(const T*, size_t, T&, T&, double&) = minMaxSumScalar<T>;
+    Level level = Level::Scalar;
+  };
+
+  template<typename T>
+  Kernels<T> makeKernels(Level lv) {
+    Kernels<T> k;
+  #if BITS_SIMD_X86
+    if(lv >= Level::AVX512 && Lanes<Avx512, T>::supported) {
+      if constexpr(Lanes<Avx512, T>::supported) {
+        k.add = binaryAvx512<AddOp, T>;
+        k.sub = binaryAvx512<SubOp, T>;
+        if constexpr(Lanes<Avx512, T>::has_mul) {
+          k.mul = binaryAvx512<MulOp, T>;
+          k.scale = scaleAvx512<T>;
+          k.dot = dotAvx512<T>;
+        }
+        if constexpr(Lanes<Avx512, T>::has_minmax) {
+          k.minMaxSum = minMaxSumAvx512<T>;
+        }
+        k.level = Level::AVX512;
+      }
+    }
+    else if(lv >= Level::AVX2 && Lanes<Avx2, T>::supported) {
+      if constexpr(Lanes<Avx2, T>::supported) {
+        k.add = binaryAvx2<AddOp, T>;
+        k.sub = binaryAvx2<SubOp, T>;
+        if constexpr(Lanes<Avx2, T>::has_mul) {
+          k.mul = binaryAvx2<MulOp, T>;
+          k.scale = scaleAvx2<T>;
+          k.dot = dotAvx2<T>;
+        }
+        if constexpr(Lanes<Avx2, T>::has_minmax) {
+          k.minMaxSum = minMaxSumAvx2<T>;
+        }
+        k.level = Level::AVX2;
+      }
+    }
+    else if(lv >= Level::SSE2 && Lanes<Sse2, T>::supported) {
+      if constexpr(Lanes<Sse2, T>::supported) {
+        k.add = binarySse2<AddOp, T>;
+        k.sub = binarySse2<SubOp, T>;
+        if constexpr(Lanes<Sse2, T>::has_mul) {
+          k.mul = binarySse2<MulOp, T>;
+          k.scale = scaleSse2<T>;
+          k.dot = dotSse2<T>;
+        }
+        if constexpr(Lanes<Sse2, T>::has_minmax) {
+          k.minMaxSum = minMaxSumSse2<T>;
+        }
+        k.level = Level::SSE2;
+      }
+    }
+  #endif
+    return k;
+  }
+  /*-----------------------------------------------
+    Kernels for the widest level this CPU supports,
+    resolved on first use
+  */
+  template<typename T>
+  const Kernels<T>& kernels() {
+    static const Kernels<T> k = makeKernels<T>(level());
+    return k;
+  }
+  /*-----------------------------------------------
+    smallest point dimension sent to dispatched kernels
+  */
+  constexpr size_t minDispatchN = 32;
+}  // namespace Simd
+
+  /*-------------------------------------------------------------------
+    Point<T, N, S, P> arithmetic
+    - out-parameter forms write into an existing point and do not
+      construct a new Time
+    - value forms return a new point
+    - dispatched kernels cost an indirect call, so points with fewer
+      than Simd::minDispatchN coordinates use an inline loop that
+      the compiler unrolls and vectorizes for the baseline target
+  */
+  template<Number T, size_t N, typename S, typename P>
+  void add(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b, Point<T, N, S, P>& out) {
+    if constexpr(N < Simd::minDispatchN) {
+      Simd::binaryScalar<Simd::AddOp>(a.span().data(), b.span().data(), out.span().data(), N);
+    }
+    else {
+      Simd::kernels<T>().add(a.span().data(), b.span().data(), out.span().data(), N);
+    }
+  }
+  template<Number T, size_t N, typename S, typename P>
+  void sub(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b, Point<T, N, S, P>& out) {
+    if constexpr(N < Simd::minDispatchN) {
+      Simd::binaryScalar<Simd::SubOp>(a.span().data(), b.span().data(), out.span().data(), N);
+    }
+    else {
+      Simd::kernels<T>().sub(a.span().data(), b.span().data(), out.span().data(), N);
+    }
+  }
+  template<Number T, size_t N, typename S, typename P>
+  void mul(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b, Point<T, N, S, P>& out) {
+    if constexpr(N < Simd::minDispatchN) {
+      Simd::binaryScalar<Simd::MulOp>(a.span().data(), b.span().data(), out.span().data(), N);
+    }
+    else {
+      Simd::kernels<T>().mul(a.span().data(), b.span().data(), out.span().data(), N);
+    }
+  }
+  template<Number T, size_t N, typename S, typename P>
+  void scale(const Point<T, N, S, P>& a, T s, Point<T, N, S, P>& out) {
+    if constexpr(N < Simd::minDispatchN) {
+      Simd::scaleScalar(a.span().data(), s, out.span().data(), N);
+    }
+    else {
+      Simd::kernels<T>().scale(a.span().data(), s, out.span().data(), N);
+    }
+  }
+  template<Number T, size_t N, typename S, typename P>
+  Point<T, N, S, P> add(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b) {
+    Point<T, N, S, P> out;
+    add(a, b, out);
+    return out;
+  }
+  template<Number T, size_t N, typename S, typename P>
+  Point<T, N, S, P> sub(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b) {
+    Point<T, N, S, P> out;
+    sub(a, b, out);
+    return out;
+  }
+  template<Number T, size_t N, typename S, typename P>
+  Point<T, N, S, P> mul(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b) {
+    Point<T, N, S, P> out;
+    mul(a, b, out);
+    return out;
+  }
+  template<Number T, size_t N, typename S, typename P>
+  Point<T, N, S, P> scale(const Point<T, N, S, P>& a, T s) {
+    Point<T, N, S, P> out;
+    scale(a, s, out);
+    return out;
+  }
+  template<Number T, size_t N, typename S, typename P>
+  T dot(const Point<T, N, S, P>& a, const Point<T, N, S, P>& b) {
+    if constexpr(N < Simd::minDispatchN) {
+      return Simd::dotScalar(a.span().data(), b.span().data(), N);
+    }
+    else {
+      return Simd::kernels<T>().dot(a.span().data(), b.span().data(), N);
+    }
+  }
+  template<Number T, size_t N, typename S, typename P>
+  double norm(const Point<T, N, S, P>& a) {
+    return std::sqrt(double(dot(a, a)));
+  }
+}
+/*-- demonstrate Point arithmetic --*/
+
+void demo_Point_arithmetic() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("vectorized Point<T, N> arithmetic", 45, "\n");
+  std::cout << "  dispatch level: " << Simd::levelName(Simd::level());
+  auto show = [](const std::string& nm, const auto& p) {
+    std::cout << "\n  " << nm << " = { ";
+    for(auto item : p) {
+      std::cout << item << " ";
+    }
+    std::cout << "}";
+  };
+  Point<double, 5> p1 { 1.0, 2.0, 3.0, 4.0, 5.0 };
+  Point<double, 5> p2 { 0.5, 0.5, 0.5, 0.5, 0.5 };
+  show("p1", p1);
+  show("p2", p2);
+  show("add(p1, p2)", add(p1, p2));
+  show("sub(p1, p2)", sub(p1, p2));
+  show("mul(p1, p2)", mul(p1, p2));
+  show("scale(p1, 2.0)", scale(p1, 2.0));
+  std::cout << "\n  dot(p1, p2) = " << dot(p1, p2);
+  std::cout << "\n  norm(p1) = " << norm(p1) << "\n";
+}
+
+/*-- compare kernels with naive loops at several N --*/
+
+template<typename T, size_t N>
+void benchPointArithmeticN(size_t totalElems) {
+  using namespace Points;
+
+  Point<T, N> a, b, out;
+  for(size_t i = 0; i < N; ++i) {
+    a[i] = T(i % 7 + 1);
+    b[i] = T(i % 5 + 1);
+  }
+  const size_t reps = totalElems / N;
+  Timer tmr;
+
+  /* naive element-wise add */
+  tmr.start();
+  for(size_t r = 0; r < reps; ++r) {
+    auto& ac = a.coords();
+    auto& bc = b.coords();
+    auto& oc = out.coords();
+    for(size_t i = 0; i < N; ++i) {
+      oc[i] = ac[i] + bc[i];
+    }
+    a[r % N] = oc[(r + 1) % N] / T(2);  // defeat hoisting out of reps loop
+  }
+  tmr.stop();
+  size_t naiveAdd = tmr.elapsedMicroSec();
+
+  tmr.start();
+  for(size_t r = 0; r < reps; ++r) {
+    add(a, b, out);
+    a[r % N] = out[(r + 1) % N] / T(2);
+  }
+  tmr.stop();
+  size_t simdAdd = tmr.elapsedMicroSec();
+
+  /* naive dot product */
+  T check0 = T{0};
+  tmr.start();
+  for(size_t r = 0; r < reps; ++r) {
+    T sum = T{0};
+    for(size_t i = 0; i < N; ++i) {
+      sum += a[i] * b[i];
+    }
+    check0 += sum;
+    b[r % N] = T(r % 3 + 1);
+  }
+  tmr.stop();
+  size_t naiveDot = tmr.elapsedMicroSec();
+
+  T check1 = T{0};
+  tmr.start();
+  for(size_t r = 0; r < reps; ++r) {
+    check1 += dot(a, b);
+    b[r % N] = T(r % 3 + 1);
+  }
+  tmr.stop();
+  size_t simdDot = tmr.elapsedMicroSec();
+
+  std::cout << "\n  N = " << N
+            << ":  add naive " << naiveAdd << " us, simd " << simdAdd << " us"
+            << ";  dot naive " << naiveDot << " us, simd " << simdDot << " us"
+            << "  (check " << double(check0 - check1) << ")";
+}
+template<typename T>
+void benchPointArithmeticType(const std::string& name) {
+  const size_t totalElems = 32 * 1024 * 1024;
+  std::cout << "\n  " << name << ", " << totalElems << " elements per run";
+  benchPointArithmeticN<T, 4>(totalElems);
+  benchPointArithmeticN<T, 16>(totalElems);
+  benchPointArithmeticN<T, 64>(totalElems);
+  benchPointArithmeticN<T, 256>(totalElems);
+  benchPointArithmeticN<T, 1024>(totalElems);
+}
+void benchPointArithmetic() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark Point<T, N> arithmetic kernels", 45, "\n");
+  std::cout << "  dispatch level: " << Simd::levelName(Simd::level());
+  benchPointArithmeticType<float>("float");
+  benchPointArithmeticType<double>("double");
+  benchPointArithmeticType<std::int32_t>("int32");
+  benchPointArithmeticType<std::int64_t>("int64");
+  std::cout << "\n";
+}
+#endif
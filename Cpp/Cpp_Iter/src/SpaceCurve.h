@@ -0,0 +1,408 @@
+/*-------------------------------------------------------------------
+  SpaceCurve.h defines space-filling-curve ordering for point
+  collections in 2 and 3 dimensions
+  - coordinates are scaled into the collection's bounding box and
+    quantized, 32 bits per axis in 2-D, 21 bits in 3-D
+  - Morton (Z-order) keys interleave the quantized bits, Hilbert
+    keys interleave them after Skilling's transform, so successive
+    keys are always neighboring cells
+  - a parallel LSD radix sort orders the keys, and the points are
+    then permuted so nearby points sit near each other in memory
+*/
+#ifndef SpaceCurveHeader
+#define SpaceCurveHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <random>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Distance.h"
+#include "KdTree.h"
+#include "SpatialHash.h"
+#include "Time.h"
+
+#if defined(__BMI2__)
+  #include <immintrin.h>
+#endif
+
+namespace Points {
+
+  enum class Curve { Morton, Hilbert };
+
+  namespace Sfc {
+
+    /*-----------------------------------------------
+      Spread the low bits of v so each is followed by
+      N - 1 zero bits
+      - BMI2 pdep does this in one instruction, the
+        magic-number shifts are the portable form
+    */
+    template<size_t N>
+    inline std::uint64_t spread(std::uint64_t v);
+
+    template<>
+    inline std::uint64_t spread<2>(std::uint64_t v) {
+    #if defined(__BMI2__)
+      return _pdep_u64(v, 0x5555555555555555ull);
+    #else
+      v &= 0xffffffffull;
+      v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+      v = (v | (v << 8))  & 0x00ff00ff00ff00ffull;
+      v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0full;
+      v = (v | (v << 2))  & 0x3333333333333333ull;
+      v = (v | (v << 1))  & 0x5555555555555555ull;
+      return v;
+    #endif
+    }
+    template<>
+    inline std::uint64_t spread<3>(std::uint64_t v) {
+    #if defined(__BMI2__)
+      return _pdep_u64(v, 0x1249249249249249ull);
+    #else
+      v &= 0x1fffffull;
+      v = (v | (v << 32)) & 0x001f00000000ffffull;
+      v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+      v = (v | (v << 8))  & 0x100f00f00f00f00full;
+      v = (v | (v << 4))  & 0x10c30c30c30c30c3ull;
+      v = (v | (v << 2))  & 0x1249249249249249ull;
+      return v;
+    #endif
+    }
+  }
+
+  /*-----------------------------------------------
+    Bits per axis, as many as fit 64 bit keys
+  */
+  template<size_t N>
+  constexpr unsigned curveBits = unsigned(64 / N) > 32 ? 32 : unsigned(64 / N);
+
+  /*-----------------------------------------------
+    Morton key of quantized cell q
+    - axis 0 supplies the highest bit of each group
+  */
+  template<size_t N>
+    requires (N == 2 || N == 3)
+  std::uint64_t mortonKey(const std::array<std::uint32_t, N>& q) {
+    std::uint64_t key = 0;
+    for(size_t i = 0; i < N; ++i) {
+      key |= Sfc::spread<N>(q[i]) << (N - 1 - i);
+    }
+    return key;
+  }
+  /*-----------------------------------------------
+    Hilbert key of quantized cell q, Bits per axis
+    - Skilling, "Programming the Hilbert curve",
+      AIP Conf. Proc. 707 (2004): axes to transpose
+      form, whose interleaved bits are the index
+  */
+  template<size_t N, unsigned Bits = curveBits<N>>
+    requires (N == 2 || N == 3)
+  std::uint64_t hilbertKey(std::array<std::uint32_t, N> x) {
+    const std::uint32_t m = std::uint32_t(1) << (Bits - 1);
+    for(std::uint32_t q = m; q > 1; q >>= 1) {
+      std::uint32_t p = q - 1;
+      for(size_t i = 0; i < N; ++i) {
+        /* bit set: invert low bits of x[0], else exchange them
+           with x[i]; branch-free, the bits are unpredictable */
+        std::uint32_t set = 0u - std::uint32_t((x[i] & q) != 0);
+        std::uint32_t t = (x[0] ^ x[i]) & p & ~set;
+        x[0] ^= (p & set) | t;
+        x[i] ^= t;
+      }
+    }
+    for(size_t i = 1; i < N; ++i) {                // Gray encode
+      x[i] ^= x[i - 1];
+    }
+    std::uint32_t t = 0;
+    for(std::uint32_t q = m; q > 1; q >>= 1) {
+      t ^= (q - 1) & (0u - std::uint32_t((x[N - 1] & q) != 0));
+    }
+    for(size_t i = 0; i < N; ++i) {
+      x[i] ^= t;
+    }
+    return mortonKey<N>(x);
+  }
+
+  /*-----------------------------------------------
+    Bounding box used to quantize coordinates
+  */
+  template<typename T, size_t N>
+  struct CurveBox {
+    std::array<T, N> lo;
+    std::array<T, N> hi;
+  };
+  template<typename T, size_t N, typename S, typename P>
+  CurveBox<T, N> curveBox(const std::vector<Point<T, N, S, P>>& pts) {
+    CurveBox<T, N> box;
+    box.lo.fill(std::numeric_limits<T>::max());
+    box.hi.fill(std::numeric_limits<T>::lowest());
+    for(const auto& pt : pts) {
+      for(size_t d = 0; d < N; ++d) {
+        box.lo[d] = std::min(box.lo[d], pt[d]);
+        box.hi[d] = std::max(box.hi[d], pt[d]);
+      }
+    }
+    return box;
+  }
+  /*-----------------------------------------------
+    Curve key of every point, computed in blocks
+    on separate threads
+  */
+  template<typename T, size_t N, typename S, typename P>
+    requires (N == 2 || N == 3)
+  std::vector<std::uint64_t> curveKeys(
+    const std::vector<Point<T, N, S, P>>& pts, Curve curve, size_t threads = 0
+  ) {
+    std::vector<std::uint64_t> keys(pts.size());
+    if(pts.empty()) {
+      return keys;
+    }
+    CurveBox<T, N> box = curveBox(pts);
+    const double cells = double((std::uint64_t(1) << curveBits<N>) - 1);
+    std::array<double, N> scale;
+    for(size_t d = 0; d < N; ++d) {
+      double ext = double(box.hi[d]) - double(box.lo[d]);
+      scale[d] = ext > 0.0 ? cells / ext : 0.0;
+    }
+    const size_t block = 1 << 14;
+    forEachBlock((pts.size() + block - 1) / block, threads, [&](size_t b) {
+      size_t end = std::min(pts.size(), (b + 1) * block);
+      for(size_t i = b * block; i < end; ++i) {
+        std::array<std::uint32_t, N> q;
+        for(size_t d = 0; d < N; ++d) {
+          q[d] = std::uint32_t((double(pts[i][d]) - double(box.lo[d])) * scale[d]);
+        }
+        keys[i] = curve == Curve::Morton ? mortonKey<N>(q) : hilbertKey<N>(q);
+      }
+    });
+    return keys;
+  }
+
+  /*-------------------------------------------------------------------
+    Parallel LSD radix sort of keys, carrying index with each key
+    - 11 bit digits, so 64 bit keys take 6 passes; a pass whose
+      digit is the same for every key is skipped
+    - each thread histograms and scatters one contiguous block,
+      blocks scatter in order, so the sort is stable
+  */
+  inline void radixSortKeys(
+    std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& index, size_t threads = 0
+  ) {
+    constexpr unsigned digitBits = 11;
+    constexpr size_t radix = size_t(1) << digitBits;
+    const size_t n = keys.size();
+    if(n > std::numeric_limits<std::uint32_t>::max()) {
+      throw "radixSortKeys supports at most 2^32 - 1 keys";
+    }
+    if(threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    const size_t nBlocks = std::max<size_t>(1, std::min(threads, n / 65536));
+    std::vector<std::uint64_t> keys2(n);
+    std::vector<std::uint32_t> index2(n);
+    std::vector<std::vector<std::uint32_t>> counts(nBlocks, std::vector<std::uint32_t>(radix));
+
+    for(unsigned shift = 0; shift < 64; shift += digitBits) {
+      const std::uint64_t* src = keys.data();
+      forEachBlock(nBlocks, threads, [&](size_t b) {
+        std::uint32_t* cnt = counts[b].data();
+        std::fill(cnt, cnt + radix, 0u);
+        for(size_t i = n * b / nBlocks, e = n * (b + 1) / nBlocks; i < e; ++i) {
+          ++cnt[(src[i] >> shift) & (radix - 1)];
+        }
+      });
+      /* offsets: digit major, block minor */
+      std::uint32_t total = 0;
+      bool constant = false;
+      for(size_t digit = 0; digit < radix; ++digit) {
+        std::uint32_t digitCount = 0;
+        for(size_t b = 0; b < nBlocks; ++b) {
+          std::uint32_t c = counts[b][digit];
+          counts[b][digit] = total;
+          total += c;
+          digitCount += c;
+        }
+        constant = constant || digitCount == n;
+      }
+      if(constant) {
+        continue;
+      }
+      const std::uint32_t* srcIdx = index.data();
+      std::uint64_t* dstKeys = keys2.data();
+      std::uint32_t* dstIdx = index2.data();
+      forEachBlock(nBlocks, threads, [&](size_t b) {
+        std::uint32_t* off = counts[b].data();
+        for(size_t i = n * b / nBlocks, e = n * (b + 1) / nBlocks; i < e; ++i) {
+          std::uint32_t dst = off[(src[i] >> shift) & (radix - 1)]++;
+          dstKeys[dst] = src[i];
+          dstIdx[dst] = srcIdx[i];
+        }
+      });
+      keys.swap(keys2);
+      index.swap(index2);
+    }
+  }
+  /*-----------------------------------------------
+    Order of pts along curve: order[k] is the old
+    index of the point that belongs at position k
+  */
+  template<typename T, size_t N, typename S, typename P>
+    requires (N == 2 || N == 3)
+  std::vector<std::uint32_t> curveOrder(
+    const std::vector<Point<T, N, S, P>>& pts, Curve curve, size_t threads = 0
+  ) {
+    std::vector<std::uint64_t> keys = curveKeys(pts, curve, threads);
+    std::vector<std::uint32_t> order(pts.size());
+    std::iota(order.begin(), order.end(), std::uint32_t(0));
+    radixSortKeys(keys, order, threads);
+    return order;
+  }
+  /*-----------------------------------------------
+    Permute pts into curve order, returns the order
+    so parallel arrays can follow
+  */
+  template<typename T, size_t N, typename S, typename P>
+    requires (N == 2 || N == 3)
+  std::vector<std::uint32_t> reorderByCurve(
+    std::vector<Point<T, N, S, P>>& pts, Curve curve, size_t threads = 0
+  ) {
+    std::vector<std::uint32_t> order = curveOrder(pts, curve, threads);
+    std::vector<Point<T, N, S, P>> sorted;
+    sorted.reserve(pts.size());
+    for(auto i : order) {
+      sorted.push_back(std::move(pts[i]));
+    }
+    pts.swap(sorted);
+    return order;
+  }
+}
+/*-- demonstrate curve keys on a small grid --*/
+
+void demo_SpaceCurve() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("Morton and Hilbert curve order", 45, "\n");
+  auto showOrder = [](const std::string& name, auto keyOf) {
+    std::array<int, 16> rank {};
+    std::vector<std::pair<std::uint64_t, int>> cells;
+    for(std::uint32_t y = 0; y < 4; ++y) {
+      for(std::uint32_t x = 0; x < 4; ++x) {
+        cells.push_back({ keyOf(std::array<std::uint32_t, 2> { x, y }), int(y * 4 + x) });
+      }
+    }
+    std::sort(cells.begin(), cells.end());
+    for(size_t k = 0; k < cells.size(); ++k) {
+      rank[cells[k].second] = int(k);
+    }
+    std::cout << "  " << name << " visit order on a 4 x 4 grid, row y = 3 first:\n";
+    for(int y = 3; y >= 0; --y) {
+      std::cout << "   ";
+      for(int x = 0; x < 4; ++x) {
+        std::cout << (rank[y * 4 + x] < 10 ? "  " : " ") << rank[y * 4 + x];
+      }
+      std::cout << "\n";
+    }
+  };
+  showOrder("Morton ", [](auto q) { return mortonKey<2>(q); });
+  showOrder("Hilbert", [](auto q) { return hilbertKey<2, 2>(q); });
+
+  std::vector<Point<double, 3, InlineCoords, NoStamp>> pts {
+    { 9.0, 9.0, 9.0 }, { 0.0, 0.0, 0.0 }, { 8.0, 9.0, 9.0 }, { 1.0, 0.0, 0.0 }
+  };
+  auto order = reorderByCurve(pts, Curve::Hilbert);
+  std::cout << "  Hilbert order of 4 points: old indexes";
+  for(auto i : order) {
+    std::cout << " " << i;
+  }
+  std::cout << "\n";
+}
+
+/*-- measure sort cost and the payoff in downstream loops --*/
+
+void benchSpaceCurve() {
+  using namespace Analysis;
+  using namespace Points;
+  using Pt = Point<double, 3, InlineCoords, NoStamp>;
+
+  showNote("benchmark space-filling-curve reordering", 45, "\n");
+  const size_t n = 2000000;
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<double> coord(0.0, 1000.0);
+  std::vector<Pt> arrival(n);
+  for(auto& pt : arrival) {
+    pt = { coord(gen), coord(gen), coord(gen) };
+  }
+  std::cout << "  " << n << " Point<double, 3> in random arrival order";
+
+  Timer tmr;
+  auto keys = curveKeys(arrival, Curve::Hilbert);
+  std::vector<std::uint32_t> idx(n);
+  std::iota(idx.begin(), idx.end(), std::uint32_t(0));
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> pairs(n);
+  for(size_t i = 0; i < n; ++i) {
+    pairs[i] = { keys[i], std::uint32_t(i) };
+  }
+  tmr.start();
+  radixSortKeys(keys, idx);
+  tmr.stop();
+  std::cout << "\n  radix sort of keys:  " << tmr.elapsedMicroSec() << " us";
+  tmr.start();
+  std::sort(pairs.begin(), pairs.end());
+  tmr.stop();
+  bool same = true;
+  for(size_t i = 0; same && i < n; ++i) {
+    same = pairs[i].first == keys[i];
+  }
+  std::cout << "\n  std::sort of pairs:  " << tmr.elapsedMicroSec() << " us"
+            << "  (" << (same ? "same order" : "DIFFERENT") << ")";
+
+  /* same points, three orders, same downstream work */
+  auto run = [&](const std::string& name, std::vector<Pt>& pts) {
+    Timer t;
+    t.start();
+    KdTree<double, 3> kt(pts);
+    t.stop();
+    size_t build = t.elapsedMicroSec();
+    t.start();
+    double sum = 0.0;
+    for(size_t i = 0; i < pts.size(); i += 4) {
+      sum += kt.nearest(pts[i], 4).back().distance;
+    }
+    t.stop();
+    size_t knn = t.elapsedMicroSec();
+    SpatialHash<double> grid(8.0, pts.size());
+    grid.rebuild(pts, 1);
+    t.start();
+    size_t hits = 0;
+    for(size_t i = 0; i < pts.size(); i += 4) {
+      grid.forEachWithin(pts[i].span().data(), 4.0, [&](size_t, double) { ++hits; });
+    }
+    t.stop();
+    size_t sweep = t.elapsedMicroSec();
+    std::cout << "\n  " << name << ": k-d build " << build << " us, knn sweep " << knn
+              << " us, grid sweep " << sweep << " us  (check " << sum << ", " << hits << ")";
+  };
+  std::vector<Pt> morton = arrival, hilbert = arrival;
+  tmr.start();
+  reorderByCurve(morton, Curve::Morton);
+  tmr.stop();
+  size_t mortonUs = tmr.elapsedMicroSec();
+  tmr.start();
+  reorderByCurve(hilbert, Curve::Hilbert);
+  tmr.stop();
+  std::cout << "\n  reorder: Morton " << mortonUs << " us, Hilbert " << tmr.elapsedMicroSec() << " us";
+  run("arrival", arrival);
+  run("Morton ", morton);
+  run("Hilbert", hilbert);
+  std::cout << "\n";
+}
+#endif
@@ -0,0 +1,466 @@
+/*-------------------------------------------------------------------
+  SpatialHash.h defines uniform grid index SpatialHash<T>
+  - space is cut into cubes of side cellSize, and each cube's
+    integer coordinates hash to one of a fixed number of buckets
+  - a bucket holds the id and position of every point in it, so a
+    radius query reads the buckets of neighboring cells only,
+    each as a contiguous run
+  - points may be inserted, removed, and moved one at a time, or
+    the whole grid rebuilt on several threads, e.g. every frame
+    for moving points
+  - suits roughly uniform data, where a tree's depth is overhead;
+    clustered data is better served by KdTree
+*/
+#ifndef SpatialHashHeader
+#define SpatialHashHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <concepts>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Distance.h"
+#include "KdTree.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    SpatialHash<T> indexes 3-D positions by id
+    - ids come from insert() or are 0..n-1 after rebuild(), and
+      removed ids are reused by later inserts
+    - distinct cells may share a bucket; queries check distance,
+      and visit each bucket once, so results are exact
+    - a cell size near twice the usual query radius keeps a query
+      to 8 cells, a cell size of r to 27 or more smaller ones
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  class SpatialHash {
+  public:
+    using Pos = std::array<T, 3>;
+    struct Entry {
+      Pos pos;
+      size_t id;
+    };
+
+    explicit SpatialHash(T cellSize, size_t buckets = 4096);
+
+    size_t insert(const T* p);
+    void remove(size_t id);
+    void move(size_t id, const T* p);
+    void rebuild(const T* coords, size_t count, size_t threads = 0);
+
+    template<typename S, typename P>
+    size_t insert(const Point<T, 3, S, P>& pt) { return insert(pt.span().data()); }
+    template<typename S, typename P>
+    void move(size_t id, const Point<T, 3, S, P>& pt) { move(id, pt.span().data()); }
+    template<typename S, typename P>
+    void rebuild(const std::vector<Point<T, 3, S, P>>& pts, size_t threads = 0);
+
+    template<typename F>
+    void forEachWithin(const T* q, T r, F f) const;
+    std::vector<Neighbor<T>> within(const T* q, T r) const;
+    template<typename F>
+    void forEachPairWithin(T r, F f) const;
+
+    size_t size() const { return live; }
+    size_t bucketCount() const { return buckets.size(); }
+    T cellSize() const { return cell; }
+    bool contains(size_t id) const { return id < bucketOf.size() && bucketOf[id] != npos; }
+    const Pos& position(size_t id) const { return buckets[bucketOf[id]][slotOf[id]].pos; }
+  private:
+    static constexpr size_t npos = size_t(-1);
+    using Cell = std::array<std::int64_t, 3>;
+    Cell cellOf(const T* p) const {
+      return {
+        std::int64_t(std::floor(p[0] * inv)),
+        std::int64_t(std::floor(p[1] * inv)),
+        std::int64_t(std::floor(p[2] * inv))
+      };
+    }
+    size_t bucket(const Cell& c) const {
+      std::uint64_t h = std::uint64_t(c[0]) * 73856093u
+                      ^ std::uint64_t(c[1]) * 19349663u
+                      ^ std::uint64_t(c[2]) * 83492791u;
+      return size_t(h & mask);
+    }
+    void place(size_t id, const T* p);
+    void unplace(size_t id);
+
+    T cell;
+    T inv;
+    std::uint64_t mask;
+    std::vector<std::vector<Entry>> buckets;
+    std::vector<size_t> bucketOf;   // per id, npos when free
+    std::vector<size_t> slotOf;     // per id, index in its bucket
+    std::vector<size_t> freeIds;
+    size_t live = 0;
+  };
+  /*-----------------------------------------------
+    buckets is rounded up to a power of two, about
+    one bucket per point keeps buckets short
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  SpatialHash<T>::SpatialHash(T cellSize, size_t nBuckets) : cell(cellSize) {
+    if(!(cellSize > T{0})) {
+      throw "SpatialHash cell size must be positive";
+    }
+    inv = T{1} / cellSize;
+    size_t n = 1;
+    while(n < nBuckets) {
+      n <<= 1;
+    }
+    mask = n - 1;
+    buckets.resize(n);
+  }
+  template<typename T>
+    requires std::floating_point<T>
+  void SpatialHash<T>::place(size_t id, const T* p) {
+    size_t b = bucket(cellOf(p));
+    bucketOf[id] = b;
+    slotOf[id] = buckets[b].size();
+    buckets[b].push_back({ { p[0], p[1], p[2] }, id });
+  }
+  /*-----------------------------------------------
+    swap-remove, the last entry takes the hole
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  void SpatialHash<T>::unplace(size_t id) {
+    auto& bk = buckets[bucketOf[id]];
+    size_t slot = slotOf[id];
+    if(slot + 1 != bk.size()) {
+      bk[slot] = bk.back();
+      slotOf[bk[slot].id] = slot;
+    }
+    bk.pop_back();
+    bucketOf[id] = npos;
+  }
+  template<typename T>
+    requires std::floating_point<T>
+  size_t SpatialHash<T>::insert(const T* p) {
+    size_t id;
+    if(!freeIds.empty()) {
+      id = freeIds.back();
+      freeIds.pop_back();
+    }
+    else {
+      id = bucketOf.size();
+      bucketOf.push_back(npos);
+      slotOf.push_back(0);
+    }
+    place(id, p);
+    ++live;
+    return id;
+  }
+  template<typename T>
+    requires std::floating_point<T>
+  void SpatialHash<T>::remove(size_t id) {
+    if(!contains(id)) {
+      throw "SpatialHash remove of unknown id";
+    }
+    unplace(id);
+    freeIds.push_back(id);
+    --live;
+  }
+  /*-----------------------------------------------
+    moves within a bucket only rewrite the entry
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  void SpatialHash<T>::move(size_t id, const T* p) {
+    if(!contains(id)) {
+      throw "SpatialHash move of unknown id";
+    }
+    size_t b = bucket(cellOf(p));
+    if(b == bucketOf[id]) {
+      buckets[b][slotOf[id]].pos = { p[0], p[1], p[2] };
+      return;
+    }
+    unplace(id);
+    place(id, p);
+  }
+  /*-----------------------------------------------
+    Replace contents with coords, count rows of x, y, z
+    - pass 1 hashes points on separate threads
+    - pass 2 gives each thread a contiguous range of
+      buckets; each thread scans the bucket numbers and
+      fills only its own buckets, so no locks are needed
+      and every bucket lists ids in ascending order
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  void SpatialHash<T>::rebuild(const T* coords, size_t count, size_t threads) {
+    const size_t block = 1 << 14;
+    const size_t nBlocks = (count + block - 1) / block;
+    bucketOf.assign(count, 0);
+    slotOf.assign(count, 0);
+    freeIds.clear();
+    live = count;
+    forEachBlock(nBlocks, threads, [&](size_t blk) {
+      size_t end = std::min(count, (blk + 1) * block);
+      for(size_t i = blk * block; i < end; ++i) {
+        bucketOf[i] = bucket(cellOf(coords + 3 * i));
+      }
+    });
+    if(threads == 0) {
+      threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    const size_t nb = buckets.size();
+    const size_t parts = std::min(threads, nb);
+    forEachBlock(parts, threads, [&](size_t part) {
+      size_t b0 = nb * part / parts, b1 = nb * (part + 1) / parts;
+      for(size_t b = b0; b < b1; ++b) {
+        buckets[b].clear();
+      }
+      for(size_t i = 0; i < count; ++i) {
+        size_t b = bucketOf[i];
+        if(b >= b0 && b < b1) {
+          const T* p = coords + 3 * i;
+          slotOf[i] = buckets[b].size();
+          buckets[b].push_back({ { p[0], p[1], p[2] }, i });
+        }
+      }
+    });
+  }
+  template<typename T>
+    requires std::floating_point<T>
+  template<typename S, typename P>
+  void SpatialHash<T>::rebuild(const std::vector<Point<T, 3, S, P>>& pts, size_t threads) {
+    std::vector<T> coords(pts.size() * 3);
+    for(size_t i = 0; i < pts.size(); ++i) {
+      std::copy_n(pts[i].span().data(), 3, &coords[3 * i]);
+    }
+    rebuild(coords.data(), pts.size(), threads);
+  }
+  /*-----------------------------------------------
+    f(id, squared distance) for every point within r
+    of q, in no particular order
+    - visits the cells overlapping the query cube,
+      27 of them when r <= cellSize
+    - when the cube covers at least as many cells as
+      there are buckets, scans every bucket once
+    - throws if r is negative or not finite
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  template<typename F>
+  void SpatialHash<T>::forEachWithin(const T* q, T r, F f) const {
+    if(!(r >= T(0)) || !std::isfinite(r)) {
+      throw "SpatialHash radius must be finite and non-negative";
+    }
+    const T r2 = r * r;
+    auto test = [&](size_t b) {
+      for(const Entry& e : buckets[b]) {
+        T dx = e.pos[0] - q[0], dy = e.pos[1] - q[1], dz = e.pos[2] - q[2];
+        T d2 = dx * dx + dy * dy + dz * dz;
+        if(d2 <= r2) {
+          f(e.id, d2);
+        }
+      }
+    };
+    /* cell bounds counted in T first, so no cast can overflow */
+    const T lo[3] = { q[0] - r, q[1] - r, q[2] - r };
+    const T hi[3] = { q[0] + r, q[1] + r, q[2] + r };
+    const T limit = T(std::int64_t(1) << 52);
+    T cells = T(1);
+    for(size_t d = 0; d < 3; ++d) {
+      T a = std::floor(lo[d] * inv), b = std::floor(hi[d] * inv);
+      cells = std::abs(a) < limit && std::abs(b) < limit ? cells * (b - a + T(1)) : limit;
+    }
+    if(!(cells < T(buckets.size()))) {
+      for(size_t b = 0; b < buckets.size(); ++b) {
+        test(b);
+      }
+      return;
+    }
+    Cell c0 = cellOf(lo), c1 = cellOf(hi);
+    /* distinct cells can share a bucket, visit each bucket once */
+    std::array<size_t, 64> small;
+    std::vector<size_t> large;
+    size_t* seen = small.data();
+    size_t nCells = size_t(c1[0] - c0[0] + 1) * size_t(c1[1] - c0[1] + 1)
+                  * size_t(c1[2] - c0[2] + 1);
+    if(nCells > small.size()) {
+      large.resize(nCells);
+      seen = large.data();
+    }
+    size_t nSeen = 0;
+    for(auto x = c0[0]; x <= c1[0]; ++x) {
+      for(auto y = c0[1]; y <= c1[1]; ++y) {
+        for(auto z = c0[2]; z <= c1[2]; ++z) {
+          seen[nSeen++] = bucket({ x, y, z });
+        }
+      }
+    }
+    std::sort(seen, seen + nSeen);
+    nSeen = size_t(std::unique(seen, seen + nSeen) - seen);
+    for(size_t b : std::span<const size_t>(seen, nSeen)) {
+      test(b);
+    }
+  }
+  /*-----------------------------------------------
+    all points within distance r, nearest first
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  std::vector<Neighbor<T>> SpatialHash<T>::within(const T* q, T r) const {
+    std::vector<Neighbor<T>> out;
+    forEachWithin(q, r, [&](size_t id, T d2) {
+      out.push_back({ id, d2 });
+    });
+    std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+      return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+    });
+    for(auto& nb : out) {
+      nb.distance = std::sqrt(nb.distance);
+    }
+    return out;
+  }
+  /*-----------------------------------------------
+    f(a, b, squared distance) once for every pair of
+    points closer than r, with a < b
+  */
+  template<typename T>
+    requires std::floating_point<T>
+  template<typename F>
+  void SpatialHash<T>::forEachPairWithin(T r, F f) const {
+    for(const auto& bk : buckets) {
+      for(const Entry& e : bk) {
+        forEachWithin(e.pos.data(), r, [&](size_t other, T d2) {
+          if(e.id < other) {
+            f(e.id, other, d2);
+          }
+        });
+      }
+    }
+  }
+}
+/*-- demonstrate spatial hash updates and queries --*/
+
+void demo_SpatialHash() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("uniform spatial hash grid", 45, "\n");
+  SpatialHash<double> grid(1.0, 64);
+  std::vector<Point<double, 3, InlineCoords, NoStamp>> pts {
+    { 0.0, 0.0, 0.0 }, { 0.5, 0.2, 0.0 }, { 1.2, 0.0, 0.0 },
+    { 3.0, 3.0, 3.0 }, { -0.4, -0.4, 0.1 }
+  };
+  for(auto& pt : pts) {
+    grid.insert(pt);
+  }
+  auto show = [&](const std::string& what) {
+    double q[3] = { 0.0, 0.0, 0.0 };
+    std::cout << "  " << what << ": within 1.0 of origin:";
+    for(auto& nb : grid.within(q, 1.0)) {
+      std::cout << " id " << nb.index << " at " << nb.distance << ",";
+    }
+    std::cout << "\n";
+  };
+  std::cout << "  " << grid.size() << " points, cell size " << grid.cellSize()
+            << ", " << grid.bucketCount() << " buckets\n";
+  show("inserted");
+  grid.move(3, Point<double, 3, InlineCoords, NoStamp> { 0.1, 0.1, 0.1 });
+  show("moved id 3");
+  grid.remove(1);
+  show("removed id 1");
+  size_t pairs = 0;
+  grid.forEachPairWithin(0.5, [&](size_t, size_t, double) { ++pairs; });
+  std::cout << "  pairs closer than 0.5: " << pairs << "\n";
+}
+
+/*-- compare grid with k-d tree and brute force for radius queries --*/
+
+void benchSpatialHash() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark spatial hash vs k-d tree", 45, "\n");
+  const size_t n = 200000, nQueries = 20000;
+  const double side = 100.0, r = 1.5;
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> coord(0.0, side);
+  std::vector<double> buf(n * 3), queries(nQueries * 3);
+  for(auto& c : buf) {
+    c = coord(gen);
+  }
+  for(auto& c : queries) {
+    c = coord(gen);
+  }
+  std::cout << "  " << n << " uniform points in a " << side << " cube, "
+            << nQueries << " queries of radius " << r;
+
+  Timer tmr;
+  SpatialHash<double> grid(2.0 * r, n);
+  std::vector<size_t> threadCounts { 1 };
+  size_t hw = std::thread::hardware_concurrency();
+  if(hw > 1) {
+    threadCounts.push_back(hw);
+  }
+  for(size_t threads : threadCounts) {
+    tmr.start();
+    grid.rebuild(buf.data(), n, threads);
+    tmr.stop();
+    std::cout << "\n  grid rebuild, " << threads << " thread" << (threads > 1 ? "s: " : ":  ")
+              << tmr.elapsedMicroSec() << " us";
+  }
+  tmr.start();
+  KdTree<double, 3> kt(buf.data(), n);
+  tmr.stop();
+  std::cout << "\n  k-d tree build:       " << tmr.elapsedMicroSec() << " us";
+
+  size_t gridHits = 0, treeHits = 0, bruteHits = 0;
+  tmr.start();
+  for(size_t i = 0; i < nQueries; ++i) {
+    grid.forEachWithin(&queries[3 * i], r, [&](size_t, double) { ++gridHits; });
+  }
+  tmr.stop();
+  std::cout << "\n  grid queries:         " << tmr.elapsedMicroSec() << " us";
+  tmr.start();
+  for(size_t i = 0; i < nQueries; ++i) {
+    treeHits += kt.radius(&queries[3 * i], r).size();
+  }
+  tmr.stop();
+  std::cout << "\n  k-d tree queries:     " << tmr.elapsedMicroSec() << " us";
+  tmr.start();
+  for(size_t i = 0; i < nQueries / 100; ++i) {
+    const double* q = &queries[3 * i];
+    for(size_t j = 0; j < n; ++j) {
+      const double* p = &buf[3 * j];
+      double dx = q[0] - p[0], dy = q[1] - p[1], dz = q[2] - p[2];
+      bruteHits += dx * dx + dy * dy + dz * dz <= r * r;
+    }
+  }
+  tmr.stop();
+  std::cout << "\n  brute force, 1/100 of queries: " << tmr.elapsedMicroSec() << " us"
+            << ", " << bruteHits << " hits"
+            << "\n  hits: grid " << gridHits << ", tree " << treeHits
+            << (gridHits == treeHits ? "  (match)" : "  (DIFFER)");
+
+  /* one frame of small moves */
+  std::normal_distribution<double> jitter(0.0, 0.1);
+  tmr.start();
+  for(size_t i = 0; i < n; ++i) {
+    double* p = &buf[3 * i];
+    p[0] += jitter(gen);
+    p[1] += jitter(gen);
+    p[2] += jitter(gen);
+    grid.move(i, p);
+  }
+  tmr.stop();
+  std::cout << "\n  move every point once: " << tmr.elapsedMicroSec() << " us"
+            << " (including random jitter)\n";
+}
+#endif
@@ -0,0 +1,463 @@
+/*-------------------------------------------------------------------
+  TimeIndex.h defines temporal index TimeIndex<T, N>
+  - answers time range, latest before t, and time window inside a
+    bounding box queries over timestamped points in logarithmic time
+  - points are held in time ordered segments of bounded size, with
+    a sparse fence vector holding each segment's latest time
+  - appends in time order go to the tail segment, late arrivals are
+    inserted in place and split their segment when it overflows
+  - inserts take an exclusive lock and queries a shared lock, so
+    points can keep arriving while queries run
+*/
+#ifndef TimeIndexHeader
+#define TimeIndexHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <algorithm>
+#include <random>
+#include <mutex>
+#include <shared_mutex>
+#include <concepts>
+#include "AnalysisIter.h"
+#include "PointsIter.h"
+#include "Time.h"
+
+namespace Points {
+
+  /*-------------------------------------------------------------------
+    TimeIndex<T, N> indexes points by time
+    - times are int64_t nanoseconds since the system_clock epoch,
+      the EpochStamp representation
+    - each point gets an id, its insertion count, and queries
+      return ids, so callers can keep their own point storage
+    - segment i holds times no later than any time in segment i + 1,
+      and fence[i] is segment i's latest time, so a binary search
+      of fence finds the first segment a query touches
+    - each segment keeps its coordinates in columns and its bounding
+      box, so window queries skip segments outside the box
+  */
+  template<typename T, const size_t N>
+  class TimeIndex {
+  public:
+    using stamp_type = std::int64_t;
+
+    explicit TimeIndex(size_t segmentSize = 1024);
+    TimeIndex(const TimeIndex& ti) = delete;
+    TimeIndex& operator=(const TimeIndex& ti) = delete;
+    ~TimeIndex() = default;
+
+    template<typename S, typename P>
+      requires (!std::same_as<P, NoStamp>)
+    size_t insert(const Point<T, N, S, P>& pt);
+    size_t insert(const T* coords, stamp_type t);
+    template<typename R>
+    void insertAll(const R& pts);
+
+    std::vector<size_t> range(stamp_type t0, stamp_type t1) const;
+    std::optional<size_t> latestBefore(stamp_type t) const;
+    std::vector<size_t> window(
+      stamp_type t0, stamp_type t1, const T* lo, const T* hi
+    ) const;
+
+    static stamp_type toStamp(time_point<system_clock> tp) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        tp.time_since_epoch()
+      ).count();
+    }
+
+    size_t size() const;
+    size_t segmentCount() const;
+  private:
+    struct Segment {
+      std::vector<stamp_type> times;        // ascending
+      std::vector<size_t> ids;
+      std::array<std::vector<T>, N> cols;
+      std::array<T, N> lo;                  // bounding box
+      std::array<T, N> hi;
+
+      Segment() { clearBox(); }
+      size_t size() const { return times.size(); }
+      void insert(size_t pos, const T* c, stamp_type t, size_t id);
+      void clearBox();
+      void growBox(const T* c);
+      bool meets(const T* qlo, const T* qhi) const;
+      bool inside(size_t i, const T* qlo, const T* qhi) const;
+    };
+    size_t insertLocked(const T* c, stamp_type t);
+    void split(size_t k);
+
+    std::vector<Segment> segs;
+    std::vector<stamp_type> fence;    // latest time in each segment
+    size_t segSize;
+    size_t count = 0;
+    mutable std::shared_mutex mtx;
+  };
+  /*-----------------------------------------------
+    Segment helpers
+  */
+  template<typename T, size_t N>
+  void TimeIndex<T, N>::Segment::insert(
+    size_t pos, const T* c, stamp_type t, size_t id
+  ) {
+    times.insert(times.begin() + pos, t);
+    ids.insert(ids.begin() + pos, id);
+    for(size_t d = 0; d < N; ++d) {
+      cols[d].insert(cols[d].begin() + pos, c[d]);
+    }
+    growBox(c);
+  }
+  template<typename T, size_t N>
+  void TimeIndex<T, N>::Segment::clearBox() {
+    lo.fill(std::numeric_limits<T>::max());
+    hi.fill(std::numeric_limits<T>::lowest());
+  }
+  template<typename T, size_t N>
+  void TimeIndex<T, N>::Segment::growBox(const T* c) {
+    for(size_t d = 0; d < N; ++d) {
+      lo[d] = std::min(lo[d], c[d]);
+      hi[d] = std::max(hi[d], c[d]);
+    }
+  }
+  template<typename T, size_t N>
+  bool TimeIndex<T, N>::Segment::meets(const T* qlo, const T* qhi) const {
+    for(size_t d = 0; d < N; ++d) {
+      if(hi[d] < qlo[d] || qhi[d] < lo[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  template<typename T, size_t N>
+  bool TimeIndex<T, N>::Segment::inside(size_t i, const T* qlo, const T* qhi) const {
+    for(size_t d = 0; d < N; ++d) {
+      if(cols[d][i] < qlo[d] || qhi[d] < cols[d][i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  /*-----------------------------------------------
+    segmentSize bounds points per segment
+  */
+  template<typename T, size_t N>
+  TimeIndex<T, N>::TimeIndex(size_t segmentSize)
+    : segSize(std::max<size_t>(2, segmentSize)) {}
+  /*-----------------------------------------------
+    Insert a point using its timestamp
+  */
+  template<typename T, size_t N>
+  template<typename S, typename P>
+    requires (!std::same_as<P, NoStamp>)
+  size_t TimeIndex<T, N>::insert(const Point<T, N, S, P>& pt) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    return insertLocked(pt.span().data(), toStamp(pt.timePoint()));
+  }
+  template<typename T, size_t N>
+  size_t TimeIndex<T, N>::insert(const T* coords, stamp_type t) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    return insertLocked(coords, t);
+  }
+  /*-----------------------------------------------
+    Insert a batch of points under one lock
+    - ids are assigned in range order
+  */
+  template<typename T, size_t N>
+  template<typename R>
+  void TimeIndex<T, N>::insertAll(const R& pts) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    for(const auto& pt : pts) {
+      insertLocked(pt.span().data(), toStamp(pt.timePoint()));
+    }
+  }
+  /*-----------------------------------------------
+    Place point after any equal times
+    - t no earlier than every fence goes to the tail
+      segment, or a new one if the tail is full
+    - otherwise it goes into the first segment whose
+      latest time is after t, which is split if it
+      then holds more than segSize points
+  */
+  template<typename T, size_t N>
+  size_t TimeIndex<T, N>::insertLocked(const T* c, stamp_type t) {
+    size_t id = count++;
+    size_t k = std::upper_bound(fence.begin(), fence.end(), t) - fence.begin();
+    if(k == segs.size()) {
+      if(segs.empty() || segs.back().size() >= segSize) {
+        segs.emplace_back();
+        fence.push_back(t);
+      }
+      Segment& tail = segs.back();
+      tail.insert(tail.size(), c, t, id);
+      fence.back() = t;
+      return id;
+    }
+    Segment& seg = segs[k];
+    size_t pos = std::upper_bound(seg.times.begin(), seg.times.end(), t) - seg.times.begin();
+    seg.insert(pos, c, t, id);
+    if(seg.size() > segSize) {
+      split(k);
+    }
+    return id;
+  }
+  /*-----------------------------------------------
+    Move upper half of segment k into a new
+    segment k + 1
+  */
+  template<typename T, size_t N>
+  void TimeIndex<T, N>::split(size_t k) {
+    Segment upper;
+    Segment& seg = segs[k];
+    size_t mid = seg.size() / 2;
+    upper.times.assign(seg.times.begin() + mid, seg.times.end());
+    upper.ids.assign(seg.ids.begin() + mid, seg.ids.end());
+    seg.times.resize(mid);
+    seg.ids.resize(mid);
+    for(size_t d = 0; d < N; ++d) {
+      upper.cols[d].assign(seg.cols[d].begin() + mid, seg.cols[d].end());
+      seg.cols[d].resize(mid);
+    }
+    std::array<T, N> c;
+    for(Segment* s : { &seg, &upper }) {
+      s->clearBox();
+      for(size_t i = 0; i < s->size(); ++i) {
+        for(size_t d = 0; d < N; ++d) {
+          c[d] = s->cols[d][i];
+        }
+        s->growBox(c.data());
+      }
+    }
+    fence[k] = seg.times.back();
+    stamp_type upperFence = upper.times.back();
+    segs.insert(segs.begin() + k + 1, std::move(upper));
+    fence.insert(fence.begin() + k + 1, upperFence);
+  }
+  /*-----------------------------------------------
+    Ids of points with t0 <= time < t1, in time order
+  */
+  template<typename T, size_t N>
+  std::vector<size_t> TimeIndex<T, N>::range(stamp_type t0, stamp_type t1) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    std::vector<size_t> out;
+    size_t k = std::lower_bound(fence.begin(), fence.end(), t0) - fence.begin();
+    for(; k < segs.size(); ++k) {
+      const Segment& seg = segs[k];
+      if(seg.times.front() >= t1) {
+        break;
+      }
+      size_t i = std::lower_bound(seg.times.begin(), seg.times.end(), t0) - seg.times.begin();
+      for(; i < seg.size() && seg.times[i] < t1; ++i) {
+        out.push_back(seg.ids[i]);
+      }
+    }
+    return out;
+  }
+  /*-----------------------------------------------
+    Id of latest point with time < t, if any
+    - among equal times, the last inserted
+  */
+  template<typename T, size_t N>
+  std::optional<size_t> TimeIndex<T, N>::latestBefore(stamp_type t) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    size_t k = std::lower_bound(fence.begin(), fence.end(), t) - fence.begin();
+    if(k < segs.size()) {
+      const Segment& seg = segs[k];
+      size_t i = std::lower_bound(seg.times.begin(), seg.times.end(), t) - seg.times.begin();
+      if(i > 0) {
+        return seg.ids[i - 1];
+      }
+    }
+    if(k > 0) {
+      return segs[k - 1].ids.back();
+    }
+    return std::nullopt;
+  }
+  /*-----------------------------------------------
+    Ids of points with t0 <= time < t1 and lo <= x <= hi
+    in every dimension, in time order
+    - segments whose box misses the query are skipped
+  */
+  template<typename T, size_t N>
+  std::vector<size_t> TimeIndex<T, N>::window(
+    stamp_type t0, stamp_type t1, const T* lo, const T* hi
+  ) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    std::vector<size_t> out;
+    size_t k = std::lower_bound(fence.begin(), fence.end(), t0) - fence.begin();
+    for(; k < segs.size(); ++k) {
+      const Segment& seg = segs[k];
+      if(seg.times.front() >= t1) {
+        break;
+      }
+      if(!seg.meets(lo, hi)) {
+        continue;
+      }
+      size_t i = std::lower_bound(seg.times.begin(), seg.times.end(), t0) - seg.times.begin();
+      for(; i < seg.size() && seg.times[i] < t1; ++i) {
+        if(seg.inside(i, lo, hi)) {
+          out.push_back(seg.ids[i]);
+        }
+      }
+    }
+    return out;
+  }
+  template<typename T, size_t N>
+  size_t TimeIndex<T, N>::size() const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return count;
+  }
+  template<typename T, size_t N>
+  size_t TimeIndex<T, N>::segmentCount() const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return segs.size();
+  }
+}
+/*-- demonstrate time range queries on a short trajectory --*/
+
+void demo_TimeIndex() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("time range index", 45, "\n");
+  using Index = TimeIndex<double, 2>;
+  const Index::stamp_type sec = 1000000000;
+
+  /*-- 20 points one second apart, points 7 and 13 arrive late --*/
+  Index ti(4);
+  std::vector<size_t> order;
+  for(size_t i = 0; i < 20; ++i) {
+    if(i != 7 && i != 13) {
+      order.push_back(i);
+    }
+  }
+  order.push_back(13);
+  order.push_back(7);
+  std::vector<size_t> idAt(20);
+  for(auto i : order) {
+    double c[2] = { double(i), double(i % 5) };
+    idAt[i] = ti.insert(c, Index::stamp_type(i) * sec);
+  }
+  std::cout << "  " << ti.size() << " points in " << ti.segmentCount()
+            << " segments, late arrivals 13 and 7 have ids "
+            << idAt[13] << " and " << idAt[7];
+
+  std::cout << "\n  ids in [5 s, 9 s):";
+  for(auto id : ti.range(5 * sec, 9 * sec)) {
+    std::cout << " " << id;
+  }
+  auto last = ti.latestBefore(12 * sec + sec / 2);
+  std::cout << "\n  latest before 12.5 s: id " << (last ? *last : size_t(-1));
+  double lo[2] = { 0.0, 3.0 }, hi[2] = { 20.0, 4.0 };
+  std::cout << "\n  ids in [0 s, 20 s) with y in [3, 4]:";
+  for(auto id : ti.window(0, 20 * sec, lo, hi)) {
+    std::cout << " " << id;
+  }
+  std::cout << "\n";
+}
+
+/*-- compare indexed time queries with full scans --*/
+
+void benchTimeIndex() {
+  using namespace Analysis;
+  using namespace Points;
+
+  showNote("benchmark time index vs full scan", 45, "\n");
+  using Index = TimeIndex<double, 3>;
+  const size_t n = 1000000, nQueries = 200;
+  const Index::stamp_type step = 1000000;   // 1 ms between points
+
+  /*-- roughly ordered arrivals, each up to 5 ms late --*/
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> coord(0.0, 1000.0);
+  std::uniform_int_distribution<Index::stamp_type> jitter(0, 5 * step);
+  std::vector<double> buf(n * 3);
+  std::vector<Index::stamp_type> times(n);
+  for(size_t i = 0; i < n; ++i) {
+    for(size_t d = 0; d < 3; ++d) {
+      buf[i * 3 + d] = coord(gen);
+    }
+    times[i] = Index::stamp_type(i) * step - jitter(gen);
+  }
+  Index ti;
+  Timer tmr;
+  tmr.start();
+  for(size_t i = 0; i < n; ++i) {
+    ti.insert(&buf[i * 3], times[i]);
+  }
+  tmr.stop();
+  std::cout << "  " << n << " points, insert " << tmr.elapsedMicroSec() << " us, "
+            << ti.segmentCount() << " segments";
+
+  std::uniform_int_distribution<Index::stamp_type> when(0, Index::stamp_type(n) * step);
+  std::vector<Index::stamp_type> t0s(nQueries);
+  for(auto& t : t0s) {
+    t = when(gen);
+  }
+  const Index::stamp_type width = 1000 * step;   // about 1000 points
+  double lo[3] = { 0.0, 0.0, 0.0 }, hi[3] = { 500.0, 500.0, 500.0 };
+
+  auto report = [&](const std::string& name, auto indexed, auto scan) {
+    Timer t;
+    t.start();
+    size_t a = 0;
+    for(auto t0 : t0s) {
+      a += indexed(t0);
+    }
+    t.stop();
+    double indexUs = double(t.elapsedNanoSec()) / 1000.0 / nQueries;
+    t.start();
+    size_t b = 0;
+    for(auto t0 : t0s) {
+      b += scan(t0);
+    }
+    t.stop();
+    double scanUs = double(t.elapsedNanoSec()) / 1000.0 / nQueries;
+    std::cout << "\n  " << name << ": index " << indexUs << " us, scan "
+              << scanUs << " us  (check " << (a == b ? "ok" : "FAILED") << ")";
+  };
+  report("range       ",
+    [&](auto t0) { return ti.range(t0, t0 + width).size(); },
+    [&](auto t0) {
+      size_t c = 0;
+      for(auto t : times) {
+        c += (t0 <= t && t < t0 + width);
+      }
+      return c;
+    }
+  );
+  report("latestBefore",
+    [&](auto t0) {
+      auto id = ti.latestBefore(t0);
+      return id ? size_t(times[*id]) : size_t(std::numeric_limits<Index::stamp_type>::min());
+    },
+    [&](auto t0) {
+      Index::stamp_type best = std::numeric_limits<Index::stamp_type>::min();
+      for(auto t : times) {
+        if(t < t0 && t >= best) {
+          best = t;
+        }
+      }
+      return size_t(best);
+    }
+  );
+  report("window      ",
+    [&](auto t0) { return ti.window(t0, t0 + width, lo, hi).size(); },
+    [&](auto t0) {
+      size_t c = 0;
+      for(size_t i = 0; i < n; ++i) {
+        const double* p = &buf[i * 3];
+        c += (t0 <= times[i] && times[i] < t0 + width
+          && p[0] <= hi[0] && p[1] <= hi[1] && p[2] <= hi[2]);
+      }
+      return c;
+    }
+  );
+  std::cout << "\n";
+}
+#endif
@@ -7,6 +7,8 @@
   - You can skip the hard parts until then, without loss
     of understanding.
 */
+#ifndef AnalysisObjHeader
+#define AnalysisObjHeader
 
 #include <typeinfo>     // typeid
 #include <utility>      // move()
@@ -145,3 +147,4 @@ std::string formatString(
       << ": \"" << t << "\"" << suffix;
   return out.str();
 }
+#endif
@@ -11,6 +11,15 @@
 #include <set>          // set<T> class
 #include "AnalysisObj.h"   // Analysis functions for this demo
 #include "PointsObj.h"     // Point4D class declaration
+#include "TrajectoryCodec.h"  // compressed Point4D streams
+#include "Point4DFile.h"   // binary Point4D files and mapped views
+#include "Point4DParse.h"  // multi-threaded Point4D text ingestion
+#include "Point4DArena.h"  // arena and pool allocation for Point4D
+#include "Point4DGrid.h"   // spatial hash grid for Point4D positions
+#include "Point4DBatch.h"  // packed Point4D records, AoS and SoA batches
+#include "Point4DQueue.h"  // lock-free SPSC and MPMC Point4D queues
+#include "TrajectoryView.h" // time-interpolated lookup over Point4D trajectories
+#include "Point4DKinematics.h" // velocity and acceleration from Point4D samples
 /*-----------------------------------------------
   Note:
   Find all Bits code, including this in
@@ -206,6 +215,27 @@ int main() {
     demo_heap_string();
     demo_heap_vector();
     demo_heap_Point4D();
+    demo_arena_Point4D();
+    demo_TrajectoryCodec();
+    demo_Point4DFile();
+    demo_Point4DParse();
+    demo_Point4DGrid();
+    demo_Point4DBatch();
+    demo_Point4DQueue();
+    demo_TrajectoryView();
+    demo_Point4DKinematics();
+
+    // #define BENCH
+    #ifdef BENCH
+    benchTrajectoryCodec();
+    benchPoint4DParse();
+    benchPoint4DAlloc();
+    benchPoint4DBatch();
+    benchTimeFormat();
+    benchPoint4DQueue();
+    benchTrajectoryView();
+    benchPoint4DKinematics();
+    #endif
     
     print("\n  That's all Folks!\n\n");
 }
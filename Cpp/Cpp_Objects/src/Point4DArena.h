@@ -0,0 +1,156 @@
+/*-------------------------------------------------------------------
+  Point4DArena.h allocates Point4D instances from std::pmr resources
+  - Point4D holds no heap members, so the allocation worth pooling
+    is the object itself, as made by new in demo_heap_Point4D
+  - a monotonic arena hands out objects by bumping a pointer and
+    frees a whole batch in one release()
+  - a pool resource recycles point-sized blocks through free lists,
+    for objects that come and go one at a time
+  - CountingResource counts calls reaching the global heap
+*/
+#ifndef Point4DArenaHeader
+#define Point4DArenaHeader
+
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+#include <string>
+#include <chrono>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+
+/*-----------------------------------------------
+  Forwards to upstream and counts allocations,
+  deallocations, and bytes requested
+*/
+class CountingResource : public std::pmr::memory_resource {
+public:
+  explicit CountingResource(
+    std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+  ) : _upstream(upstream) {}
+  size_t allocations() const { return _allocs; }
+  size_t deallocations() const { return _deallocs; }
+  size_t bytes() const { return _bytes; }
+private:
+  void* do_allocate(size_t n, size_t align) override {
+    ++_allocs;
+    _bytes += n;
+    return _upstream->allocate(n, align);
+  }
+  void do_deallocate(void* p, size_t n, size_t align) override {
+    ++_deallocs;
+    _upstream->deallocate(p, n, align);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+  std::pmr::memory_resource* _upstream;
+  size_t _allocs = 0;
+  size_t _deallocs = 0;
+  size_t _bytes = 0;
+};
+
+/*-----------------------------------------------
+  Pool options sized for Point4D blocks
+*/
+inline std::pmr::pool_options point4DPoolOptions() {
+  std::pmr::pool_options opts;
+  opts.largest_required_pool_block = sizeof(Point4D);
+  opts.max_blocks_per_chunk = 4096;
+  return opts;
+}
+
+/*-- demonstrate Point4D instances in an arena --*/
+
+void demo_arena_Point4D() {
+    showNote("arena-based Point4D instances");
+    showOp("polymorphic_allocator<Point4D> alloc(&arena)");
+    CountingResource heap;
+    std::pmr::monotonic_buffer_resource arena(1024, &heap);
+    std::pmr::polymorphic_allocator<Point4D> alloc(&arena);
+
+    std::vector<Point4D*> pts;
+    for(size_t i = 0; i < 100; ++i) {
+        Point4D* pPoint4D = alloc.new_object<Point4D>();
+        pPoint4D->xCoor() = double(i);
+        pts.push_back(pPoint4D);
+    }
+    pts[1]->show();
+    std::cout << "\n  " << pts.size() << " Point4D objects, "
+              << heap.allocations() << " upstream allocations";
+
+    showOp("arena.release()");
+    for(Point4D* pPoint4D : pts) {
+        pPoint4D->~Point4D();   // trivial, shown for form
+    }
+    pts.clear();
+    arena.release();
+    std::cout << "\n  " << heap.deallocations() << " upstream deallocations\n";
+}
+
+/*-- compare new/delete, arena, and pool for single Point4D objects --*/
+
+void benchPoint4DAlloc() {
+    using clock = std::chrono::high_resolution_clock;
+
+    showNote("benchmark Point4D allocation: new vs arena vs pool");
+    const size_t count = 1000000;
+    std::vector<Point4D*> pts(count);
+    double check = 0.0;
+    auto ms = [](auto start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+    std::cout << "\n  " << count << " Point4D objects, made then freed";
+
+    /*-- global heap, counted --*/
+    CountingResource globalHeap(std::pmr::new_delete_resource());
+    auto start = clock::now();
+    {
+        std::pmr::polymorphic_allocator<Point4D> alloc(&globalHeap);
+        for(size_t i = 0; i < count; ++i) {
+            pts[i] = alloc.new_object<Point4D>();
+            pts[i]->xCoor() = double(i);
+        }
+        check += pts[count - 1]->xCoor();
+        for(size_t i = 0; i < count; ++i) {
+            alloc.delete_object(pts[i]);
+        }
+    }
+    std::cout << "\n  new/delete:      " << ms(start) << " ms, "
+              << globalHeap.allocations() + globalHeap.deallocations() << " heap calls";
+
+    /*-- monotonic arena, one release --*/
+    CountingResource arenaHeap;
+    start = clock::now();
+    {
+        std::pmr::monotonic_buffer_resource arena(&arenaHeap);
+        std::pmr::polymorphic_allocator<Point4D> alloc(&arena);
+        for(size_t i = 0; i < count; ++i) {
+            pts[i] = alloc.new_object<Point4D>();
+            pts[i]->xCoor() = double(i);
+        }
+        check += pts[count - 1]->xCoor();
+    }
+    std::cout << "\n  monotonic arena: " << ms(start) << " ms, "
+              << arenaHeap.allocations() + arenaHeap.deallocations() << " heap calls";
+
+    /*-- pool, objects freed one at a time --*/
+    CountingResource poolHeap;
+    start = clock::now();
+    {
+        std::pmr::unsynchronized_pool_resource pool(point4DPoolOptions(), &poolHeap);
+        std::pmr::polymorphic_allocator<Point4D> alloc(&pool);
+        for(size_t i = 0; i < count; ++i) {
+            pts[i] = alloc.new_object<Point4D>();
+            pts[i]->xCoor() = double(i);
+        }
+        check += pts[count - 1]->xCoor();
+        for(size_t i = 0; i < count; ++i) {
+            alloc.delete_object(pts[i]);
+        }
+    }
+    std::cout << "\n  pool resource:   " << ms(start) << " ms, "
+              << poolHeap.allocations() + poolHeap.deallocations() << " heap calls"
+              << "  (check " << check << ")\n";
+}
+#endif
@@ -0,0 +1,327 @@
+/*-------------------------------------------------------------------
+  Point4DBatch.h defines a packed space-time record and batch
+  containers for it
+  - PackedPoint4D holds x, y, z and an int64 time in nanoseconds
+    since the epoch, 32 bytes aligned to 32, so one record fills
+    one AVX register
+  - Point4DBatch stores records contiguously, array of structs,
+    and Point4DColumns stores x, y, z, t as separate columns,
+    structure of arrays; both start on a cache line
+  - toColumns() and toBatch() convert between them, four records
+    at a time with a 4 x 4 register transpose where the CPU
+    supports AVX, otherwise with a scalar loop
+*/
+#ifndef Point4DBatchHeader
+#define Point4DBatchHeader
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #define POINT4D_BATCH_AVX 1
+  #include <immintrin.h>
+#else
+  #define POINT4D_BATCH_AVX 0     // MSVC and other targets use the scalar loops
+#endif
+
+/*-----------------------------------------------
+  Allocator returning storage aligned to Align
+  bytes, for std::vector
+*/
+template<typename T, size_t Align>
+struct AlignedAllocator {
+  using value_type = T;
+  template<typename U>
+  struct rebind { using other = AlignedAllocator<U, Align>; };
+
+  AlignedAllocator() = default;
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+  }
+  void deallocate(T* p, size_t) {
+    ::operator delete(p, std::align_val_t(Align));
+  }
+  friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) { return true; }
+};
+constexpr size_t cacheLine = 64;
+
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, cacheLine>>;
+
+/*-------------------------------------------------------------------
+  PackedPoint4D is a trivially copyable space-time record
+  - t counts nanoseconds since the epoch, about 292 years of range
+    each side of 1970
+*/
+struct alignas(32) PackedPoint4D {
+  double x = 0.0;
+  double y = 0.0;
+  double z = 0.0;
+  std::int64_t t = 0;
+
+  static std::int64_t nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+  }
+  static PackedPoint4D from(const Point4D& pt) {
+    return { pt.xCoor(), pt.yCoor(), pt.zCoor(), std::int64_t(pt.tCoor()) * 1000000000 };
+  }
+  /* Point4D keeps whole seconds, rounded toward the past */
+  Point4D toPoint4D() const {
+    Point4D pt;
+    pt.xCoor() = x;
+    pt.yCoor() = y;
+    pt.zCoor() = z;
+    std::int64_t s = t / 1000000000;
+    pt.tCoor() = std::time_t(t % 1000000000 < 0 ? s - 1 : s);
+    return pt;
+  }
+};
+static_assert(sizeof(PackedPoint4D) == 32 && alignof(PackedPoint4D) == 32);
+
+/*-----------------------------------------------
+  Point4DColumns holds one aligned column per
+  coordinate, equal lengths
+*/
+struct Point4DColumns {
+  AlignedVector<double> x;
+  AlignedVector<double> y;
+  AlignedVector<double> z;
+  AlignedVector<std::int64_t> t;
+
+  size_t size() const { return x.size(); }
+  void resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    t.resize(n);
+  }
+};
+
+/*-------------------------------------------------------------------
+  Point4DBatch holds PackedPoint4D records contiguously
+*/
+class Point4DBatch {
+public:
+  using value_type = PackedPoint4D;
+  using iterator = AlignedVector<PackedPoint4D>::iterator;
+  using const_iterator = AlignedVector<PackedPoint4D>::const_iterator;
+
+  Point4DBatch() = default;
+  explicit Point4DBatch(const std::vector<Point4D>& pts);
+
+  void reserve(size_t n) { recs.reserve(n); }
+  void resize(size_t n) { recs.resize(n); }
+  void clear() { recs.clear(); }
+  size_t size() const { return recs.size(); }
+  bool empty() const { return recs.empty(); }
+
+  void push_back(const PackedPoint4D& rec) { recs.push_back(rec); }
+  void push_back(const Point4D& pt) { recs.push_back(PackedPoint4D::from(pt)); }
+
+  PackedPoint4D& operator[](size_t i) { return recs[i]; }
+  const PackedPoint4D& operator[](size_t i) const { return recs[i]; }
+  PackedPoint4D* data() { return recs.data(); }
+  const PackedPoint4D* data() const { return recs.data(); }
+  iterator begin() { return recs.begin(); }
+  iterator end() { return recs.end(); }
+  const_iterator begin() const { return recs.begin(); }
+  const_iterator end() const { return recs.end(); }
+private:
+  AlignedVector<PackedPoint4D> recs;
+};
+
+inline Point4DBatch::Point4DBatch(const std::vector<Point4D>& pts) {
+  recs.reserve(pts.size());
+  for(const auto& pt : pts) {
+    recs.push_back(PackedPoint4D::from(pt));
+  }
+}
+
+/*-------------------------------------------------------------------
+  AoS <-> SoA conversion
+  - records and columns are aligned, so full groups of four use
+    aligned 32 byte loads and stores
+  - t moves through double registers bit for bit, no arithmetic
+    touches it
+*/
+namespace Point4DBatchDetail {
+
+  inline void toColumnsScalar(const PackedPoint4D* in, Point4DColumns& out, size_t b, size_t e) {
+    for(size_t i = b; i < e; ++i) {
+      out.x[i] = in[i].x;
+      out.y[i] = in[i].y;
+      out.z[i] = in[i].z;
+      out.t[i] = in[i].t;
+    }
+  }
+  inline void toBatchScalar(const Point4DColumns& in, PackedPoint4D* out, size_t b, size_t e) {
+    for(size_t i = b; i < e; ++i) {
+      out[i] = { in.x[i], in.y[i], in.z[i], in.t[i] };
+    }
+  }
+
+#if POINT4D_BATCH_AVX
+  inline bool hasAvx() {
+    static const bool avx = __builtin_cpu_supports("avx");
+    return avx;
+  }
+  /* rows r0..r3 are records, results are x, y, z, t of four records */
+  __attribute__((target("avx")))
+  inline size_t toColumnsAvx(const PackedPoint4D* in, Point4DColumns& out, size_t n) {
+    const double* src = reinterpret_cast<const double*>(in);
+    double* t = reinterpret_cast<double*>(out.t.data());
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m256d r0 = _mm256_load_pd(src + 4 * i);
+      __m256d r1 = _mm256_load_pd(src + 4 * i + 4);
+      __m256d r2 = _mm256_load_pd(src + 4 * i + 8);
+      __m256d r3 = _mm256_load_pd(src + 4 * i + 12);
+      __m256d a0 = _mm256_unpacklo_pd(r0, r1);     // x0 x1 z0 z1
+      __m256d a1 = _mm256_unpackhi_pd(r0, r1);     // y0 y1 t0 t1
+      __m256d a2 = _mm256_unpacklo_pd(r2, r3);     // x2 x3 z2 z3
+      __m256d a3 = _mm256_unpackhi_pd(r2, r3);     // y2 y3 t2 t3
+      _mm256_store_pd(out.x.data() + i, _mm256_permute2f128_pd(a0, a2, 0x20));
+      _mm256_store_pd(out.z.data() + i, _mm256_permute2f128_pd(a0, a2, 0x31));
+      _mm256_store_pd(out.y.data() + i, _mm256_permute2f128_pd(a1, a3, 0x20));
+      _mm256_store_pd(t + i, _mm256_permute2f128_pd(a1, a3, 0x31));
+    }
+    return i;
+  }
+  __attribute__((target("avx")))
+  inline size_t toBatchAvx(const Point4DColumns& in, PackedPoint4D* out, size_t n) {
+    const double* t = reinterpret_cast<const double*>(in.t.data());
+    double* dst = reinterpret_cast<double*>(out);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m256d x = _mm256_load_pd(in.x.data() + i);
+      __m256d y = _mm256_load_pd(in.y.data() + i);
+      __m256d z = _mm256_load_pd(in.z.data() + i);
+      __m256d w = _mm256_load_pd(t + i);
+      __m256d a0 = _mm256_unpacklo_pd(x, y);       // x0 y0 x2 y2
+      __m256d a1 = _mm256_unpackhi_pd(x, y);       // x1 y1 x3 y3
+      __m256d a2 = _mm256_unpacklo_pd(z, w);       // z0 t0 z2 t2
+      __m256d a3 = _mm256_unpackhi_pd(z, w);       // z1 t1 z3 t3
+      _mm256_store_pd(dst + 4 * i, _mm256_permute2f128_pd(a0, a2, 0x20));
+      _mm256_store_pd(dst + 4 * i + 4, _mm256_permute2f128_pd(a1, a3, 0x20));
+      _mm256_store_pd(dst + 4 * i + 8, _mm256_permute2f128_pd(a0, a2, 0x31));
+      _mm256_store_pd(dst + 4 * i + 12, _mm256_permute2f128_pd(a1, a3, 0x31));
+    }
+    return i;
+  }
+#endif
+}
+
+inline void toColumns(const Point4DBatch& in, Point4DColumns& out, bool allowSimd = true) {
+  using namespace Point4DBatchDetail;
+  const size_t n = in.size();
+  out.resize(n);
+  size_t done = 0;
+#if POINT4D_BATCH_AVX
+  if(allowSimd && hasAvx()) {
+    done = toColumnsAvx(in.data(), out, n);
+  }
+#endif
+  toColumnsScalar(in.data(), out, done, n);
+}
+inline void toBatch(const Point4DColumns& in, Point4DBatch& out, bool allowSimd = true) {
+  using namespace Point4DBatchDetail;
+  const size_t n = in.size();
+  if(in.y.size() != n || in.z.size() != n || in.t.size() != n) {
+    throw "Point4DColumns columns differ in length";
+  }
+  out.resize(n);
+  size_t done = 0;
+#if POINT4D_BATCH_AVX
+  if(allowSimd && hasAvx()) {
+    done = toBatchAvx(in, out.data(), n);
+  }
+#endif
+  toBatchScalar(in, out.data(), done, n);
+}
+
+/*-- demonstrate packing and AoS/SoA round trip --*/
+
+void demo_Point4DBatch() {
+    showNote("packed Point4D batch with nanosecond time");
+    std::vector<Point4D> pts(3);
+    for(size_t i = 0; i < pts.size(); ++i) {
+        pts[i].xCoor() = double(i);
+        pts[i].yCoor() = 2.0 * double(i);
+        pts[i].zCoor() = -1.0;
+    }
+    Point4DBatch batch(pts);
+    batch.push_back(PackedPoint4D { 3.0, 6.0, -1.0, PackedPoint4D::nowNs() });
+    std::cout << "\n  sizeof(PackedPoint4D) = " << sizeof(PackedPoint4D)
+              << ", alignof = " << alignof(PackedPoint4D)
+              << ", sizeof(Point4D) = " << sizeof(Point4D);
+    std::cout << "\n  batch data 64-byte aligned: "
+              << (reinterpret_cast<std::uintptr_t>(batch.data()) % 64 == 0 ? "yes" : "no");
+    Point4DColumns cols;
+    toColumns(batch, cols);
+    std::cout << "\n  columns x:";
+    for(double v : cols.x) {
+        std::cout << " " << v;
+    }
+    std::cout << "\n  t[3] % 1000000000 = " << cols.t[3] % 1000000000 << " ns past the second";
+    Point4DBatch back;
+    toBatch(cols, back);
+    bool same = std::memcmp(back.data(), batch.data(), batch.size() * sizeof(PackedPoint4D)) == 0;
+    std::cout << "\n  round trip equal: " << (same ? "yes" : "no");
+    std::cout << "\n  record 0 as Point4D: " << back[0].toPoint4D().timeToString();
+}
+
+/*-- compare scalar and register-transpose conversions --*/
+
+void benchPoint4DBatchSize(size_t count, int reps) {
+    using clock = std::chrono::high_resolution_clock;
+
+    Point4DBatch batch;
+    batch.resize(count);
+    for(size_t i = 0; i < count; ++i) {
+        batch[i] = { double(i), 0.5 * double(i), -double(i), std::int64_t(i) * 1000 };
+    }
+    Point4DColumns cols;
+    Point4DBatch back;
+    toColumns(batch, cols);
+    toBatch(cols, back);
+    auto us = [reps](auto start) {
+        return std::chrono::duration<double, std::micro>(clock::now() - start).count() / reps;
+    };
+    std::cout << "\n  " << count << " records, " << count * sizeof(PackedPoint4D) / 1024
+              << " KB each way, mean of " << reps << " runs";
+    for(bool simd : { false, true }) {
+        auto start = clock::now();
+        for(int r = 0; r < reps; ++r) {
+            toColumns(batch, cols, simd);
+        }
+        double toSoa = us(start);
+        start = clock::now();
+        for(int r = 0; r < reps; ++r) {
+            toBatch(cols, back, simd);
+        }
+        double toAos = us(start);
+        std::cout << "\n    " << (simd ? "transpose" : "scalar   ") << ": AoS to SoA " << toSoa
+                  << " us, SoA to AoS " << toAos << " us";
+    }
+    bool same = std::memcmp(back.data(), batch.data(), count * sizeof(PackedPoint4D)) == 0;
+    std::cout << "\n    round trip equal: " << (same ? "yes" : "NO");
+}
+void benchPoint4DBatch() {
+    showNote("benchmark Point4D AoS <-> SoA conversion");
+    benchPoint4DBatchSize(1 << 12, 2000);      // fits in L2
+    benchPoint4DBatchSize(1 << 22, 5);         // streams from memory
+    std::cout << "\n";
+}
+#endif
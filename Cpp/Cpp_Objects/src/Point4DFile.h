@@ -0,0 +1,252 @@
+/*-------------------------------------------------------------------
+  Point4DFile.h defines a binary file format for Point4D collections
+  - uses the same 64 byte little-endian header as the Cpp_Iter
+    PointFile format, with type code 16 and dims 4
+  - records are x, y, z doubles and an int64 time, exactly the
+    layout of Point4D, so a mapped file is an array of Point4D
+  - Point4DFileView maps a file and exposes begin() and end()
+    pointers, so range-for walks a file without copying it
+*/
+#ifndef Point4DFileHeader
+#define Point4DFileHeader
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+#include <filesystem>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+/*-------------------------------------------------------------------
+  File header, see PointFile.h in Cpp_Iter
+*/
+struct Point4DHeader {
+  char magic[8];            // "BITSPTS" and a terminating null
+  std::uint32_t version;
+  std::uint32_t headerSize;
+  std::uint32_t typeCode;   // 16 for Point4D
+  std::uint32_t dims;       // 4
+  std::uint64_t count;      // points
+  std::uint64_t dataOffset; // first record
+  std::uint64_t timeOffset; // 0, times are inside records
+  std::uint32_t recordSize; // 32
+  std::uint8_t reserved[12];
+};
+static_assert(sizeof(Point4DHeader) == 64);
+
+/*-- mapping a file as Point4D records relies on this layout --*/
+static_assert(sizeof(Point4D) == 32 && sizeof(std::time_t) == 8);
+static_assert(std::is_trivially_copyable_v<Point4D>);
+static_assert(std::is_standard_layout_v<Point4D>);
+
+constexpr char point4DFileMagic[8] = "BITSPTS";
+constexpr std::uint32_t point4DFileVersion = 1;
+constexpr std::uint32_t point4DTypeCode = 16;
+
+/*-----------------------------------------------
+  Write pts to path as one header and one
+  contiguous block of records
+*/
+inline void writePoint4DFile(const std::string& path, const std::vector<Point4D>& pts) {
+  static_assert(std::endian::native == std::endian::little,
+    "Point4DFile writes little-endian hosts only");
+  Point4DHeader hdr{};
+  std::memcpy(hdr.magic, point4DFileMagic, sizeof(hdr.magic));
+  hdr.version = point4DFileVersion;
+  hdr.headerSize = sizeof(Point4DHeader);
+  hdr.typeCode = point4DTypeCode;
+  hdr.dims = 4;
+  hdr.count = pts.size();
+  hdr.dataOffset = sizeof(Point4DHeader);
+  hdr.timeOffset = 0;
+  hdr.recordSize = sizeof(Point4D);
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if(!out) {
+    throw "Point4DFile cannot open file for writing";
+  }
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char*>(pts.data()),
+            std::streamsize(pts.size() * sizeof(Point4D)));
+  if(!out) {
+    throw "Point4DFile write failed";
+  }
+}
+
+/*-------------------------------------------------------------------
+  MappedFile maps a whole file read-only
+  - move-only, unmaps in its destructor
+*/
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& path);
+  MappedFile(const MappedFile& mf) = delete;
+  MappedFile& operator=(const MappedFile& mf) = delete;
+  MappedFile(MappedFile&& mf) noexcept { swap(mf); }
+  MappedFile& operator=(MappedFile&& mf) noexcept { swap(mf); return *this; }
+  ~MappedFile() { close(); }
+
+  const std::byte* data() const { return _data; }
+  size_t size() const { return _size; }
+private:
+  void close();
+  void swap(MappedFile& mf) noexcept {
+    std::swap(_data, mf._data);
+    std::swap(_size, mf._size);
+  }
+  const std::byte* _data = nullptr;
+  size_t _size = 0;
+};
+inline MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(
+    path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+  );
+  if(file == INVALID_HANDLE_VALUE) {
+    throw "MappedFile cannot open file";
+  }
+  LARGE_INTEGER sz;
+  if(!GetFileSizeEx(file, &sz)) {
+    CloseHandle(file);
+    throw "MappedFile cannot read file size";
+  }
+  _size = size_t(sz.QuadPart);
+  if(_size > 0) {
+    HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(map != nullptr) {
+      _data = static_cast<const std::byte*>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+      CloseHandle(map);   // view keeps mapping alive
+    }
+  }
+  CloseHandle(file);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    throw "MappedFile cannot open file";
+  }
+  struct stat st;
+  if(::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw "MappedFile cannot read file size";
+  }
+  _size = size_t(st.st_size);
+  if(_size > 0) {
+    void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(p != MAP_FAILED) {
+      _data = static_cast<const std::byte*>(p);
+    }
+  }
+  ::close(fd);        // mapping outlives descriptor
+#endif
+  if(_size > 0 && _data == nullptr) {
+    throw "MappedFile cannot map file";
+  }
+}
+inline void MappedFile::close() {
+  if(_data != nullptr) {
+  #ifdef _WIN32
+    UnmapViewOfFile(_data);
+  #else
+    ::munmap(const_cast<std::byte*>(_data), _size);
+  #endif
+  }
+  _data = nullptr;
+  _size = 0;
+}
+
+/*-------------------------------------------------------------------
+  Point4DFileView maps a Point4D file read-only
+  - opening validates the header and throws a string
+    describing the first mismatch
+  - points are valid while the view lives
+*/
+class Point4DFileView {
+public:
+  explicit Point4DFileView(const std::string& path);
+
+  const Point4DHeader& header() const { return hdr; }
+  size_t size() const { return size_t(hdr.count); }
+  const Point4D& operator[](size_t i) const { return pts[i]; }
+  const Point4D* begin() const { return pts; }
+  const Point4D* end() const { return pts + size(); }
+private:
+  MappedFile file;
+  Point4DHeader hdr{};
+  const Point4D* pts = nullptr;
+};
+
+inline Point4DFileView::Point4DFileView(const std::string& path) : file(path) {
+  static_assert(std::endian::native == std::endian::little,
+    "Point4DFile reads little-endian hosts only");
+  size_t bytes = file.size();
+  if(bytes < sizeof(Point4DHeader)) {
+    throw "Point4DFile too small for header";
+  }
+  std::memcpy(&hdr, file.data(), sizeof(hdr));
+  if(std::memcmp(hdr.magic, point4DFileMagic, sizeof(hdr.magic)) != 0) {
+    throw "Point4DFile bad magic";
+  }
+  if(hdr.version == 0 || hdr.version > point4DFileVersion) {
+    throw "Point4DFile unsupported version";
+  }
+  if(hdr.headerSize != sizeof(Point4DHeader)) {
+    throw "Point4DFile unexpected header size";
+  }
+  if(hdr.typeCode != point4DTypeCode || hdr.dims != 4 || hdr.recordSize != sizeof(Point4D)) {
+    throw "Point4DFile holds a different point type";
+  }
+  if(hdr.dataOffset % alignof(Point4D) != 0 || hdr.dataOffset > bytes
+     || hdr.count > (bytes - hdr.dataOffset) / sizeof(Point4D)) {
+    throw "Point4DFile data section out of range";
+  }
+  pts = reinterpret_cast<const Point4D*>(file.data() + hdr.dataOffset);
+}
+
+/*-- demonstrate saving and mapping Point4D samples --*/
+
+void demo_Point4DFile() {
+    showNote("binary Point4D file");
+    std::vector<Point4D> pts(3);
+    for(size_t i = 0; i < pts.size(); ++i) {
+        pts[i].xCoor() = double(i);
+        pts[i].yCoor() = 2.0 * double(i);
+        pts[i].zCoor() = -1.0;
+        pts[i].tCoor() += std::time_t(60 * i);
+    }
+    auto path = (std::filesystem::temp_directory_path() / "bits_demo_point4d.bin").string();
+    writePoint4DFile(path, pts);
+    {
+        Point4DFileView view(path);
+        std::cout << "\n  " << view.size() << " points, "
+                  << std::filesystem::file_size(path) << " bytes";
+        for(auto& pt : view) {
+            std::cout << "\n  (" << pt.xCoor() << ", " << pt.yCoor() << ", "
+                      << pt.zCoor() << ")  t - t0 = "
+                      << pt.tCoor() - pts[0].tCoor();
+        }
+    }
+    std::filesystem::remove(path);
+    std::cout << "\n";
+}
+#endif
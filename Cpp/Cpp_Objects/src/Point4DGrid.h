@@ -0,0 +1,294 @@
+/*-------------------------------------------------------------------
+  Point4DGrid.h defines a uniform spatial hash grid for Point4D
+  positions, the Cpp_Objects counterpart of SpatialHash<T> in
+  Cpp_Iter
+  - cubes of side cellSize hash to a fixed number of buckets, and
+    each bucket holds the id and x, y, z of its points
+  - radius queries read only the buckets of cells overlapping the
+    query, each bucket once
+  - insert, remove, and move update one point; rebuild replaces
+    all points using several threads, for per-frame updates
+*/
+#ifndef Point4DGridHeader
+#define Point4DGridHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <chrono>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+
+/*-------------------------------------------------------------------
+  Point4DGrid indexes Point4D positions by id, time is ignored
+  - ids come from insert(), or are vector indexes after rebuild(),
+    removed ids are reused
+*/
+class Point4DGrid {
+public:
+  struct Entry {
+    double x, y, z;
+    size_t id;
+  };
+  explicit Point4DGrid(double cellSize, size_t buckets = 4096);
+
+  size_t insert(const Point4D& pt);
+  void remove(size_t id);
+  void move(size_t id, const Point4D& pt);
+  void rebuild(const std::vector<Point4D>& pts, size_t threads = 0);
+
+  template<typename F>
+  void forEachWithin(const Point4D& q, double r, F f) const;
+  std::vector<size_t> within(const Point4D& q, double r) const;
+
+  size_t size() const { return live; }
+  double cellSize() const { return cell; }
+  bool contains(size_t id) const { return id < bucketOf.size() && bucketOf[id] != npos; }
+private:
+  static constexpr size_t npos = size_t(-1);
+  using Cell = std::array<std::int64_t, 3>;
+  Cell cellOf(double x, double y, double z) const {
+    return {
+      std::int64_t(std::floor(x * inv)),
+      std::int64_t(std::floor(y * inv)),
+      std::int64_t(std::floor(z * inv))
+    };
+  }
+  size_t bucket(const Cell& c) const {
+    std::uint64_t h = std::uint64_t(c[0]) * 73856093u
+                    ^ std::uint64_t(c[1]) * 19349663u
+                    ^ std::uint64_t(c[2]) * 83492791u;
+    return size_t(h & mask);
+  }
+  size_t bucket(const Point4D& pt) const {
+    return bucket(cellOf(pt.xCoor(), pt.yCoor(), pt.zCoor()));
+  }
+  void place(size_t id, const Point4D& pt);
+  void unplace(size_t id);
+
+  double cell;
+  double inv;
+  std::uint64_t mask;
+  std::vector<std::vector<Entry>> buckets;
+  std::vector<size_t> bucketOf;   // per id, npos when free
+  std::vector<size_t> slotOf;     // per id, index in its bucket
+  std::vector<size_t> freeIds;
+  size_t live = 0;
+};
+
+inline Point4DGrid::Point4DGrid(double cellSize, size_t nBuckets) : cell(cellSize) {
+  if(!(cellSize > 0.0)) {
+    throw "Point4DGrid cell size must be positive";
+  }
+  inv = 1.0 / cellSize;
+  size_t n = 1;
+  while(n < nBuckets) {
+    n <<= 1;
+  }
+  mask = n - 1;
+  buckets.resize(n);
+}
+inline void Point4DGrid::place(size_t id, const Point4D& pt) {
+  size_t b = bucket(pt);
+  bucketOf[id] = b;
+  slotOf[id] = buckets[b].size();
+  buckets[b].push_back({ pt.xCoor(), pt.yCoor(), pt.zCoor(), id });
+}
+inline void Point4DGrid::unplace(size_t id) {
+  auto& bk = buckets[bucketOf[id]];
+  size_t slot = slotOf[id];
+  if(slot + 1 != bk.size()) {
+    bk[slot] = bk.back();
+    slotOf[bk[slot].id] = slot;
+  }
+  bk.pop_back();
+  bucketOf[id] = npos;
+}
+inline size_t Point4DGrid::insert(const Point4D& pt) {
+  size_t id;
+  if(!freeIds.empty()) {
+    id = freeIds.back();
+    freeIds.pop_back();
+  }
+  else {
+    id = bucketOf.size();
+    bucketOf.push_back(npos);
+    slotOf.push_back(0);
+  }
+  place(id, pt);
+  ++live;
+  return id;
+}
+inline void Point4DGrid::remove(size_t id) {
+  if(!contains(id)) {
+    throw "Point4DGrid remove of unknown id";
+  }
+  unplace(id);
+  freeIds.push_back(id);
+  --live;
+}
+inline void Point4DGrid::move(size_t id, const Point4D& pt) {
+  if(!contains(id)) {
+    throw "Point4DGrid move of unknown id";
+  }
+  size_t b = bucket(pt);
+  if(b == bucketOf[id]) {
+    Entry& e = buckets[b][slotOf[id]];
+    e.x = pt.xCoor();
+    e.y = pt.yCoor();
+    e.z = pt.zCoor();
+    return;
+  }
+  unplace(id);
+  place(id, pt);
+}
+/*-----------------------------------------------
+  Hash points on all threads, then let each
+  thread fill its own contiguous range of
+  buckets, so no locks are needed
+*/
+inline void Point4DGrid::rebuild(const std::vector<Point4D>& pts, size_t threads) {
+  if(threads == 0) {
+    threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  const size_t count = pts.size();
+  bucketOf.assign(count, 0);
+  slotOf.assign(count, 0);
+  freeIds.clear();
+  live = count;
+
+  auto runParts = [threads](auto fn) {
+    std::vector<std::thread> pool;
+    for(size_t t = 1; t < threads; ++t) {
+      pool.emplace_back(fn, t);
+    }
+    fn(0);
+    for(auto& th : pool) {
+      th.join();
+    }
+  };
+  runParts([&](size_t t) {
+    size_t i0 = count * t / threads, i1 = count * (t + 1) / threads;
+    for(size_t i = i0; i < i1; ++i) {
+      bucketOf[i] = bucket(pts[i]);
+    }
+  });
+  const size_t nb = buckets.size();
+  runParts([&](size_t t) {
+    size_t b0 = nb * t / threads, b1 = nb * (t + 1) / threads;
+    for(size_t b = b0; b < b1; ++b) {
+      buckets[b].clear();
+    }
+    for(size_t i = 0; i < count; ++i) {
+      size_t b = bucketOf[i];
+      if(b >= b0 && b < b1) {
+        slotOf[i] = buckets[b].size();
+        buckets[b].push_back({ pts[i].xCoor(), pts[i].yCoor(), pts[i].zCoor(), i });
+      }
+    }
+  });
+}
+/*-----------------------------------------------
+  f(id, squared distance) for each point within
+  r of q, in no particular order
+  - when the query cube covers at least as many
+    cells as there are buckets, scans every bucket
+  - throws if r is negative or not finite
+*/
+template<typename F>
+void Point4DGrid::forEachWithin(const Point4D& q, double r, F f) const {
+  if(!(r >= 0.0) || !std::isfinite(r)) {
+    throw "Point4DGrid radius must be finite and non-negative";
+  }
+  const double r2 = r * r;
+  auto test = [&](size_t b) {
+    for(const Entry& e : buckets[b]) {
+      double dx = e.x - q.xCoor(), dy = e.y - q.yCoor(), dz = e.z - q.zCoor();
+      double d2 = dx * dx + dy * dy + dz * dz;
+      if(d2 <= r2) {
+        f(e.id, d2);
+      }
+    }
+  };
+  /* cell bounds counted in double first, so no cast can overflow */
+  const double lo[3] = { q.xCoor() - r, q.yCoor() - r, q.zCoor() - r };
+  const double hi[3] = { q.xCoor() + r, q.yCoor() + r, q.zCoor() + r };
+  const double limit = double(std::int64_t(1) << 52);
+  double cells = 1.0;
+  for(size_t d = 0; d < 3; ++d) {
+    double a = std::floor(lo[d] * inv), b = std::floor(hi[d] * inv);
+    cells = std::abs(a) < limit && std::abs(b) < limit ? cells * (b - a + 1.0) : limit;
+  }
+  if(!(cells < double(buckets.size()))) {
+    for(size_t b = 0; b < buckets.size(); ++b) {
+      test(b);
+    }
+    return;
+  }
+  Cell c0 = cellOf(lo[0], lo[1], lo[2]);
+  Cell c1 = cellOf(hi[0], hi[1], hi[2]);
+  /* distinct cells can share a bucket, visit each bucket once */
+  std::array<size_t, 64> small;
+  std::vector<size_t> large;
+  size_t* seen = small.data();
+  size_t nCells = size_t(cells);
+  if(nCells > small.size()) {
+    large.resize(nCells);
+    seen = large.data();
+  }
+  size_t nSeen = 0;
+  for(auto x = c0[0]; x <= c1[0]; ++x) {
+    for(auto y = c0[1]; y <= c1[1]; ++y) {
+      for(auto z = c0[2]; z <= c1[2]; ++z) {
+        seen[nSeen++] = bucket({ x, y, z });
+      }
+    }
+  }
+  std::sort(seen, seen + nSeen);
+  nSeen = size_t(std::unique(seen, seen + nSeen) - seen);
+  for(size_t i = 0; i < nSeen; ++i) {
+    test(seen[i]);
+  }
+}
+inline std::vector<size_t> Point4DGrid::within(const Point4D& q, double r) const {
+  std::vector<size_t> ids;
+  forEachWithin(q, r, [&](size_t id, double) {
+    ids.push_back(id);
+  });
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+/*-- demonstrate proximity checks on moving Point4D samples --*/
+
+void demo_Point4DGrid() {
+    showNote("spatial hash grid for Point4D");
+    std::vector<Point4D> pts(6);
+    for(size_t i = 0; i < pts.size(); ++i) {
+        pts[i].xCoor() = 0.4 * double(i);
+        pts[i].yCoor() = 0.0;
+        pts[i].zCoor() = 1.0;
+    }
+    Point4DGrid grid(1.0);
+    grid.rebuild(pts, 2);
+    auto show = [&](const std::string& what) {
+        std::cout << "\n  " << what << ", within 0.5 of pts[0]:";
+        for(size_t id : grid.within(pts[0], 0.5)) {
+            std::cout << " " << id;
+        }
+    };
+    show("rebuilt");
+    pts[5].xCoor() = 0.1;
+    grid.move(5, pts[5]);
+    show("moved 5");
+    grid.remove(1);
+    show("removed 1");
+    std::cout << "\n";
+}
+#endif
@@ -0,0 +1,685 @@
+/*-------------------------------------------------------------------
+  Point4DKinematics.h derives velocity, speed and acceleration from
+  time-ordered space-time samples
+  - times are int64 nanoseconds, as in PackedPoint4D, so sample
+    rates above one per second are handled exactly
+  - Forward uses the next sample for velocity, Central a quadratic
+    through the neighbors on each side, SavitzkyGolay a least
+    squares quadratic over 2 * half + 1 samples, which smooths
+    noise; all three allow uneven sample spacing
+  - Forward and Central use closed-form three-point weights, only
+    SavitzkyGolay solves for its fit
+  - kinematics() works on whole columns, interior points in blocks
+    whose loops run down columns and vectorize
+  - KinematicsStream keeps one window of samples in a ring and emits each
+    result as soon as its window is complete, the values kinematics()
+    computes for the whole sequence
+*/
+#ifndef Point4DKinematicsHeader
+#define Point4DKinematicsHeader
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+#include "Point4DBatch.h"
+
+#if POINT4D_BATCH_AVX
+  #define KINEMATICS_INLINE __attribute__((always_inline)) inline    // into the AVX copy too
+#else
+  #define KINEMATICS_INLINE inline
+#endif
+
+enum class Difference { Forward, Central, SavitzkyGolay };
+
+/* velocity in units per second, acceleration in units per second squared */
+struct KinematicSample {
+  std::int64_t t = 0;
+  double vx = 0.0, vy = 0.0, vz = 0.0;
+  double ax = 0.0, ay = 0.0, az = 0.0;
+
+  double speed() const { return std::sqrt(vx * vx + vy * vy + vz * vz); }
+};
+
+/*-----------------------------------------------
+  Kinematics holds one aligned column per
+  quantity, equal lengths
+*/
+struct Kinematics {
+  AlignedVector<std::int64_t> t;
+  AlignedVector<double> seconds;        // after t[0], the times the fits use
+  AlignedVector<double> vx, vy, vz, speed;
+  AlignedVector<double> ax, ay, az;
+
+  size_t size() const { return t.size(); }
+  void resize(size_t n) {
+    t.resize(n);
+    seconds.resize(n);
+    vx.resize(n);
+    vy.resize(n);
+    vz.resize(n);
+    speed.resize(n);
+    ax.resize(n);
+    ay.resize(n);
+    az.resize(n);
+  }
+  KinematicSample operator[](size_t i) const {
+    return { t[i], vx[i], vy[i], vz[i], ax[i], ay[i], az[i] };
+  }
+  void set(size_t i, const KinematicSample& k) {
+    t[i] = k.t;
+    vx[i] = k.vx;
+    vy[i] = k.vy;
+    vz[i] = k.vz;
+    speed[i] = k.speed();
+    ax[i] = k.ax;
+    ay[i] = k.ay;
+    az[i] = k.az;
+  }
+};
+
+namespace KinematicsDetail {
+
+  /* samples a result needs before and after its own */
+  struct Shape {
+    size_t before;
+    size_t after;
+    size_t width() const { return before + after + 1; }
+  };
+  inline Shape shapeOf(Difference how, size_t half) {
+    switch(how) {
+      case Difference::Forward:
+        return { 0, 2 };      // acceleration needs two samples ahead
+      case Difference::Central:
+        return { 1, 1 };
+      default:
+        if(half == 0) {
+          throw "Savitzky-Golay half width must be at least 1";
+        }
+        return { half, half };
+    }
+  }
+  inline double seconds(std::int64_t t, std::int64_t origin) {
+    return double(t - origin) * 1e-9;
+  }
+  /*-----------------------------------------------
+    Least squares c0 + c1 u + c2 u^2 from sums
+    s_k of u^k and m_k of value * u^k, where u is
+    time from the evaluated sample over the window
+    span h; derivatives are c1 / h and 2 c2 / h^2
+    - the sums of u^k depend only on times, so the
+      weights of m0, m1, m2 serve all three axes
+  */
+  struct Weights {
+    double v0, v1, v2;
+    double a0, a1, a2;
+  };
+  KINEMATICS_INLINE Weights weights(double s0, double s1, double s2, double s3, double s4, double invh) {
+    const double c00 = s2 * s4 - s3 * s3;
+    const double c01 = s2 * s3 - s1 * s4;
+    const double c02 = s1 * s3 - s2 * s2;
+    const double c11 = s0 * s4 - s2 * s2;
+    const double c12 = s1 * s2 - s0 * s3;
+    const double c22 = s0 * s2 - s1 * s1;
+    const double sv = invh / (s0 * c00 + s1 * c01 + s2 * c02);
+    const double sa = 2.0 * sv * invh;
+    return { c01 * sv, c11 * sv, c12 * sv, c02 * sa, c12 * sa, c22 * sa };
+  }
+  /* quadratic over samples lo..hi, derivatives at sample i */
+  inline KinematicSample fitPoint(
+    const double* s, const double* x, const double* y, const double* z,
+    size_t lo, size_t hi, size_t i
+  ) {
+    const double invh = 1.0 / (s[hi] - s[lo]);
+    double s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    double x0 = 0, x1 = 0, x2 = 0, y0 = 0, y1 = 0, y2 = 0, z0 = 0, z1 = 0, z2 = 0;
+    for(size_t j = lo; j <= hi; ++j) {
+      double u = (s[j] - s[i]) * invh, u2 = u * u;
+      s1 += u; s2 += u2; s3 += u2 * u; s4 += u2 * u2;
+      x0 += x[j]; x1 += x[j] * u; x2 += x[j] * u2;
+      y0 += y[j]; y1 += y[j] * u; y2 += y[j] * u2;
+      z0 += z[j]; z1 += z[j] * u; z2 += z[j] * u2;
+    }
+    const Weights w = weights(double(hi - lo + 1), s1, s2, s3, s4, invh);
+    KinematicSample k;
+    k.vx = w.v0 * x0 + w.v1 * x1 + w.v2 * x2;
+    k.vy = w.v0 * y0 + w.v1 * y1 + w.v2 * y2;
+    k.vz = w.v0 * z0 + w.v1 * z1 + w.v2 * z2;
+    k.ax = w.a0 * x0 + w.a1 * x1 + w.a2 * x2;
+    k.ay = w.a0 * y0 + w.a1 * y1 + w.a2 * y2;
+    k.az = w.a0 * z0 + w.a1 * z1 + w.a2 * z2;
+    return k;
+  }
+  /* weights for a block as columns, w[0..2] for v and w[3..5] for a */
+  template<size_t Block>
+  struct BlockWeights {
+    alignas(64) double w[6][Block];
+  };
+  /* v and a of one axis for a block, into m0 and m1, then out */
+  template<size_t Block>
+  KINEMATICS_INLINE void applyBlock(
+    const BlockWeights<Block>& bw, double* m0, double* m1, const double* m2, double* v, double* a
+  ) {
+    const auto& w = bw.w;
+    for(size_t k = 0; k < Block; ++k) {
+      double vk = w[0][k] * m0[k] + w[1][k] * m1[k] + w[2][k] * m2[k];
+      double ak = w[3][k] * m0[k] + w[4][k] * m1[k] + w[5][k] * m2[k];
+      m0[k] = vk;
+      m1[k] = ak;
+    }
+    std::copy(m0, m0 + Block, v);
+    std::copy(m1, m1 + Block, a);
+  }
+  /*-----------------------------------------------
+    fitPoint for every i in [b, e), each window
+    i - before .. i + after inside the data
+    - sums for a block of samples are columns, one
+      pass down them per window offset, the same
+      additions in the same order as fitPoint
+    - blocks are full, a fixed trip count the
+      compiler vectorizes; the rest go to fitPoint
+  */
+  KINEMATICS_INLINE size_t fitBlocks(
+    const double* s, const double* x, const double* y, const double* z,
+    Shape sh, size_t b, size_t e, Kinematics& out
+  ) {
+    constexpr size_t block = 128;
+    alignas(64) double invh[block], s1[block], s2[block], s3[block], s4[block];
+    alignas(64) double x0[block], x1[block], x2[block];
+    alignas(64) double y0[block], y1[block], y2[block];
+    alignas(64) double z0[block], z1[block], z2[block];
+    BlockWeights<block> bw;
+    const double s0 = double(sh.width());
+    size_t b0 = b;
+    for(; b0 + block <= e; b0 += block) {
+      const double* sc = s + b0;
+      const double* lo = s + b0 - sh.before;
+      const double* hi = s + b0 + sh.after;
+      for(size_t k = 0; k < block; ++k) {
+        invh[k] = 1.0 / (hi[k] - lo[k]);
+        s1[k] = s2[k] = s3[k] = s4[k] = 0.0;
+        x0[k] = x1[k] = x2[k] = y0[k] = y1[k] = y2[k] = z0[k] = z1[k] = z2[k] = 0.0;
+      }
+      for(size_t off = 0; off < sh.width(); ++off) {
+        const size_t j = b0 - sh.before + off;
+        const double* sj = s + j;
+        const double* xj = x + j;
+        const double* yj = y + j;
+        const double* zj = z + j;
+        for(size_t k = 0; k < block; ++k) {
+          double u = (sj[k] - sc[k]) * invh[k], u2 = u * u;
+          s1[k] += u; s2[k] += u2; s3[k] += u2 * u; s4[k] += u2 * u2;
+          x0[k] += xj[k]; x1[k] += xj[k] * u; x2[k] += xj[k] * u2;
+          y0[k] += yj[k]; y1[k] += yj[k] * u; y2[k] += yj[k] * u2;
+          z0[k] += zj[k]; z1[k] += zj[k] * u; z2[k] += zj[k] * u2;
+        }
+      }
+      for(size_t k = 0; k < block; ++k) {
+        Weights wk = weights(s0, s1[k], s2[k], s3[k], s4[k], invh[k]);
+        bw.w[0][k] = wk.v0; bw.w[1][k] = wk.v1; bw.w[2][k] = wk.v2;
+        bw.w[3][k] = wk.a0; bw.w[4][k] = wk.a1; bw.w[5][k] = wk.a2;
+      }
+      applyBlock<block>(bw, x0, x1, x2, out.vx.data() + b0, out.ax.data() + b0);
+      applyBlock<block>(bw, y0, y1, y2, out.vy.data() + b0, out.ay.data() + b0);
+      applyBlock<block>(bw, z0, z1, z2, out.vz.data() + b0, out.az.data() + b0);
+    }
+    return b0;
+  }
+#if POINT4D_BATCH_AVX
+  /* the same loops compiled for 32 byte vectors, no FMA, so no change in rounding */
+  __attribute__((target("avx")))
+  inline size_t fitBlocksAvx(
+    const double* s, const double* x, const double* y, const double* z,
+    Shape sh, size_t b, size_t e, Kinematics& out
+  ) {
+    return fitBlocks(s, x, y, z, sh, b, e, out);
+  }
+#endif
+  /* Forward velocity, (c[b] - c[a]) / (s[b] - s[a]) */
+  inline double slope(const double* s, const double* c, size_t a, size_t b) {
+    return (c[b] - c[a]) / (s[b] - s[a]);
+  }
+  /*-----------------------------------------------
+    Weights of samples sw[0], sw[1], sw[2] for the
+    derivatives at sw[at] of the quadratic through
+    them, Lagrange's form; three samples fit their
+    quadratic exactly, so no least squares solve
+    - u is time from the evaluated sample, the
+      acceleration weights do not depend on at
+  */
+  KINEMATICS_INLINE Weights threePoint(const double* sw, size_t at) {
+    const double u0 = sw[0] - sw[at], u1 = sw[1] - sw[at], u2 = sw[2] - sw[at];
+    const double d01 = u0 - u1, d02 = u0 - u2, d12 = u1 - u2;
+    const double r = 1.0 / (d01 * d02 * d12);           // one division for all three
+    const double q0 = d12 * r, q1 = -d02 * r, q2 = d01 * r;
+    return { -(u1 + u2) * q0, -(u0 + u2) * q1, -(u0 + u1) * q2, 2.0 * q0, 2.0 * q1, 2.0 * q2 };
+  }
+  /* derivatives at sample lo + at from samples lo .. lo + 2, Forward velocity from slope */
+  inline KinematicSample threePointAt(
+    Difference how, const double* s, const double* x, const double* y, const double* z,
+    size_t lo, size_t at
+  ) {
+    const Weights w = threePoint(s + lo, at);
+    const double *xw = x + lo, *yw = y + lo, *zw = z + lo;
+    KinematicSample k;
+    k.vx = w.v0 * xw[0] + w.v1 * xw[1] + w.v2 * xw[2];
+    k.vy = w.v0 * yw[0] + w.v1 * yw[1] + w.v2 * yw[2];
+    k.vz = w.v0 * zw[0] + w.v1 * zw[1] + w.v2 * zw[2];
+    k.ax = w.a0 * xw[0] + w.a1 * xw[1] + w.a2 * xw[2];
+    k.ay = w.a0 * yw[0] + w.a1 * yw[1] + w.a2 * yw[2];
+    k.az = w.a0 * zw[0] + w.a1 * zw[1] + w.a2 * zw[2];
+    if(how == Difference::Forward) {
+      const size_t a = lo + std::min<size_t>(at, 1);    // last sample looks back
+      k.vx = slope(s, x, a, a + 1);
+      k.vy = slope(s, y, a, a + 1);
+      k.vz = slope(s, z, a, a + 1);
+    }
+    return k;
+  }
+  /*-----------------------------------------------
+    v and a of one axis for a block, c and s from
+    the first window; results go to local arrays,
+    then out, so the loop needs no alias checks
+  */
+  template<Difference How, size_t Block>
+  KINEMATICS_INLINE void applyThree(
+    const BlockWeights<Block>& bw, const double* s, const double* c, double* v, double* a
+  ) {
+    const auto& w = bw.w;
+    alignas(64) double vk[Block], ak[Block];
+    for(size_t k = 0; k < Block; ++k) {
+      if constexpr(How == Difference::Forward) {
+        vk[k] = (c[k + 1] - c[k]) / (s[k + 1] - s[k]);
+      }
+      else {
+        vk[k] = w[0][k] * c[k] + w[1][k] * c[k + 1] + w[2][k] * c[k + 2];
+      }
+      ak[k] = w[3][k] * c[k] + w[4][k] * c[k + 1] + w[5][k] * c[k + 2];
+    }
+    std::copy(vk, vk + Block, v);
+    std::copy(ak, ak + Block, a);
+  }
+  /*-----------------------------------------------
+    threePointAt for every i in [b, e), window
+    i - at .. i - at + 2 inside the data, with at
+    1 for Central and 0 for Forward
+    - weights for a block are columns, then one
+      loop per axis; the rest go to threePointAt
+  */
+  template<Difference How>
+  KINEMATICS_INLINE size_t threePointBlocks(
+    const double* s, const double* x, const double* y, const double* z,
+    size_t b, size_t e, Kinematics& out
+  ) {
+    constexpr size_t block = 128, at = How == Difference::Central ? 1 : 0;
+    BlockWeights<block> bw;
+    size_t b0 = b;
+    for(; b0 + block <= e; b0 += block) {
+      const double* sw = s + b0 - at;
+      for(size_t k = 0; k < block; ++k) {
+        Weights wk = threePoint(sw + k, at);
+        bw.w[0][k] = wk.v0; bw.w[1][k] = wk.v1; bw.w[2][k] = wk.v2;
+        bw.w[3][k] = wk.a0; bw.w[4][k] = wk.a1; bw.w[5][k] = wk.a2;
+      }
+      applyThree<How, block>(bw, sw, x + b0 - at, out.vx.data() + b0, out.ax.data() + b0);
+      applyThree<How, block>(bw, sw, y + b0 - at, out.vy.data() + b0, out.ay.data() + b0);
+      applyThree<How, block>(bw, sw, z + b0 - at, out.vz.data() + b0, out.az.data() + b0);
+    }
+    return b0;
+  }
+#if POINT4D_BATCH_AVX
+  __attribute__((target("avx")))
+  inline size_t forwardBlocksAvx(
+    const double* s, const double* x, const double* y, const double* z,
+    size_t b, size_t e, Kinematics& out
+  ) {
+    return threePointBlocks<Difference::Forward>(s, x, y, z, b, e, out);
+  }
+  __attribute__((target("avx")))
+  inline size_t centralBlocksAvx(
+    const double* s, const double* x, const double* y, const double* z,
+    size_t b, size_t e, Kinematics& out
+  ) {
+    return threePointBlocks<Difference::Central>(s, x, y, z, b, e, out);
+  }
+#endif
+  /* block kernels for how over [b, e), returns where the partial block starts */
+  inline size_t fitInterior(
+    Difference how, const double* s, const double* x, const double* y, const double* z,
+    Shape sh, size_t b, size_t e, Kinematics& out
+  ) {
+#if POINT4D_BATCH_AVX
+    if(Point4DBatchDetail::hasAvx()) {
+      switch(how) {
+        case Difference::Forward:
+          return forwardBlocksAvx(s, x, y, z, b, e, out);
+        case Difference::Central:
+          return centralBlocksAvx(s, x, y, z, b, e, out);
+        default:
+          return fitBlocksAvx(s, x, y, z, sh, b, e, out);
+      }
+    }
+#endif
+    switch(how) {
+      case Difference::Forward:
+        return threePointBlocks<Difference::Forward>(s, x, y, z, b, e, out);
+      case Difference::Central:
+        return threePointBlocks<Difference::Central>(s, x, y, z, b, e, out);
+      default:
+        return fitBlocks(s, x, y, z, sh, b, e, out);
+    }
+  }
+  /* derivatives at sample i from the window starting at lo */
+  inline KinematicSample fitAt(
+    Difference how, Shape sh, const double* s, const double* x, const double* y, const double* z,
+    size_t lo, size_t i
+  ) {
+    if(how == Difference::SavitzkyGolay) {
+      return fitPoint(s, x, y, z, lo, lo + sh.width() - 1, i);
+    }
+    return threePointAt(how, s, x, y, z, lo, i - lo);
+  }
+}
+
+/*-------------------------------------------------------------------
+  Kinematics of every sample in columns
+  - samples near the ends use the first or last full window
+  - out is resized, its storage reused across calls
+  - throws if times do not strictly increase or there are fewer
+    samples than one window
+*/
+inline void kinematics(
+  const Point4DColumns& in, Kinematics& out, Difference how = Difference::Central, size_t half = 2
+) {
+  using namespace KinematicsDetail;
+  const Shape sh = shapeOf(how, half);
+  const size_t n = in.size();
+  if(in.y.size() != n || in.z.size() != n || in.t.size() != n) {
+    throw "Point4DColumns columns differ in length";
+  }
+  if(n < sh.width()) {
+    throw "kinematics needs at least one full window of samples";
+  }
+  for(size_t i = 1; i < n; ++i) {
+    if(in.t[i] <= in.t[i - 1]) {
+      throw "kinematics needs strictly increasing times";
+    }
+  }
+  out.resize(n);
+  std::copy(in.t.begin(), in.t.end(), out.t.begin());
+  for(size_t i = 0; i < n; ++i) {
+    out.seconds[i] = seconds(in.t[i], in.t[0]);
+  }
+  const double *ps = out.seconds.data(), *px = in.x.data(), *py = in.y.data(), *pz = in.z.data();
+
+  auto fit = [&](size_t lo, size_t i) {
+    KinematicSample k = fitAt(how, sh, ps, px, py, pz, lo, i);
+    k.t = in.t[i];
+    out.set(i, k);
+  };
+  for(size_t i = 0; i < sh.before; ++i) {
+    fit(0, i);
+  }
+  const size_t tail = fitInterior(how, ps, px, py, pz, sh, sh.before, n - sh.after, out);
+  for(size_t i = tail; i < n - sh.after; ++i) {
+    fit(i - sh.before, i);
+  }
+  for(size_t i = n - sh.after; i < n; ++i) {
+    fit(n - sh.width(), i);
+  }
+  for(size_t i = 0; i < n; ++i) {
+    out.speed[i] = std::sqrt(out.vx[i] * out.vx[i] + out.vy[i] * out.vy[i] + out.vz[i] * out.vz[i]);
+  }
+}
+inline Kinematics kinematics(const Point4DColumns& in, Difference how = Difference::Central, size_t half = 2) {
+  Kinematics out;
+  kinematics(in, out, how, half);
+  return out;
+}
+inline Kinematics kinematics(const Point4DBatch& in, Difference how = Difference::Central, size_t half = 2) {
+  Point4DColumns cols;
+  toColumns(in, cols);
+  return kinematics(cols, how, half);
+}
+/* Point4D times are whole seconds, so samples must be at least a second apart */
+inline Kinematics kinematics(const std::vector<Point4D>& in, Difference how = Difference::Central, size_t half = 2) {
+  return kinematics(Point4DBatch(in), how, half);
+}
+
+/*-------------------------------------------------------------------
+  KinematicsStream computes kinematics online
+  - push() takes samples in time order and calls emit with each
+    KinematicSample whose window is complete, after() samples
+    behind the newest
+  - flush() emits the last after() results and starts a new stream
+*/
+class KinematicsStream {
+public:
+  explicit KinematicsStream(Difference how = Difference::Central, size_t half = 2)
+    : how(how), shape(KinematicsDetail::shapeOf(how, half)) {
+    const size_t ring = 2 * shape.width();
+    t.resize(ring);
+    s.resize(ring);
+    x.resize(ring);
+    y.resize(ring);
+    z.resize(ring);
+  }
+
+  size_t window() const { return shape.width(); }
+  size_t after() const { return shape.after; }
+  size_t count() const { return pushed; }
+
+  template<typename Emit>
+  void push(const PackedPoint4D& rec, Emit&& emit);
+  template<typename Emit>
+  void push(const Point4D& pt, Emit&& emit) { push(PackedPoint4D::from(pt), emit); }
+  template<typename Emit>
+  void flush(Emit&& emit);
+private:
+  template<typename Emit>
+  void emitAt(size_t local, Emit& emit);
+
+  Difference how;
+  KinematicsDetail::Shape shape;
+  std::int64_t origin = 0;
+  size_t pushed = 0;
+  size_t head = 0, filled = 0;          // window is [head, head + filled), oldest first
+  std::vector<std::int64_t> t;          // each sample at slot and slot + window(),
+  std::vector<double> s, x, y, z;       // so the window is contiguous
+};
+
+template<typename Emit>
+void KinematicsStream::push(const PackedPoint4D& rec, Emit&& emit) {
+  if(pushed > 0 && rec.t <= t[head + filled - 1]) {
+    throw "KinematicsStream needs strictly increasing times";
+  }
+  if(pushed == 0) {
+    origin = rec.t;
+  }
+  const size_t w = shape.width();
+  size_t slot = filled;
+  if(filled == w) {
+    slot = head;                        // overwrite the oldest
+    head = head + 1 == w ? 0 : head + 1;
+  }
+  else {
+    ++filled;
+  }
+  for(size_t at : { slot, slot + w }) {
+    t[at] = rec.t;
+    s[at] = KinematicsDetail::seconds(rec.t, origin);
+    x[at] = rec.x;
+    y[at] = rec.y;
+    z[at] = rec.z;
+  }
+  ++pushed;
+  if(pushed == shape.width()) {
+    for(size_t local = 0; local <= shape.before; ++local) {   // leading samples share the first window
+      emitAt(local, emit);
+    }
+  }
+  else if(pushed > shape.width()) {
+    emitAt(shape.before, emit);
+  }
+}
+template<typename Emit>
+void KinematicsStream::flush(Emit&& emit) {
+  if(pushed >= shape.width()) {
+    for(size_t local = shape.before + 1; local < shape.width(); ++local) {
+      emitAt(local, emit);
+    }
+  }
+  pushed = 0;
+  head = filled = 0;
+}
+template<typename Emit>
+void KinematicsStream::emitAt(size_t local, Emit& emit) {
+  using namespace KinematicsDetail;
+  KinematicSample k = fitAt(how, shape, s.data() + head, x.data() + head, y.data() + head, z.data() + head, 0, local);
+  k.t = t[head + local];
+  emit(static_cast<const KinematicSample&>(k));
+}
+
+/*-- demonstrate differences, batch and streaming --*/
+
+void demo_Point4DKinematics() {
+    showNote("Point4D velocity and acceleration");
+    /* x = t^2, y = 3t, uneven spacing; quadratics are fit exactly */
+    Point4DBatch batch;
+    const std::int64_t start = PackedPoint4D::nowNs();
+    double sec = 0.0;
+    for(double step : { 0.1, 0.15, 0.1, 0.2, 0.1, 0.25, 0.1 }) {
+        batch.push_back(PackedPoint4D { sec * sec, 3.0 * sec, 1.0, start + std::llround(sec * 1e9) });
+        sec += step;
+    }
+    const size_t i = 3;
+    const double ti = double(batch[i].t - start) * 1e-9;
+    std::cout << "\n  at t0 + " << ti << " s exact: v = (" << 2.0 * ti << ", 3, 0), a = (2, 0, 0)";
+    for(auto how : { Difference::Forward, Difference::Central, Difference::SavitzkyGolay }) {
+        KinematicSample k = kinematics(batch, how)[i];
+        std::cout << "\n  " << (how == Difference::Forward ? "forward:       "
+                              : how == Difference::Central ? "central:       " : "Savitzky-Golay:")
+                  << " v = (" << k.vx << ", " << k.vy << ", " << k.vz << "), a = ("
+                  << k.ax << ", " << k.ay << ", " << k.az << "), speed " << k.speed();
+    }
+    Kinematics whole = kinematics(batch, Difference::SavitzkyGolay);
+    KinematicsStream stream(Difference::SavitzkyGolay);
+    size_t emitted = 0, same = 0;
+    auto check = [&](const KinematicSample& k) {
+        KinematicSample w = whole[emitted++];
+        same += k.t == w.t && k.vx == w.vx && k.ax == w.ax;
+    };
+    for(const auto& rec : batch) {
+        stream.push(rec, check);
+    }
+    std::cout << "\n  stream emitted " << emitted << " while pushing " << batch.size()
+              << ", window " << stream.window();
+    stream.flush(check);
+    std::cout << "\n  after flush " << emitted << ", equal to batch: " << (same == batch.size() ? "yes" : "no");
+    std::cout << "\n";
+}
+
+/*-- compare an ad-hoc record loop with column kernels and the stream --*/
+
+void benchPoint4DKinematics() {
+    using clock = std::chrono::high_resolution_clock;
+
+    showNote("benchmark Point4D kinematics");
+    /* helix sampled near 100 Hz with jittered times and position noise */
+    const size_t n = 1 << 22;
+    const double radius = 10.0, omega = 0.5, climb = 1.0, noise = 1e-3;
+    const double trueSpeed = std::sqrt(radius * radius * omega * omega + climb * climb);
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<std::int64_t> jitter(8000000, 12000000);
+    std::normal_distribution<double> err(0.0, noise);
+    Point4DBatch batch;
+    batch.reserve(n);
+    std::int64_t t = PackedPoint4D::nowNs(), origin = t;
+    for(size_t i = 0; i < n; ++i) {
+        double s = double(t - origin) * 1e-9;
+        batch.push_back(PackedPoint4D {
+            radius * std::cos(omega * s) + err(gen), radius * std::sin(omega * s) + err(gen),
+            climb * s + err(gen), t
+        });
+        t += jitter(gen);
+    }
+    Point4DColumns cols;
+    toColumns(batch, cols);
+    std::cout << "\n  " << n << " samples, noise " << noise << ", true speed " << trueSpeed;
+
+    auto ms = [](auto start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+    auto rmsSpeedError = [&](auto speedAt) {
+        double sum = 0.0;
+        for(size_t i = 0; i < n; ++i) {
+            double d = speedAt(i) - trueSpeed;
+            sum += d * d;
+        }
+        return std::sqrt(sum / double(n));
+    };
+
+    /* what callers wrote before: records in, records out, one sample at a time */
+    std::vector<KinematicSample> adHoc(n);
+    auto start = clock::now();
+    for(size_t i = 0; i + 1 < n; ++i) {
+        const PackedPoint4D& p = batch[i];
+        const PackedPoint4D& q = batch[i + 1];
+        double dt = double(q.t - p.t) * 1e-9;
+        adHoc[i] = { p.t, (q.x - p.x) / dt, (q.y - p.y) / dt, (q.z - p.z) / dt };
+        if(i > 0) {
+            adHoc[i - 1].ax = (adHoc[i].vx - adHoc[i - 1].vx) / dt;
+            adHoc[i - 1].ay = (adHoc[i].vy - adHoc[i - 1].vy) / dt;
+            adHoc[i - 1].az = (adHoc[i].vz - adHoc[i - 1].vz) / dt;
+        }
+    }
+    adHoc[n - 1] = adHoc[n - 2];
+    double adHocMs = ms(start);
+    std::cout << "\n  ad-hoc record loop, forward:  " << adHocMs << " ms, speed rms error "
+              << rmsSpeedError([&](size_t i) { return adHoc[i].speed(); });
+
+    struct Case { const char* name; Difference how; size_t half; };
+    const Case cases[] = {
+        { "columns, forward:            ", Difference::Forward, 0 },
+        { "columns, central:            ", Difference::Central, 0 },
+        { "columns, Savitzky-Golay 5:   ", Difference::SavitzkyGolay, 2 },
+        { "columns, Savitzky-Golay 21:  ", Difference::SavitzkyGolay, 10 },
+    };
+    Kinematics k, sg;
+    kinematics(cols, k);                  // first touch of the output pages, untimed
+    for(const Case& c : cases) {
+        start = clock::now();
+        kinematics(cols, k, c.how, c.half);
+        double kMs = ms(start);
+        std::cout << "\n  " << c.name << kMs << " ms, speed rms error "
+                  << rmsSpeedError([&](size_t i) { return k.speed[i]; });
+        if(c.how == Difference::SavitzkyGolay && c.half == 2) {
+            sg = k;
+        }
+    }
+
+    KinematicsStream stream(Difference::SavitzkyGolay, 2);
+    size_t emitted = 0;
+    double diff = 0.0;
+    auto sink = [&](const KinematicSample& k) {
+        diff = std::max({ diff, std::abs(k.vx - sg.vx[emitted]), std::abs(k.az - sg.az[emitted]) });
+        ++emitted;
+    };
+    start = clock::now();
+    for(const auto& rec : batch) {
+        stream.push(rec, sink);
+    }
+    stream.flush(sink);
+    double streamMs = ms(start);
+    std::cout << "\n  stream, Savitzky-Golay 5:    " << streamMs << " ms, "
+              << n / streamMs / 1000.0 << " M samples/s"
+              << "\n  stream matches columns: " << (emitted == n && diff < 1e-9 ? "yes" : "NO")
+              << ", max difference " << diff << "\n";
+}
+#endif
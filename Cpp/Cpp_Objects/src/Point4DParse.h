@@ -0,0 +1,272 @@
+/*-------------------------------------------------------------------
+  Point4DParse.h defines multi-threaded text ingestion for Point4D
+  - each line holds x, y, z and an integer time_t, separated by
+    commas, semicolons, spaces, or tabs
+  - text is split into chunks at line boundaries, lines are counted
+    per chunk so each chunk knows where its points go, then chunks
+    are parsed on separate threads with from_chars straight into
+    one preallocated vector
+  - malformed lines are skipped and reported by byte offset and
+    line number
+*/
+#ifndef Point4DParseHeader
+#define Point4DParseHeader
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+#include "Point4DFile.h"
+
+/*-----------------------------------------------
+  One rejected line
+  - offset is the byte offset of the line start
+  - line numbers start at 1
+*/
+struct ParseError {
+  size_t offset;
+  size_t line;
+  std::string reason;
+};
+struct Point4DParseResult {
+  std::vector<Point4D> points;
+  std::vector<ParseError> errors;
+  size_t lines = 0;                        // lines read, good or bad
+};
+
+/*-----------------------------------------------
+  Parse one line into pt
+  - returns nullptr on success, else the reason
+*/
+inline const char* parsePoint4DLine(const char* p, const char* e, Point4D& pt) {
+  auto isSep = [](char c) {
+    return c == ',' || c == ' ' || c == '\t' || c == ';';
+  };
+  auto skip = [&]() {
+    while(p != e && isSep(*p)) {
+      ++p;
+    }
+  };
+  auto field = [&](auto& value) -> const char* {
+    skip();
+    if(p == e) {
+      return "too few values";
+    }
+    auto [next, ec] = std::from_chars(p, e, value);
+    if(ec != std::errc() || (next != e && !isSep(*next))) {
+      return "bad number";
+    }
+    p = next;
+    return nullptr;
+  };
+  long long t = 0;
+  const char* reason = nullptr;
+  if((reason = field(pt.xCoor())) || (reason = field(pt.yCoor()))
+     || (reason = field(pt.zCoor())) || (reason = field(t))) {
+    return reason;
+  }
+  pt.tCoor() = std::time_t(t);
+  skip();
+  return p == e ? nullptr : "too many values";
+}
+
+/*-----------------------------------------------
+  Parse text into Point4D instances
+  - threads == 0 uses hardware concurrency
+  - points appear in input order, whatever the
+    thread count
+  - blank lines and lines starting with # are
+    skipped without error
+*/
+inline Point4DParseResult parsePoint4Ds(std::string_view text, size_t threads = 0) {
+  Point4DParseResult result;
+  if(threads == 0) {
+    threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  /*-- chunk boundaries, one per thread, each just past a newline --*/
+  const size_t minChunk = 1 << 16;
+  size_t nChunks = std::max<size_t>(1, std::min(threads, text.size() / minChunk));
+  std::vector<size_t> bounds { 0 };
+  for(size_t c = 1; c < nChunks; ++c) {
+    size_t at = std::max(bounds.back(), text.size() * c / nChunks);
+    size_t nl = text.find('\n', at);
+    if(nl == std::string_view::npos) {
+      break;
+    }
+    bounds.push_back(nl + 1);
+  }
+  bounds.push_back(text.size());
+  nChunks = bounds.size() - 1;
+
+  auto runChunks = [nChunks](auto fn) {
+    std::vector<std::thread> pool;
+    for(size_t c = 1; c < nChunks; ++c) {
+      pool.emplace_back(fn, c);
+    }
+    fn(0);                                 // this thread takes chunk 0
+    for(auto& th : pool) {
+      th.join();
+    }
+  };
+
+  /*-- pass 1: lines per chunk --*/
+  std::vector<size_t> firstLine(nChunks + 1, 0);
+  runChunks([&](size_t c) {
+    const char* p = text.data() + bounds[c];
+    const char* e = text.data() + bounds[c + 1];
+    size_t n = size_t(std::count(p, e, '\n'));
+    firstLine[c + 1] = (p != e && e[-1] != '\n') ? n + 1 : n;
+  });
+  for(size_t c = 0; c < nChunks; ++c) {
+    firstLine[c + 1] += firstLine[c];
+  }
+  result.lines = firstLine[nChunks];
+  result.points.resize(result.lines);
+
+  /*-- pass 2: parse chunks into their own slots --*/
+  std::vector<size_t> good(nChunks, 0);
+  std::vector<std::vector<ParseError>> errors(nChunks);
+  runChunks([&](size_t c) {
+    const char* base = text.data();
+    const char* p = base + bounds[c];
+    const char* end = base + bounds[c + 1];
+    size_t line = firstLine[c];
+    size_t slot = firstLine[c];
+    while(p < end) {
+      const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+      const char* e = nl ? nl : end;
+      const char* le = (e != p && e[-1] == '\r') ? e - 1 : e;
+      ++line;
+      const char* q = p;
+      while(q != le && (*q == ' ' || *q == '\t')) {
+        ++q;
+      }
+      if(q != le && *q != '#') {
+        const char* reason = parsePoint4DLine(p, le, result.points[slot]);
+        if(reason == nullptr) {
+          ++slot;
+        }
+        else {
+          errors[c].push_back({ size_t(p - base), line, reason });
+        }
+      }
+      p = e + 1;
+    }
+    good[c] = slot - firstLine[c];
+  });
+
+  /*-- close gaps left by skipped lines --*/
+  size_t filled = good[0];
+  for(size_t c = 1; c < nChunks; ++c) {
+    if(filled != firstLine[c]) {
+      std::move(
+        result.points.begin() + firstLine[c],
+        result.points.begin() + firstLine[c] + good[c],
+        result.points.begin() + filled
+      );
+    }
+    filled += good[c];
+  }
+  result.points.resize(filled);
+  for(auto& errs : errors) {
+    result.errors.insert(result.errors.end(), errs.begin(), errs.end());
+  }
+  return result;
+}
+/*-----------------------------------------------
+  Parse a text file by mapping it
+*/
+inline Point4DParseResult parsePoint4DFile(const std::string& path, size_t threads = 0) {
+  MappedFile file(path);
+  std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+  return parsePoint4Ds(text, threads);
+}
+
+/*-- demonstrate parsing Point4D text with malformed lines --*/
+
+void demo_Point4DParse() {
+    showNote("parse text into Point4D");
+    std::string text =
+      "# x, y, z, t\n"
+      "1.0, 2.0, 3.0, 1700000000\n"
+      "1.5 2.5 3.5 1700000060\r\n"
+      "4.0, 5.0, 6.0\n"
+      "7.0, 8.0, 9.0, soon\n";
+    auto res = parsePoint4Ds(text);
+    std::cout << "\n  " << res.lines << " lines, " << res.points.size() << " points";
+    for(auto& pt : res.points) {
+        std::cout << "\n  (" << pt.xCoor() << ", " << pt.yCoor() << ", "
+                  << pt.zCoor() << ", " << pt.tCoor() << ")";
+    }
+    for(auto& err : res.errors) {
+        std::cout << "\n  line " << err.line << " at offset " << err.offset
+                  << ": " << err.reason;
+    }
+    std::cout << "\n";
+}
+
+/*-- compare chunked from_chars parsing with iostreams --*/
+
+void benchPoint4DParse() {
+    using clock = std::chrono::high_resolution_clock;
+
+    showNote("benchmark Point4D text ingestion vs iostream");
+    const size_t count = 1000000;
+    std::string text;
+    text.reserve(count * 48);
+    char buf[32];
+    for(size_t i = 0; i < count; ++i) {
+        double v[3] = { 0.001 * double(i), 1.0 / double(i + 1), -0.25 * double(i) };
+        for(double d : v) {
+            auto r = std::to_chars(buf, buf + sizeof(buf), d);
+            text.append(buf, r.ptr);
+            text.push_back(',');
+        }
+        auto r = std::to_chars(buf, buf + sizeof(buf), 1700000000LL + (long long)i);
+        text.append(buf, r.ptr);
+        text.push_back('\n');
+    }
+    auto path = (std::filesystem::temp_directory_path() / "bits_bench_point4d.txt").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(text.data(), std::streamsize(text.size()));
+    }
+    double mb = double(text.size()) / 1.0e6;
+    std::cout << "\n  " << count << " lines, " << size_t(mb) << " MB";
+
+    auto start = clock::now();
+    std::vector<Point4D> base;
+    {
+        std::ifstream in(path);
+        Point4D pt;
+        char c1, c2, c3;
+        while(in >> pt.xCoor() >> c1 >> pt.yCoor() >> c2 >> pt.zCoor() >> c3 >> pt.tCoor()) {
+            base.push_back(pt);
+        }
+    }
+    double baseMs = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::cout << "\n  iostream:   " << baseMs << " ms, " << mb / baseMs * 1000.0 << " MB/s";
+
+    start = clock::now();
+    auto res = parsePoint4DFile(path);
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    bool same = res.points.size() == base.size() && res.errors.empty();
+    for(size_t i = 0; same && i < base.size(); ++i) {
+        same = std::memcmp(&base[i], &res.points[i], sizeof(Point4D)) == 0;
+    }
+    std::cout << "\n  from_chars: " << ms << " ms, " << mb / ms * 1000.0 << " MB/s, "
+              << std::max<size_t>(1, std::thread::hardware_concurrency()) << " threads"
+              << "  (" << (same ? "matches" : "DIFFERS") << ")\n";
+    std::filesystem::remove(path);
+}
+#endif
@@ -0,0 +1,520 @@
+/*-------------------------------------------------------------------
+  Point4DQueue.h defines bounded lock-free queues for handing
+  trivially copyable records, such as Point4D or PackedPoint4D,
+  from producer threads to analytics threads
+  - SpscQueue<T, W> serves one producer and one consumer; each
+    side owns one index and caches the other's, so most calls
+    touch no shared cache line
+  - MpmcQueue<T, W> serves any number of each, using a sequence
+    number per slot, after D. Vyukov's bounded queue
+  - both push and pop batches, claiming a run of slots with one
+    atomic update, and keep head and tail on separate cache lines
+  - W chooses how full and empty waits behave: SpinWait spins and
+    yields, BlockWait sleeps on std::atomic::wait after a short spin
+  - close() ends waiting; pops drain what is left, then fail
+*/
+#ifndef Point4DQueueHeader
+#define Point4DQueueHeader
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+#include "Point4DBatch.h"
+
+template<typename T>
+concept QueueRecord = std::is_trivially_copyable_v<T>;
+
+/*-----------------------------------------------
+  Wait strategies, waitUntil(ready) returns once
+  ready() is true, notify() wakes waiters after
+  the other side made progress
+*/
+struct SpinWait {
+  template<typename Ready>
+  void waitUntil(Ready ready) {
+    for(unsigned i = 0; !ready(); ++i) {
+      if(i >= 64) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  void notify() {}
+};
+/*-----------------------------------------------
+  A waiter registers in sleepers before its last
+  ready() check; notify() touches the shared count
+  only when someone sleeps. Fences on both sides
+  order the notifier's publish before its read of
+  sleepers and the waiter's registration before
+  its ready() loads, so either the notifier sees
+  the sleeper or the sleeper's ready() sees the
+  publish.
+*/
+struct BlockWait {
+  template<typename Ready>
+  void waitUntil(Ready ready) {
+    for(unsigned i = 0; i < 128; ++i) {
+      if(ready()) {
+        return;
+      }
+      if(i >= 64) {
+        std::this_thread::yield();
+      }
+    }
+    while(true) {
+      ++sleepers;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::uint32_t seen = count.load();
+      if(ready()) {
+        --sleepers;
+        return;
+      }
+      count.wait(seen);
+      --sleepers;
+    }
+  }
+  void notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleepers.load(std::memory_order_relaxed) > 0) {
+      count.fetch_add(1);
+      count.notify_all();
+    }
+  }
+private:
+  alignas(cacheLine) std::atomic<std::uint32_t> count { 0 };
+  std::atomic<std::uint32_t> sleepers { 0 };
+};
+
+inline size_t queueCapacity(size_t requested) {
+  if(requested < 2) {
+    throw "queue capacity must be at least 2";
+  }
+  size_t cap = 2;
+  while(cap < requested) {
+    cap <<= 1;
+  }
+  return cap;
+}
+
+/*-------------------------------------------------------------------
+  SpscQueue<T, W>, capacity rounded up to a power of two
+  - try and batch calls never wait, they return how many items
+    moved; push, pushAll, pop, and popWait wait through W
+*/
+template<QueueRecord T, typename W = SpinWait>
+class SpscQueue {
+public:
+  explicit SpscQueue(size_t capacity)
+    : cap(queueCapacity(capacity)), mask(cap - 1), slots(new T[cap]) {}
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  size_t pushBatch(const T* items, size_t n);
+  size_t popBatch(T* out, size_t max);
+  bool tryPush(const T& item) { return pushBatch(&item, 1) == 1; }
+  bool tryPop(T& item) { return popBatch(&item, 1) == 1; }
+
+  size_t pushAll(const T* items, size_t n);   // less than n only if closed
+  bool push(const T& item) { return pushAll(&item, 1) == 1; }
+  size_t popWait(T* out, size_t max);         // 0 only if closed and empty
+  bool pop(T& item) { return popWait(&item, 1) == 1; }
+
+  void close() {
+    isClosed.store(true);
+    notEmpty.notify();
+    notFull.notify();
+  }
+  bool closed() const { return isClosed.load(); }
+  size_t capacity() const { return cap; }
+private:
+  const size_t cap;
+  const size_t mask;
+  std::unique_ptr<T[]> slots;
+  alignas(cacheLine) std::atomic<size_t> head { 0 };   // consumer's
+  size_t tailCache = 0;
+  alignas(cacheLine) std::atomic<size_t> tail { 0 };   // producer's
+  size_t headCache = 0;
+  alignas(cacheLine) std::atomic<bool> isClosed { false };
+  W notEmpty;
+  W notFull;
+};
+
+template<QueueRecord T, typename W>
+size_t SpscQueue<T, W>::pushBatch(const T* items, size_t n) {
+  const size_t t = tail.load(std::memory_order_relaxed);
+  if(cap - (t - headCache) < n) {
+    headCache = head.load(std::memory_order_acquire);
+  }
+  const size_t k = std::min(n, cap - (t - headCache));
+  if(k == 0) {
+    return 0;
+  }
+  const size_t first = std::min(k, cap - (t & mask));       // up to the wrap
+  std::memcpy(&slots[t & mask], items, first * sizeof(T));
+  std::memcpy(&slots[0], items + first, (k - first) * sizeof(T));
+  tail.store(t + k, std::memory_order_release);
+  notEmpty.notify();
+  return k;
+}
+template<QueueRecord T, typename W>
+size_t SpscQueue<T, W>::popBatch(T* out, size_t max) {
+  const size_t h = head.load(std::memory_order_relaxed);
+  if(tailCache - h < max) {
+    tailCache = tail.load(std::memory_order_acquire);
+  }
+  const size_t k = std::min(max, tailCache - h);
+  if(k == 0) {
+    return 0;
+  }
+  const size_t first = std::min(k, cap - (h & mask));
+  std::memcpy(out, &slots[h & mask], first * sizeof(T));
+  std::memcpy(out + first, &slots[0], (k - first) * sizeof(T));
+  head.store(h + k, std::memory_order_release);
+  notFull.notify();
+  return k;
+}
+template<QueueRecord T, typename W>
+size_t SpscQueue<T, W>::pushAll(const T* items, size_t n) {
+  size_t done = 0;
+  while(done < n && !closed()) {
+    notFull.waitUntil([&]() {
+      size_t k = pushBatch(items + done, n - done);
+      done += k;
+      return k > 0 || closed();
+    });
+  }
+  return done;
+}
+template<QueueRecord T, typename W>
+size_t SpscQueue<T, W>::popWait(T* out, size_t max) {
+  size_t k = 0;
+  notEmpty.waitUntil([&]() {
+    k = popBatch(out, max);
+    return k > 0 || closed();
+  });
+  return k > 0 ? k : popBatch(out, max);   // items pushed just before close
+}
+
+/*-------------------------------------------------------------------
+  MpmcQueue<T, W>, capacity rounded up to a power of two
+  - slot i of lap L holds seq L * cap + i when free and one more
+    when full; a producer claims the run of free slots at tail
+    with one compare-exchange, a consumer the run of full slots
+    at head, so a batch never interleaves with another thread's
+  - same interface as SpscQueue
+*/
+template<QueueRecord T, typename W = SpinWait>
+class MpmcQueue {
+public:
+  explicit MpmcQueue(size_t capacity);
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  size_t pushBatch(const T* items, size_t n);
+  size_t popBatch(T* out, size_t max);
+  bool tryPush(const T& item) { return pushBatch(&item, 1) == 1; }
+  bool tryPop(T& item) { return popBatch(&item, 1) == 1; }
+
+  size_t pushAll(const T* items, size_t n);
+  bool push(const T& item) { return pushAll(&item, 1) == 1; }
+  size_t popWait(T* out, size_t max);
+  bool pop(T& item) { return popWait(&item, 1) == 1; }
+
+  void close() {
+    isClosed.store(true);
+    notEmpty.notify();
+    notFull.notify();
+  }
+  bool closed() const { return isClosed.load(); }
+  size_t capacity() const { return cap; }
+private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T item;
+  };
+  const size_t cap;
+  const size_t mask;
+  std::unique_ptr<Cell[]> cells;
+  alignas(cacheLine) std::atomic<size_t> head { 0 };
+  alignas(cacheLine) std::atomic<size_t> tail { 0 };
+  alignas(cacheLine) std::atomic<bool> isClosed { false };
+  W notEmpty;
+  W notFull;
+};
+
+template<QueueRecord T, typename W>
+MpmcQueue<T, W>::MpmcQueue(size_t capacity)
+  : cap(queueCapacity(capacity)), mask(cap - 1), cells(new Cell[cap]) {
+  for(size_t i = 0; i < cap; ++i) {
+    cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+}
+template<QueueRecord T, typename W>
+size_t MpmcQueue<T, W>::pushBatch(const T* items, size_t n) {
+  size_t pos = tail.load(std::memory_order_relaxed);
+  while(true) {
+    size_t k = 0;
+    while(k < n && cells[(pos + k) & mask].seq.load(std::memory_order_acquire) == pos + k) {
+      ++k;
+    }
+    if(k == 0) {
+      size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+      if(std::intptr_t(seq - pos) < 0) {
+        return 0;                              // full
+      }
+      pos = tail.load(std::memory_order_relaxed);   // another producer claimed pos
+      continue;
+    }
+    if(tail.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+      for(size_t i = 0; i < k; ++i) {
+        Cell& c = cells[(pos + i) & mask];
+        std::memcpy(&c.item, items + i, sizeof(T));
+        c.seq.store(pos + i + 1, std::memory_order_release);
+      }
+      notEmpty.notify();
+      return k;
+    }
+  }
+}
+template<QueueRecord T, typename W>
+size_t MpmcQueue<T, W>::popBatch(T* out, size_t max) {
+  size_t pos = head.load(std::memory_order_relaxed);
+  while(true) {
+    size_t k = 0;
+    while(k < max && cells[(pos + k) & mask].seq.load(std::memory_order_acquire) == pos + k + 1) {
+      ++k;
+    }
+    if(k == 0) {
+      size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+      if(std::intptr_t(seq - (pos + 1)) < 0) {
+        return 0;                              // empty, or next item not yet written
+      }
+      pos = head.load(std::memory_order_relaxed);
+      continue;
+    }
+    if(head.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+      for(size_t i = 0; i < k; ++i) {
+        Cell& c = cells[(pos + i) & mask];
+        std::memcpy(out + i, &c.item, sizeof(T));
+        c.seq.store(pos + i + cap, std::memory_order_release);
+      }
+      notFull.notify();
+      return k;
+    }
+  }
+}
+template<QueueRecord T, typename W>
+size_t MpmcQueue<T, W>::pushAll(const T* items, size_t n) {
+  size_t done = 0;
+  while(done < n && !closed()) {
+    notFull.waitUntil([&]() {
+      size_t k = pushBatch(items + done, n - done);
+      done += k;
+      return k > 0 || closed();
+    });
+  }
+  return done;
+}
+template<QueueRecord T, typename W>
+size_t MpmcQueue<T, W>::popWait(T* out, size_t max) {
+  size_t k = 0;
+  notEmpty.waitUntil([&]() {
+    k = popBatch(out, max);
+    return k > 0 || closed();
+  });
+  return k > 0 ? k : popBatch(out, max);
+}
+
+/*-- demonstrate producers feeding one consumer --*/
+
+void demo_Point4DQueue() {
+    showNote("lock-free Point4D queues");
+    MpmcQueue<Point4D, BlockWait> q(64);
+    const size_t producers = 3, perProducer = 1000;
+    std::vector<std::thread> threads;
+    for(size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p]() {
+            Point4D pt;
+            for(size_t i = 0; i < perProducer; ++i) {
+                pt.xCoor() = double(p);
+                pt.yCoor() = double(i);
+                q.push(pt);
+            }
+        });
+    }
+    std::thread closer([&]() {
+        for(size_t p = 0; p < producers; ++p) {
+            threads[p].join();
+        }
+        q.close();
+    });
+    std::vector<size_t> got(producers, 0);
+    bool ordered = true;
+    std::vector<double> last(producers, -1.0);
+    Point4D buf[16];
+    while(size_t k = q.popWait(buf, 16)) {
+        for(size_t i = 0; i < k; ++i) {
+            size_t p = size_t(buf[i].xCoor());
+            ordered = ordered && buf[i].yCoor() > last[p];
+            last[p] = buf[i].yCoor();
+            ++got[p];
+        }
+    }
+    closer.join();
+    std::cout << "\n  capacity " << q.capacity() << ", received per producer:";
+    for(size_t g : got) {
+        std::cout << " " << g;
+    }
+    std::cout << "\n  each producer's points arrive in order: " << (ordered ? "yes" : "no");
+
+    SpscQueue<Point4D> s(8);
+    std::vector<Point4D> batch(5);
+    size_t in = s.pushBatch(batch.data(), batch.size());
+    in += s.pushBatch(batch.data(), batch.size());
+    std::cout << "\n  SpscQueue(8): two batches of 5 push " << in
+              << " items, popBatch(16) returns " << s.popBatch(buf, 16) << "\n";
+}
+
+/*-- throughput and latency at 1, 4, and 16 producers --*/
+
+/* the current hand-off: producers append under a lock, consumer swaps */
+class MutexVectorQueue {
+public:
+  size_t pushAll(const PackedPoint4D* items, size_t n) {
+    std::lock_guard<std::mutex> lock(mtx);
+    items_.insert(items_.end(), items, items + n);
+    return n;
+  }
+  void take(std::vector<PackedPoint4D>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mtx);
+    out.swap(items_);
+  }
+private:
+  std::mutex mtx;
+  std::vector<PackedPoint4D> items_;
+};
+
+struct QueueBenchResult {
+  double recsPerSec;
+  std::int64_t p50;
+  std::int64_t p99;
+};
+
+inline std::int64_t steadyNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/*-----------------------------------------------
+  producers stamp t with steady time at push, the
+  consumer samples now - t as latency
+*/
+template<typename Q, typename Consume>
+QueueBenchResult runQueueBench(Q& q, size_t producers, size_t batch, size_t total, Consume consume) {
+  const size_t perProducer = total / producers;
+  std::vector<std::int64_t> lat;
+  lat.reserve(total / 8 + 1);
+  std::vector<std::thread> threads;
+  const std::int64_t start = steadyNs();
+  for(size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p]() {
+      std::vector<PackedPoint4D> recs(batch);
+      for(size_t i = 0; i < perProducer; i += batch) {
+        size_t n = std::min(batch, perProducer - i);
+        std::int64_t now = steadyNs();
+        for(size_t j = 0; j < n; ++j) {
+          recs[j] = { double(p), double(i + j), 0.0, now };
+        }
+        q.pushAll(recs.data(), n);
+      }
+    });
+  }
+  size_t received = 0, sample = 0;
+  consume(received, [&](const PackedPoint4D& r) {
+    if((++sample & 7) == 0) {
+      lat.push_back(steadyNs() - r.t);
+    }
+  }, producers * perProducer);
+  const std::int64_t elapsed = steadyNs() - start;
+  for(auto& th : threads) {
+    th.join();
+  }
+  std::sort(lat.begin(), lat.end());
+  QueueBenchResult res;
+  res.recsPerSec = double(received) * 1e9 / double(elapsed);
+  res.p50 = lat.empty() ? 0 : lat[lat.size() / 2];
+  res.p99 = lat.empty() ? 0 : lat[lat.size() * 99 / 100];
+  return res;
+}
+template<typename Q>
+QueueBenchResult benchLockFree(Q& q, size_t producers, size_t batch, size_t total) {
+  return runQueueBench(q, producers, batch, total,
+    [&q, batch](size_t& received, auto onRecord, size_t expected) {
+      std::vector<PackedPoint4D> buf(std::max<size_t>(batch, 64));
+      while(received < expected) {
+        size_t k = q.popWait(buf.data(), buf.size());
+        for(size_t i = 0; i < k; ++i) {
+          onRecord(buf[i]);
+        }
+        received += k;
+      }
+    });
+}
+inline QueueBenchResult benchMutexVector(size_t producers, size_t batch, size_t total) {
+  MutexVectorQueue q;
+  return runQueueBench(q, producers, batch, total,
+    [&q](size_t& received, auto onRecord, size_t expected) {
+      std::vector<PackedPoint4D> buf;
+      while(received < expected) {
+        q.take(buf);
+        if(buf.empty()) {
+          std::this_thread::yield();
+        }
+        for(const auto& r : buf) {
+          onRecord(r);
+        }
+        received += buf.size();
+      }
+    });
+}
+inline void showQueueResult(const std::string& name, size_t batch, const QueueBenchResult& r) {
+  std::cout << "\n    " << name << ", batch " << batch << ": "
+            << r.recsPerSec / 1e6 << " M records/s, latency p50 "
+            << r.p50 / 1000 << " us, p99 " << r.p99 / 1000 << " us";
+}
+
+void benchPoint4DQueue() {
+    showNote("benchmark Point4D queues: mutex vector vs lock-free");
+    const size_t total = 1 << 20;
+    const size_t capacity = 4096;
+    std::cout << "\n  " << total << " PackedPoint4D records per run, capacity " << capacity
+              << ", " << std::thread::hardware_concurrency() << " hardware threads";
+    for(size_t producers : { size_t(1), size_t(4), size_t(16) }) {
+        std::cout << "\n  " << producers << " producer" << (producers > 1 ? "s" : "") << ", 1 consumer";
+        for(size_t batch : { size_t(1), size_t(32) }) {
+            showQueueResult("mutex + vector   ", batch, benchMutexVector(producers, batch, total));
+            if(producers == 1) {
+                SpscQueue<PackedPoint4D, SpinWait> spsc(capacity);
+                showQueueResult("Spsc, SpinWait   ", batch, benchLockFree(spsc, 1, batch, total));
+            }
+            MpmcQueue<PackedPoint4D, SpinWait> spin(capacity);
+            showQueueResult("Mpmc, SpinWait   ", batch, benchLockFree(spin, producers, batch, total));
+            MpmcQueue<PackedPoint4D, BlockWait> block(capacity);
+            showQueueResult("Mpmc, BlockWait  ", batch, benchLockFree(block, producers, batch, total));
+        }
+    }
+    std::cout << "\n";
+}
+#endif
@@ -3,11 +3,15 @@
   - Point4D represents points with three double spatial coordinates
     and std::time_t time coordinate.
 */
-#pragma warning(disable:4996) // warning about ctime use - see below
+#ifndef PointsObjHeader
+#define PointsObjHeader
+
 #include <iostream>
 #include <vector>
+#include <string>
 #include <chrono>
 #include <ctime>
+#include "TimeFormat.h"
 /*-------------------------------------------------------------------
   Point4D class represents a point in a 4-Dimensional space-time
   lattice. Simple enough for illustration, but still useful.
@@ -27,13 +31,18 @@ public:
   Point4D& operator=(const Point4D& pt) = default;  // copy assignment
   Point4D& operator=(Point4D&& pt) = default;       // move assignment
   ~Point4D() = default;                             // dtor
-  std::string timeToString();
+  std::string timeToString() const;
+  size_t timeToChars(char* buf, size_t size) const;
   void updateTime();
   void show();
   double& xCoor() { return x; }
   double& yCoor() { return y; }
   double& zCoor() { return z; }
   std::time_t& tCoor() { return t; }
+  double xCoor() const { return x; }
+  double yCoor() const { return y; }
+  double zCoor() const { return z; }
+  std::time_t tCoor() const { return t; }
 private:
   double x;
   double y;
@@ -45,14 +54,17 @@ Point4D::Point4D() {
   x = y = z = 0.0;
   t = std::time(0);
 }
-std::string Point4D::timeToString() {
-  return ctime(&t);
-  /* 
-    ctime is depricated due to a thread-safety issue.
-    That's not a problem here. Compiler warning
-    recommends converting to ctime_s, which, unfortunately
-    has a different and awkward interface.
-  */
+/*
+  Same text as ctime(&t), built by formatTime, which is
+  thread-safe and reuses the formatted minute
+*/
+std::string Point4D::timeToString() const {
+  char buf[timeStringSize];
+  return std::string(buf, formatTime(t, buf, sizeof(buf)));
+}
+/* no allocation, buf needs timeStringSize chars */
+size_t Point4D::timeToChars(char* buf, size_t size) const {
+  return formatTime(t, buf, size);
 }
 void Point4D::updateTime() {
   t = std::time(0);
@@ -65,12 +77,16 @@ void Point4D::show() {
   std::cout << "  }";
 }
 /* required for showType(T t, const std::string& nm) */
-std::ostream& operator<<(std::ostream& out, Point4D& t1) {
+std::ostream& operator<<(std::ostream& out, const Point4D& t1) {
+  char buf[timeStringSize];
+  size_t len = t1.timeToChars(buf, sizeof(buf));
   out << "Point4D {";
   out << "    " << t1.xCoor() << ", " << t1.yCoor() << ", " 
                << t1.zCoor() << std::endl
-               << "    " << t1.timeToString() << std::endl
-               << "  }" << std::endl;
+               << "    ";
+  out.write(buf, std::streamsize(len));
+  out << std::endl
+      << "  }" << std::endl;
   return out;
 }
-
+#endif
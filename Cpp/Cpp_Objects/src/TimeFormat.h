@@ -0,0 +1,186 @@
+/*-------------------------------------------------------------------
+  TimeFormat.h formats std::time_t values the way ctime does,
+  "Www Mmm dd hh:mm:ss yyyy\n", without ctime's shared buffer
+  - formatTime() writes into a caller-supplied buffer and is safe
+    to call from any number of threads
+  - each thread caches its last formatted minute, so times within
+    that minute cost a copy plus two second digits; only a new
+    minute calls localtime and formats in full
+*/
+#ifndef TimeFormatHeader
+#define TimeFormatHeader
+
+#if defined(_MSC_VER)
+  #pragma warning(disable:4996) // ctime, used only by benchTimeFormat for comparison
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include "AnalysisObj.h"
+
+/* ctime needs 26 chars for 4 digit years, the rest is for longer years */
+constexpr size_t timeStringSize = 40;
+
+namespace TimeFormatDetail {
+
+  inline bool localTime(std::time_t t, std::tm& out) {
+  #if defined(_MSC_VER)
+    return localtime_s(&out, &t) == 0;
+  #else
+    return localtime_r(&t, &out) != nullptr;
+  #endif
+  }
+  /*-----------------------------------------------
+    Last minute formatted on this thread
+    - zones change offset on whole minutes, so
+      within a minute only the seconds differ;
+      secondsMatch guards zones whose offset is
+      not whole minutes, which are never patched
+  */
+  struct MinuteCache {
+    std::int64_t minute = INT64_MIN;
+    bool secondsMatch = false;
+    size_t len = 0;
+    char text[timeStringSize];
+  };
+  inline std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+    std::int64_t q = a / b;
+    return (a % b < 0) ? q - 1 : q;
+  }
+  inline bool fill(MinuteCache& c, std::time_t t) {
+    static const char* days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char* months[] = {
+      "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    std::tm tm {};
+    if(!localTime(t, tm) || tm.tm_wday < 0 || tm.tm_wday > 6 || tm.tm_mon < 0 || tm.tm_mon > 11) {
+      return false;
+    }
+    int n = std::snprintf(
+      c.text, sizeof(c.text), "%.3s %.3s%3d %.2d:%.2d:%.2d %d\n",
+      days[tm.tm_wday], months[tm.tm_mon], tm.tm_mday,
+      tm.tm_hour, tm.tm_min, tm.tm_sec, 1900 + tm.tm_year
+    );
+    if(n <= 0 || size_t(n) >= sizeof(c.text)) {
+      return false;
+    }
+    std::int64_t secs = std::int64_t(t);
+    c.minute = floorDiv(secs, 60);
+    c.secondsMatch = secs - 60 * c.minute == tm.tm_sec;
+    c.len = size_t(n);
+    return true;
+  }
+}
+
+/*-------------------------------------------------------------------
+  Write t as ctime would into buf, returns length without the
+  terminating null
+  - throws if buf is too small or t has no local time
+*/
+inline size_t formatTime(std::time_t t, char* buf, size_t size) {
+  using namespace TimeFormatDetail;
+  thread_local MinuteCache cache;
+  const std::int64_t secs = std::int64_t(t);
+  const std::int64_t minute = floorDiv(secs, 60);
+  if(minute == cache.minute && cache.secondsMatch) {
+    if(size <= cache.len) {
+      throw "formatTime buffer too small";
+    }
+    std::memcpy(buf, cache.text, cache.len + 1);
+    int s = int(secs - 60 * minute);
+    buf[17] = char('0' + s / 10);     // "Www Mmm dd hh:mm:ss"
+    buf[18] = char('0' + s % 10);
+    return cache.len;
+  }
+  if(!fill(cache, t)) {
+    cache.minute = INT64_MIN;
+    throw "formatTime cannot convert time to local time";
+  }
+  if(size <= cache.len) {
+    throw "formatTime buffer too small";
+  }
+  std::memcpy(buf, cache.text, cache.len + 1);
+  return cache.len;
+}
+
+/*-- compare ctime strings with cached buffer formatting --*/
+
+void benchTimeFormat() {
+    using clock = std::chrono::high_resolution_clock;
+
+    showNote("benchmark time formatting: ctime vs formatTime");
+    const size_t count = 2000000;
+    const std::time_t t0 = std::time(0);
+    auto timeOf = [t0](size_t i) { return t0 + std::time_t(i / 1000); };   // 1000 samples per second
+    auto ms = [](auto start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+    std::cout << "\n  " << count << " times, 1000 per second";
+    size_t check = 0;
+
+    auto start = clock::now();
+    for(size_t i = 0; i < count; ++i) {
+        std::time_t t = timeOf(i);
+        std::string s = std::ctime(&t);
+        check += s[18];
+    }
+    std::cout << "\n  std::string(ctime(&t)):  " << ms(start) << " ms";
+
+    start = clock::now();
+    for(size_t i = 0; i < count; ++i) {
+        char buf[timeStringSize];
+        std::time_t t = timeOf(i);
+        std::tm tm {};
+        TimeFormatDetail::localTime(t, tm);
+        std::strftime(buf, sizeof(buf), "%a %b %e %H:%M:%S %Y\n", &tm);
+        check += buf[18];
+    }
+    std::cout << "\n  localtime_r + strftime:  " << ms(start) << " ms";
+
+    start = clock::now();
+    for(size_t i = 0; i < count; ++i) {
+        char buf[timeStringSize];
+        formatTime(timeOf(i), buf, sizeof(buf));
+        check += buf[18];
+    }
+    std::cout << "\n  formatTime into buffer:  " << ms(start) << " ms";
+
+    /* same work split over threads, seconds digits checked */
+    const size_t threads = 4;
+    std::vector<size_t> mismatches(threads, 0);
+    std::vector<std::thread> pool;
+    start = clock::now();
+    for(size_t th = 0; th < threads; ++th) {
+        pool.emplace_back([&, th]() {
+            char buf[timeStringSize];
+            for(size_t i = th; i < count; i += threads) {
+                formatTime(timeOf(i), buf, sizeof(buf));
+                if(buf[18] != char('0' + (timeOf(i) % 60) % 10)) {
+                    ++mismatches[th];
+                }
+            }
+        });
+    }
+    for(auto& th : pool) {
+        th.join();
+    }
+    double mt = ms(start);
+    size_t bad = 0;
+    for(size_t m : mismatches) {
+        bad += m;
+    }
+    std::time_t tLast = timeOf(count - 1);
+    char buf[timeStringSize];
+    formatTime(tLast, buf, sizeof(buf));
+    std::cout << "\n  formatTime, " << threads << " threads:    " << mt << " ms, "
+              << bad << " bad seconds digits"
+              << "\n  matches ctime: " << (std::string(buf) == std::ctime(&tLast) ? "yes" : "NO")
+              << "  (check " << check << ")\n";
+}
+#endif
@@ -0,0 +1,450 @@
+/*-------------------------------------------------------------------
+  TrajectoryCodec.h defines a compressed encoding for Point4D streams
+  - times are stored as delta of delta, so samples taken at a steady
+    rate cost one bit each
+  - x, y, z are stored as the XOR of each double with its predecessor,
+    keeping only the meaningful bits, in the style of Facebook's
+    Gorilla time series store
+  - samples are grouped in blocks that each begin with raw values,
+    so any block decodes without the ones before it
+*/
+#ifndef TrajectoryCodecHeader
+#define TrajectoryCodecHeader
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <bit>
+#include <random>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+
+/*-------------------------------------------------------------------
+  BitWriter appends bit fields, most significant bit first, to
+  a vector of 64 bit words
+*/
+class BitWriter {
+public:
+  void write(std::uint64_t value, unsigned nbits);
+  size_t bitCount() const { return _bits; }
+  std::vector<std::uint64_t>& words() { return _words; }
+private:
+  std::vector<std::uint64_t> _words;
+  size_t _bits = 0;
+};
+/*-----------------------------------------------
+  write low nbits of value, 1 <= nbits <= 64
+*/
+inline void BitWriter::write(std::uint64_t value, unsigned nbits) {
+  if(nbits < 64) {
+    value &= (std::uint64_t(1) << nbits) - 1;
+  }
+  unsigned used = unsigned(_bits & 63);
+  if(used == 0) {
+    _words.push_back(0);
+  }
+  unsigned room = 64 - used;
+  if(nbits <= room) {
+    _words.back() |= value << (room - nbits);
+  }
+  else {
+    _words.back() |= value >> (nbits - room);
+    _words.push_back(value << (64 - (nbits - room)));
+  }
+  _bits += nbits;
+}
+
+/*-------------------------------------------------------------------
+  BitReader reads fields written by BitWriter
+  - reads straddle at most two words, with no per bit loop
+  - the caller must not read past the bits written
+*/
+class BitReader {
+public:
+  explicit BitReader(const std::uint64_t* words) : _words(words) {}
+  std::uint64_t read(unsigned nbits);
+  bool readBit();
+private:
+  const std::uint64_t* _words;
+  size_t _pos = 0;
+};
+/*-----------------------------------------------
+  read nbits as low bits of result, 1 <= nbits <= 64
+*/
+inline std::uint64_t BitReader::read(unsigned nbits) {
+  size_t w = _pos >> 6;
+  unsigned off = unsigned(_pos & 63);
+  _pos += nbits;
+  std::uint64_t hi = _words[w] << off;
+  if(off + nbits <= 64) {
+    return hi >> (64 - nbits);
+  }
+  return (hi >> (64 - nbits)) | (_words[w + 1] >> (128 - off - nbits));
+}
+inline bool BitReader::readBit() {
+  bool bit = (_words[_pos >> 6] >> (63 - (_pos & 63))) & 1;
+  ++_pos;
+  return bit;
+}
+
+/*-------------------------------------------------------------------
+  TrajectoryBlock holds one independently decodable run of samples
+*/
+struct TrajectoryBlock {
+  size_t count = 0;                   // samples in block
+  size_t bitCount = 0;                // bits used in words
+  std::vector<std::uint64_t> words;
+  size_t bytes() const {
+    return words.size() * sizeof(std::uint64_t) + 2 * sizeof(size_t);
+  }
+};
+
+/*-------------------------------------------------------------------
+  Per block state shared by encoder and decoder
+  - time tracks previous time and previous delta
+  - each double tracks its previous bits and the leading and
+    trailing zero counts of the last XOR window written
+*/
+struct TrajectoryState {
+  struct Channel {
+    std::uint64_t prev = 0;
+    unsigned lead = 65;   // 65 marks no window yet
+    unsigned trail = 0;
+  };
+  std::int64_t prevT = 0;
+  std::int64_t prevDelta = 0;
+  Channel ch[3];
+};
+/*-----------------------------------------------
+  zigzag maps small signed values to small
+  unsigned values, 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+*/
+inline std::uint64_t zigzag(std::int64_t v) {
+  return (std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63);
+}
+inline std::int64_t unzigzag(std::uint64_t u) {
+  return std::int64_t(u >> 1) ^ -std::int64_t(u & 1);
+}
+
+/*-------------------------------------------------------------------
+  TrajectoryEncoder compresses a stream of Point4D samples
+  - push() appends a sample, sealing the current block when
+    it holds blockSize samples
+  - flush() seals a partially filled block, call it before
+    reading blocks() when the stream ends
+  Time delta of delta is coded as:
+    0                      zero
+    10   + 7 bit zigzag    |dod| small
+    110  + 12 bit zigzag
+    1110 + 20 bit zigzag
+    1111 + 64 bit value
+  Each double's XOR with its predecessor is coded as:
+    0                      unchanged
+    10 + bits              fits previous window
+    11 + 5 bit lead + 6 bit length + bits
+*/
+class TrajectoryEncoder {
+public:
+  explicit TrajectoryEncoder(size_t blockSize = 1024);
+  void push(const Point4D& pt);
+  void flush();
+  const std::vector<TrajectoryBlock>& blocks() const { return _blocks; }
+  size_t count() const { return _count; }
+  size_t encodedBytes() const;
+private:
+  void putTime(std::int64_t t);
+  void putDouble(TrajectoryState::Channel& c, double v);
+
+  size_t _blockSize;
+  size_t _count = 0;
+  size_t _inBlock = 0;
+  BitWriter _out;
+  TrajectoryState _st;
+  std::vector<TrajectoryBlock> _blocks;
+};
+
+inline TrajectoryEncoder::TrajectoryEncoder(size_t blockSize)
+  : _blockSize(blockSize > 0 ? blockSize : 1) {}
+/*-----------------------------------------------
+  first sample of a block is written raw
+*/
+inline void TrajectoryEncoder::push(const Point4D& pt) {
+  double v[3] = { pt.xCoor(), pt.yCoor(), pt.zCoor() };
+  std::int64_t t = std::int64_t(pt.tCoor());
+  if(_inBlock == 0) {
+    _st = TrajectoryState();
+    _out.write(std::uint64_t(t), 64);
+    _st.prevT = t;
+    for(size_t i = 0; i < 3; ++i) {
+      _st.ch[i].prev = std::bit_cast<std::uint64_t>(v[i]);
+      _out.write(_st.ch[i].prev, 64);
+    }
+  }
+  else {
+    putTime(t);
+    for(size_t i = 0; i < 3; ++i) {
+      putDouble(_st.ch[i], v[i]);
+    }
+  }
+  ++_count;
+  if(++_inBlock == _blockSize) {
+    flush();
+  }
+}
+inline void TrajectoryEncoder::putTime(std::int64_t t) {
+  std::int64_t delta = t - _st.prevT;
+  std::uint64_t z = zigzag(delta - _st.prevDelta);
+  _st.prevT = t;
+  _st.prevDelta = delta;
+  if(z == 0) {
+    _out.write(0b0, 1);
+  }
+  else if(z < (1u << 7)) {
+    _out.write(0b10, 2);
+    _out.write(z, 7);
+  }
+  else if(z < (1u << 12)) {
+    _out.write(0b110, 3);
+    _out.write(z, 12);
+  }
+  else if(z < (1u << 20)) {
+    _out.write(0b1110, 4);
+    _out.write(z, 20);
+  }
+  else {
+    _out.write(0b1111, 4);
+    _out.write(z, 64);
+  }
+}
+inline void TrajectoryEncoder::putDouble(TrajectoryState::Channel& c, double v) {
+  std::uint64_t bits = std::bit_cast<std::uint64_t>(v);
+  std::uint64_t x = bits ^ c.prev;
+  c.prev = bits;
+  if(x == 0) {
+    _out.write(0b0, 1);
+    return;
+  }
+  unsigned lead = std::min(unsigned(std::countl_zero(x)), 31u);
+  unsigned trail = unsigned(std::countr_zero(x));
+  if(c.lead <= 64 && lead >= c.lead && trail >= c.trail) {
+    _out.write(0b10, 2);
+    _out.write(x >> c.trail, 64 - c.lead - c.trail);
+    return;
+  }
+  unsigned len = 64 - lead - trail;
+  _out.write(0b11, 2);
+  _out.write(lead, 5);
+  _out.write(len & 63, 6);   // 64 is written as 0
+  _out.write(x >> trail, len);
+  c.lead = lead;
+  c.trail = trail;
+}
+/*-----------------------------------------------
+  seal current block, if it holds any samples
+*/
+inline void TrajectoryEncoder::flush() {
+  if(_inBlock == 0) {
+    return;
+  }
+  TrajectoryBlock blk;
+  blk.count = _inBlock;
+  blk.bitCount = _out.bitCount();
+  blk.words = std::move(_out.words());
+  _blocks.push_back(std::move(blk));
+  _out = BitWriter();
+  _inBlock = 0;
+}
+inline size_t TrajectoryEncoder::encodedBytes() const {
+  size_t sum = 0;
+  for(auto& blk : _blocks) {
+    sum += blk.bytes();
+  }
+  return sum;
+}
+
+/*-------------------------------------------------------------------
+  Decoding
+  - decodeBlock writes blk.count samples to out and returns count,
+    it is the fast sequential path, reading straight into caller
+    storage with no allocation
+  - decodeAll decodes every block in order into a new vector
+*/
+inline size_t decodeBlock(const TrajectoryBlock& blk, Point4D* out) {
+  if(blk.count == 0) {
+    return 0;
+  }
+  BitReader in(blk.words.data());
+  TrajectoryState st;
+  st.prevT = std::int64_t(in.read(64));
+  for(size_t i = 0; i < 3; ++i) {
+    st.ch[i].prev = in.read(64);
+  }
+  auto emit = [&st](Point4D& pt) {
+    pt.tCoor() = std::time_t(st.prevT);
+    pt.xCoor() = std::bit_cast<double>(st.ch[0].prev);
+    pt.yCoor() = std::bit_cast<double>(st.ch[1].prev);
+    pt.zCoor() = std::bit_cast<double>(st.ch[2].prev);
+  };
+  emit(out[0]);
+  for(size_t k = 1; k < blk.count; ++k) {
+    /*-- time --*/
+    std::uint64_t z = 0;
+    if(in.readBit()) {
+      if(!in.readBit()) {
+        z = in.read(7);
+      }
+      else if(!in.readBit()) {
+        z = in.read(12);
+      }
+      else if(!in.readBit()) {
+        z = in.read(20);
+      }
+      else {
+        z = in.read(64);
+      }
+    }
+    st.prevDelta += unzigzag(z);
+    st.prevT += st.prevDelta;
+    /*-- coordinates --*/
+    for(auto& c : st.ch) {
+      if(!in.readBit()) {
+        continue;
+      }
+      if(in.readBit()) {
+        c.lead = unsigned(in.read(5));
+        unsigned len = unsigned(in.read(6));
+        if(len == 0) {
+          len = 64;
+        }
+        c.trail = 64 - c.lead - len;
+      }
+      c.prev ^= in.read(64 - c.lead - c.trail) << c.trail;
+    }
+    emit(out[k]);
+  }
+  return blk.count;
+}
+inline std::vector<Point4D> decodeAll(const std::vector<TrajectoryBlock>& blocks) {
+  size_t total = 0;
+  for(auto& blk : blocks) {
+    total += blk.count;
+  }
+  std::vector<Point4D> pts(total);
+  size_t at = 0;
+  for(auto& blk : blocks) {
+    at += decodeBlock(blk, pts.data() + at);
+  }
+  return pts;
+}
+
+/*-- demonstrate round trip of a short trajectory --*/
+
+void demo_TrajectoryCodec() {
+    showNote("compressed Point4D trajectory");
+    std::vector<Point4D> track(8);
+    for(size_t i = 0; i < track.size(); ++i) {
+        track[i].xCoor() = 1.0 + 0.25 * double(i);
+        track[i].yCoor() = 2.0;
+        track[i].zCoor() = -0.5 * double(i);
+        track[i].tCoor() = std::time_t(1700000000 + i);
+    }
+    TrajectoryEncoder enc(4);
+    for(auto& pt : track) {
+        enc.push(pt);
+    }
+    enc.flush();
+    std::cout << "\n  " << enc.count() << " samples, "
+              << enc.blocks().size() << " blocks, "
+              << track.size() * sizeof(Point4D) << " bytes raw, "
+              << enc.encodedBytes() << " bytes encoded";
+
+    /*-- second block decodes without the first --*/
+    Point4D tail[4];
+    decodeBlock(enc.blocks()[1], tail);
+    std::cout << "\n  block 1 alone:";
+    for(auto& pt : tail) {
+        std::cout << " (" << pt.xCoor() << ", " << pt.yCoor() << ", "
+                  << pt.zCoor() << ", " << pt.tCoor() - 1700000000 << ")";
+    }
+    std::cout << "\n";
+}
+
+/*-- compression ratio and decode throughput on synthetic tracks --*/
+
+void benchTrajectoryTrack(const std::string& name, const std::vector<Point4D>& track) {
+    using clock = std::chrono::high_resolution_clock;
+
+    auto start = clock::now();
+    TrajectoryEncoder enc;
+    for(auto& pt : track) {
+        enc.push(pt);
+    }
+    enc.flush();
+    double encodeSec = std::chrono::duration<double>(clock::now() - start).count();
+
+    start = clock::now();
+    auto out = decodeAll(enc.blocks());
+    double decodeSec = std::chrono::duration<double>(clock::now() - start).count();
+
+    bool same = out.size() == track.size();
+    for(size_t i = 0; same && i < track.size(); ++i) {
+        same = std::memcmp(&out[i], &track[i], sizeof(Point4D)) == 0;
+    }
+    double ratio = double(track.size() * sizeof(Point4D)) / double(enc.encodedBytes());
+    double n = double(track.size()) / 1.0e6;
+    std::cout << "\n  " << name << ": ratio " << ratio
+              << ", " << double(enc.encodedBytes() * 8) / double(track.size()) << " bits/sample"
+              << ", encode " << n / encodeSec << " M/s"
+              << ", decode " << n / decodeSec << " M/s"
+              << "  (round trip " << (same ? "exact" : "FAILED") << ")";
+}
+void benchTrajectoryCodec() {
+    showNote("benchmark Point4D trajectory compression");
+    const size_t n = 1000000;
+    std::mt19937 gen(11);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    std::uniform_int_distribution<int> gap(0, 99);
+    std::vector<Point4D> track(n);
+
+    /*-- 1 Hz samples of a vehicle that is parked most of the time --*/
+    double x = 0.0, y = 0.0;
+    for(size_t i = 0; i < n; ++i) {
+        if(gap(gen) < 10) {
+            x += 1.5;
+            y -= 0.75;
+        }
+        track[i].xCoor() = x;
+        track[i].yCoor() = y;
+        track[i].zCoor() = 12.0;
+        track[i].tCoor() = std::time_t(1700000000 + i);
+    }
+    std::cout << "\n  " << n << " samples per track, " << sizeof(Point4D) << " bytes raw each";
+    benchTrajectoryTrack("mostly stationary   ", track);
+
+    /*-- positions on a centimeter grid, occasional missed samples --*/
+    std::time_t t = 1700000000;
+    for(size_t i = 0; i < n; ++i) {
+        t += (gap(gen) == 0 ? 2 : 1);
+        track[i].xCoor() = std::round(100.0 * (0.01 * double(i))) / 100.0;
+        track[i].yCoor() = std::round(100.0 * 50.0 * std::sin(0.001 * double(i))) / 100.0;
+        track[i].zCoor() = 3.0;
+        track[i].tCoor() = t;
+    }
+    benchTrajectoryTrack("centimeter grid     ", track);
+
+    /*-- smooth path with full precision sensor noise --*/
+    for(size_t i = 0; i < n; ++i) {
+        double s = 0.01 * double(i);
+        track[i].xCoor() = 100.0 * std::cos(0.01 * s) + noise(gen);
+        track[i].yCoor() = 100.0 * std::sin(0.01 * s) + noise(gen);
+        track[i].zCoor() = 10.0 + noise(gen);
+        track[i].tCoor() = std::time_t(1700000000 + i);
+    }
+    benchTrajectoryTrack("noisy full precision", track);
+    std::cout << "\n";
+}
+#endif
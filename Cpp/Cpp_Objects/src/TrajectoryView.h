@@ -0,0 +1,355 @@
+/*-------------------------------------------------------------------
+  TrajectoryView.h defines position lookup by time over a
+  time-ordered sequence of Point4D or PackedPoint4D samples
+  - times are kept as double seconds after the first sample, and
+    x, y, z as separate columns; queries use the same relative
+    seconds, since() converts from ns since epoch, so precision
+    does not depend on how far the epoch is
+  - a copy of the times in Eytzinger (breadth first) order makes
+    each search a branch-free descent whose first levels share a
+    few cache lines
+  - batches descend eight queries in lockstep, so their cache
+    misses overlap, then interpolate in a loop over columns
+  - resample() walks sorted times forward, no search at all
+*/
+#ifndef TrajectoryViewHeader
+#define TrajectoryViewHeader
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include "AnalysisObj.h"
+#include "PointsObj.h"
+#include "Point4DBatch.h"
+
+class TrajectoryView {
+public:
+  enum class Search { Linear, Binary, Eytzinger };
+
+  explicit TrajectoryView(const std::vector<Point4D>& pts);
+  explicit TrajectoryView(const Point4DBatch& batch);
+
+  size_t size() const { return ts.size(); }
+  std::int64_t origin() const { return base; }         // ns since epoch of first sample
+  double endTime() const { return ts.back(); }         // seconds after origin
+  double since(std::int64_t ns) const { return double(ns - base) * 1e-9; }
+
+  /* t is seconds after origin; index i of segment i, i + 1 holding t, clamped to the ends */
+  size_t segment(double t, Search how = Search::Eytzinger) const;
+  std::array<double, 3> position(double t, Search how = Search::Eytzinger) const;
+
+  void interpolate(const double* times, size_t m, double* x, double* y, double* z) const;
+  Point4DColumns resample(double start, double step, size_t count) const;
+private:
+  void build();
+  size_t upperEytzinger(double rel) const;
+  size_t upperBinary(double rel) const;
+  size_t clampSegment(size_t upper) const {
+    return std::min(upper == 0 ? 0 : upper - 1, ts.size() - 2);
+  }
+  /* weight 0 at ts[i], 1 at ts[i + 1], clamped; equal times give 0 */
+  double weight(size_t i, double rel) const {
+    double dt = ts[i + 1] - ts[i];
+    double w = dt > 0.0 ? (rel - ts[i]) / dt : 0.0;
+    return std::clamp(w, 0.0, 1.0);
+  }
+
+  std::int64_t base = 0;
+  std::vector<double> ts, xs, ys, zs;
+  std::vector<double> eyt;            // eyt[1..n], eyt[0] unused
+  std::vector<std::uint32_t> eytIdx;  // sorted index of eyt[k], eytIdx[0] = n
+};
+
+inline TrajectoryView::TrajectoryView(const std::vector<Point4D>& pts) {
+  if(pts.size() < 2) {
+    throw "TrajectoryView needs at least two samples";
+  }
+  base = std::int64_t(pts[0].tCoor()) * 1000000000;
+  for(const auto& pt : pts) {
+    ts.push_back(double(pt.tCoor() - pts[0].tCoor()));
+    xs.push_back(pt.xCoor());
+    ys.push_back(pt.yCoor());
+    zs.push_back(pt.zCoor());
+  }
+  build();
+}
+inline TrajectoryView::TrajectoryView(const Point4DBatch& batch) {
+  if(batch.size() < 2) {
+    throw "TrajectoryView needs at least two samples";
+  }
+  base = batch[0].t;
+  for(const auto& rec : batch) {
+    ts.push_back(since(rec.t));
+    xs.push_back(rec.x);
+    ys.push_back(rec.y);
+    zs.push_back(rec.z);
+  }
+  build();
+}
+/*-----------------------------------------------
+  In-order walk of the implicit tree 1, 2, 3 ...
+  assigns sorted times to Eytzinger slots
+*/
+inline void TrajectoryView::build() {
+  const size_t n = ts.size();
+  if(n > UINT32_MAX - 1) {
+    throw "TrajectoryView supports fewer than 2^32 - 1 samples";
+  }
+  for(size_t i = 1; i < n; ++i) {
+    if(!(ts[i] >= ts[i - 1])) {
+      throw "TrajectoryView samples must be in time order";
+    }
+  }
+  eyt.assign(n + 1, 0.0);
+  eytIdx.assign(n + 1, std::uint32_t(n));
+  size_t next = 0;
+  std::vector<size_t> stack;
+  size_t k = 1;
+  while(k <= n || !stack.empty()) {
+    while(k <= n) {
+      stack.push_back(k);
+      k = 2 * k;
+    }
+    k = stack.back();
+    stack.pop_back();
+    eyt[k] = ts[next];
+    eytIdx[k] = std::uint32_t(next++);
+    k = 2 * k + 1;
+  }
+}
+/*-----------------------------------------------
+  Index of first time > rel, n if none
+  - descend right while eyt[k] <= rel; the trailing
+    ones of k count the final right turns, shifting
+    them off lands on the answer, 0 meaning none
+*/
+inline size_t TrajectoryView::upperEytzinger(double rel) const {
+  const size_t n = ts.size();
+  size_t k = 1;
+  while(k <= n) {
+    k = 2 * k + size_t(eyt[k] <= rel);
+  }
+  k >>= std::countr_one(k) + 1;
+  return eytIdx[k];
+}
+/* halve with a conditional move, no branch on the comparison */
+inline size_t TrajectoryView::upperBinary(double rel) const {
+  const double* base = ts.data();
+  size_t len = ts.size();
+  while(len > 1) {
+    size_t half = len / 2;
+    base = base[half] <= rel ? base + half : base;
+    len -= half;
+  }
+  return size_t(base - ts.data()) + size_t(*base <= rel);
+}
+inline size_t TrajectoryView::segment(double rel, Search how) const {
+  switch(how) {
+    case Search::Linear: {
+      size_t u = 0;
+      while(u < ts.size() && ts[u] <= rel) {
+        ++u;
+      }
+      return clampSegment(u);
+    }
+    case Search::Binary:
+      return clampSegment(upperBinary(rel));
+    default:
+      return clampSegment(upperEytzinger(rel));
+  }
+}
+inline std::array<double, 3> TrajectoryView::position(double t, Search how) const {
+  size_t i = segment(t, how);
+  double w = weight(i, t);
+  return {
+    xs[i] + w * (xs[i + 1] - xs[i]),
+    ys[i] + w * (ys[i + 1] - ys[i]),
+    zs[i] + w * (zs[i + 1] - zs[i])
+  };
+}
+/*-----------------------------------------------
+  Positions at m times, seconds after origin,
+  in any order
+  - blocks of 64: eight lanes descend together,
+    every lane runs the same number of levels,
+    finished lanes hold their k
+*/
+inline void TrajectoryView::interpolate(
+  const double* times, size_t m, double* x, double* y, double* z
+) const {
+  constexpr size_t block = 64, lanes = 8;
+  const size_t n = ts.size();
+  const unsigned levels = unsigned(std::bit_width(n));
+  size_t seg[block];
+  double w[block];
+  for(size_t b = 0; b < m; b += block) {
+    const size_t cnt = std::min(block, m - b);
+    for(size_t l0 = 0; l0 < cnt; l0 += lanes) {
+      const size_t nl = std::min(lanes, cnt - l0);
+      size_t k[lanes];
+      double rel[lanes];
+      for(size_t j = 0; j < lanes; ++j) {
+        k[j] = 1;
+        rel[j] = j < nl ? times[b + l0 + j] : 0.0;
+      }
+      for(unsigned lv = 0; lv < levels; ++lv) {
+        for(size_t j = 0; j < lanes; ++j) {
+          size_t kk = k[j] <= n ? k[j] : 0;                 // eyt[0] is a safe dummy
+          size_t next = 2 * k[j] + size_t(eyt[kk] <= rel[j]);
+          k[j] = k[j] <= n ? next : k[j];
+        }
+      }
+      for(size_t j = 0; j < nl; ++j) {
+        size_t kk = k[j] >> (std::countr_one(k[j]) + 1);
+        seg[l0 + j] = clampSegment(eytIdx[kk]);
+      }
+    }
+    for(size_t j = 0; j < cnt; ++j) {
+      w[j] = weight(seg[j], times[b + j]);
+    }
+    /* one column at a time, a gather, subtract, multiply, add loop */
+    for(size_t j = 0; j < cnt; ++j) {
+      x[b + j] = xs[seg[j]] + w[j] * (xs[seg[j] + 1] - xs[seg[j]]);
+    }
+    for(size_t j = 0; j < cnt; ++j) {
+      y[b + j] = ys[seg[j]] + w[j] * (ys[seg[j] + 1] - ys[seg[j]]);
+    }
+    for(size_t j = 0; j < cnt; ++j) {
+      z[b + j] = zs[seg[j]] + w[j] * (zs[seg[j] + 1] - zs[seg[j]]);
+    }
+  }
+}
+/*-----------------------------------------------
+  count samples at start, start + step, ...,
+  seconds after origin; output times are ns
+  since epoch, origin plus the rounded offset;
+  query times increase, so the segment only
+  moves forward
+*/
+inline Point4DColumns TrajectoryView::resample(double start, double step, size_t count) const {
+  if(!(step > 0.0)) {
+    throw "TrajectoryView resample step must be positive";
+  }
+  Point4DColumns out;
+  out.resize(count);
+  const size_t last = ts.size() - 2;
+  size_t i = segment(start);
+  for(size_t j = 0; j < count; ++j) {
+    const double rel = start + double(j) * step;
+    while(i < last && ts[i + 1] <= rel) {
+      ++i;
+    }
+    const double w = weight(i, rel);
+    out.x[j] = xs[i] + w * (xs[i + 1] - xs[i]);
+    out.y[j] = ys[i] + w * (ys[i + 1] - ys[i]);
+    out.z[j] = zs[i] + w * (zs[i + 1] - zs[i]);
+    out.t[j] = base + std::llround(rel * 1e9);
+  }
+  return out;
+}
+
+/*-- demonstrate lookup and resampling --*/
+
+void demo_TrajectoryView() {
+    showNote("time-interpolated Point4D trajectory");
+    std::vector<Point4D> pts(5);
+    const std::time_t start = std::time(0);
+    for(size_t i = 0; i < pts.size(); ++i) {
+        pts[i].xCoor() = double(i * i);
+        pts[i].yCoor() = 10.0 * double(i);
+        pts[i].zCoor() = 0.0;
+        pts[i].tCoor() = start + std::time_t(i);
+    }
+    TrajectoryView tv(pts);
+    for(double dt : { -1.0, 0.5, 2.25, 3.0, 9.0 }) {
+        auto p = tv.position(dt);
+        std::cout << "\n  t0 + " << dt << " s: (" << p[0] << ", " << p[1] << ", " << p[2] << ")";
+    }
+    Point4DColumns rs = tv.resample(0.0, 0.75, 6);
+    std::cout << "\n  resampled every 0.75 s, x:";
+    for(double v : rs.x) {
+        std::cout << " " << v;
+    }
+    std::cout << "\n";
+}
+
+/*-- compare searches, single and batched, and resampling --*/
+
+void benchTrajectoryView() {
+    using clock = std::chrono::high_resolution_clock;
+
+    showNote("benchmark trajectory lookup by time");
+    const size_t n = 1 << 22, m = 1 << 21;
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+    Point4DBatch batch;
+    batch.reserve(n);
+    std::int64_t t = PackedPoint4D::nowNs();
+    for(size_t i = 0; i < n; ++i) {
+        double s = double(i);
+        batch.push_back(PackedPoint4D { std::cos(s * 1e-3), std::sin(s * 1e-3), s * 1e-4, t });
+        t += std::int64_t(jitter(gen) * 1e8);    // irregular 0.05 to 0.15 s spacing
+    }
+    TrajectoryView tv(batch);
+    std::uniform_real_distribution<double> when(0.0, tv.endTime());
+    std::vector<double> queries(m);
+    for(auto& q : queries) {
+        q = when(gen);
+    }
+    std::cout << "\n  " << n << " samples, " << m << " random query times";
+
+    auto nsPer = [](auto start, size_t count) {
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(count);
+    };
+    double check = 0.0;
+    const size_t linearCount = 200;
+    auto start = clock::now();
+    for(size_t i = 0; i < linearCount; ++i) {
+        check += tv.position(queries[i], TrajectoryView::Search::Linear)[0];
+    }
+    std::cout << "\n  linear search:          " << nsPer(start, linearCount) << " ns/query  ("
+              << linearCount << " queries)";
+
+    std::vector<double> rel(n);
+    for(size_t i = 0; i < n; ++i) {
+        rel[i] = tv.since(batch[i].t);
+    }
+    start = clock::now();
+    for(size_t i = 0; i < m; ++i) {
+        auto u = std::upper_bound(rel.begin(), rel.end(), queries[i]);
+        check += double(u - rel.begin());
+    }
+    std::cout << "\n  std::upper_bound only:  " << nsPer(start, m) << " ns/query";
+
+    for(auto how : { TrajectoryView::Search::Binary, TrajectoryView::Search::Eytzinger }) {
+        start = clock::now();
+        for(size_t i = 0; i < m; ++i) {
+            check += tv.position(queries[i], how)[0];
+        }
+        std::cout << (how == TrajectoryView::Search::Binary
+                        ? "\n  branch-free binary:     " : "\n  Eytzinger:              ")
+                  << nsPer(start, m) << " ns/query";
+    }
+    std::vector<double> x(m), y(m), z(m);
+    start = clock::now();
+    tv.interpolate(queries.data(), m, x.data(), y.data(), z.data());
+    std::cout << "\n  Eytzinger, batched:     " << nsPer(start, m) << " ns/query";
+    double diff = 0.0;
+    for(size_t i = 0; i < m; i += 101) {
+        diff = std::max(diff, std::abs(x[i] - tv.position(queries[i], TrajectoryView::Search::Binary)[0]));
+    }
+
+    start = clock::now();
+    Point4DColumns rs = tv.resample(0.0, 0.1, m);
+    std::cout << "\n  resample " << m << " at 10 Hz: " << nsPer(start, m) << " ns/sample"
+              << "\n  batched matches single: " << (diff == 0.0 ? "yes" : "NO")
+              << "  (check " << check + rs.x.back() << ")\n";
+}
+#endif